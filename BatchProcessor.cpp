@@ -0,0 +1,424 @@
+#include "BatchProcessor.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include "EnvelopeStreamParser.h"
+#include "InvoicePipeline.h"
+#include "MemoryStats.h"
+#include "SchemaValidator.h"
+#include "InvoiceTotalReconciler.h"
+using namespace std;
+
+
+BatchProcessor::BatchProcessor() {
+
+	elapsedSeconds = 0.0;
+	totalInputBytes = 0;
+	renderFormat = RENDER_HUMAN;
+
+}
+
+BatchProcessor::BatchProcessor(unsigned threadCount) : pool(threadCount) {
+
+	elapsedSeconds = 0.0;
+	totalInputBytes = 0;
+	renderFormat = RENDER_HUMAN;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function collectInputFiles expands whatever it's given into invoice files. A directory adds every regular file in it (sorted by name, so
+//runs are repeatable), a path starting with @ is a list file with one path per line, and anything else is treated as a single invoice file.
+//addInputPath queues the lot.
+//
+//*******************************************************************************************************************************************
+
+void BatchProcessor::addInputPath(const string& path) {
+
+	collectInputFiles(path, inputFiles);
+
+}
+
+void BatchProcessor::collectInputFiles(const string& path, vector <string>& files) {
+
+	if (!path.empty() && path[0] == '@') {
+
+		ifstream listFile(path.substr(1));
+		string listedPath;
+
+		if (!listFile) {
+			throw string("ERROR. Cannot open list file " + path.substr(1) + ".\n");
+		}
+
+		while (getline(listFile, listedPath)) {
+
+			if (!listedPath.empty() && listedPath.back() == '\r') {
+				listedPath.pop_back();
+			}
+
+			if (!listedPath.empty()) {
+				collectInputFiles(listedPath, files);
+			}
+
+		}
+
+		return;
+
+	}
+
+	error_code pathError;
+	filesystem::file_status pathStatus = filesystem::status(path, pathError);
+
+	if (pathError || !filesystem::exists(pathStatus)) {
+		throw string("ERROR. " + path + " does not exist.\n");
+	}
+
+	if (filesystem::is_directory(pathStatus)) {
+
+		vector <string> directoryFiles;
+
+		for (const filesystem::directory_entry& entry : filesystem::directory_iterator(path)) {
+
+			if (entry.is_regular_file()) {
+				directoryFiles.push_back(entry.path().string());
+			}
+
+		}
+
+		sort(directoryFiles.begin(), directoryFiles.end());
+		files.insert(files.end(), directoryFiles.begin(), directoryFiles.end());
+
+	}
+
+	else {
+
+		files.push_back(path);
+
+	}
+
+}
+
+
+
+void BatchProcessor::clearInputFiles() {
+
+	inputFiles.clear();
+	results.clear();
+	elapsedSeconds = 0.0;
+	totalInputBytes = 0;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function processInvoice splits one file into its transaction sets (see splitTransactionSets), runs each through the pipeline the way
+//stream mode does, and parks the rendered text in the file's own slot of results. A file that's one bare transaction set comes out just
+//as it always did; anything else gets a header line per transaction set. Each call only touches its own slot, so the workers never need to
+//lock anything here.
+//
+//*******************************************************************************************************************************************
+
+void BatchProcessor::processInvoice(size_t fileIndex) {
+
+	BatchInvoiceResult& result = results[fileIndex];
+	InvoiceAllocationScope allocationScope(result.fileName); //Everything below, until the result is handed back. Nothing unless --memstats.
+	EdiInputFile invoiceInputFile;
+	vector <TransactionSetSpan> transactionSetSpans;
+	EdiTokenizer invoiceTokenizer;
+	ElementIndex elementIndex;
+	InvoiceDocumentStore documentStore;
+	InvoiceLoopTree loopTree;
+	SchemaValidator schemaValidator;
+	InvoiceTotalReconciler totalReconciler;
+	RenderBuffer renderedInvoice;
+
+	try {
+		openInvoiceInputFile(invoiceInputFile, result.fileName);
+	}
+
+	catch (string exceptionMsg) {
+		result.errorMessage = exceptionMsg;
+		result.outcome = INVOICE_CANNOT_OPEN;
+		return;
+	}
+
+	splitTransactionSets(invoiceInputFile.getContents(), DEFAULT_EDI_DELIMITERS, transactionSetSpans);
+
+	bool showTransactionSetHeaders = transactionSetSpans.size() > 1 || !transactionSetSpans[0].interchangeControlNumber.empty() || !transactionSetSpans[0].groupControlNumber.empty();
+
+	invoiceTokenizer.addSegmentObserver(&schemaValidator); //Both start over for each transaction set in beginDocument.
+	invoiceTokenizer.addSegmentObserver(&totalReconciler); //Same pass; TDS01 is checked the moment SE closes.
+	result.transactionSets.reserve(transactionSetSpans.size());
+	result.outcome = INVOICE_RENDERED;
+
+	for (const TransactionSetSpan& transactionSetSpan : transactionSetSpans) {
+
+		result.transactionSets.push_back(TransactionSetResult{ transactionSetSpan.sequence, string(transactionSetSpan.interchangeControlNumber), string(transactionSetSpan.groupControlNumber), INVOICE_RENDERED, "", 0, 0 });
+
+		TransactionSetResult& transactionSet = result.transactionSets.back();
+
+		invoiceTokenizer.setDelimiters(transactionSetSpan.delimiters); //Whatever the enclosing ISA declared.
+		invoiceTokenizer.tokenize(transactionSetSpan.contents);
+
+		if (showTransactionSetHeaders) {
+
+			renderedInvoice << "===== Transaction set " << transactionSet.sequence;
+
+			if (!transactionSet.interchangeControlNumber.empty() || !transactionSet.groupControlNumber.empty()) {
+				renderedInvoice << " (ISA13 " << transactionSet.interchangeControlNumber << ", GS06 " << transactionSet.groupControlNumber << ")";
+			}
+
+			renderedInvoice << " =====\n";
+
+		}
+
+		if (!validateInvoiceEnvelope(invoiceTokenizer, transactionSet.errorMessage)) {
+
+			transactionSet.outcome = INVOICE_NOT_TRANSACTION_SET;
+			result.outcome = INVOICE_NOT_TRANSACTION_SET;
+			renderedInvoice << "FAILED: " << transactionSet.errorMessage << "\n\n";
+			continue;
+
+		}
+
+		transactionSet.numSchemaErrors = schemaValidator.getNumErrors();
+		transactionSet.numTotalMismatches = totalReconciler.getNumMismatches();
+
+		if (renderFormat == RENDER_VALIDATION) { //The report is the whole output, so it's written even when it's clean.
+
+			ostringstream schemaReport;
+			schemaValidator.displayErrors(schemaReport);
+			totalReconciler.displayResults(schemaReport);
+			renderedInvoice << schemaReport.str() << "\n";
+			continue;
+
+		}
+
+		if (renderFormat == RENDER_HUMAN && (!schemaValidator.getErrors().empty() || !totalReconciler.isReconciled())) { //Machine output stays pure data; the counts are still kept.
+
+			ostringstream schemaReport;
+			schemaValidator.displayErrors(schemaReport);
+
+			if (!totalReconciler.isReconciled()) {
+				totalReconciler.displayResults(schemaReport);
+			}
+
+			renderedInvoice << "Schema validation:\n" << schemaReport.str() << "\n";
+
+		}
+
+		try {
+			documentStore.build(invoiceTokenizer); //Resets the arena from the previous transaction set first.
+		}
+
+		catch (const string& message) { //Too big for the store's columns; nothing of it can be rendered.
+
+			transactionSet.errorMessage = message;
+			transactionSet.outcome = INVOICE_NOT_TRANSACTION_SET;
+			result.outcome = INVOICE_NOT_TRANSACTION_SET;
+			renderedInvoice << "FAILED: " << message << "\n";
+			continue;
+
+		}
+
+		if (renderFormat == RENDER_MACHINE) {
+
+			appendInvoiceForMachines(documentStore, renderedInvoice);
+
+		}
+
+		else {
+
+			elementIndex.build(invoiceTokenizer);
+			loopTree.build(documentStore);
+			appendInvoiceForHumans(documentStore, elementIndex, loopTree, renderedInvoice);
+
+		}
+
+		renderedInvoice << "\n";
+
+	}
+
+	result.succeeded = (result.outcome == INVOICE_RENDERED);
+	result.renderedInvoice = renderedInvoice.release(); //Moved, not copied; writeResults sends it out later.
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function run sizes up every file first so the pool can be handed the biggest files first; that keeps a few large files from all landing
+//at the end of the run. Wall-clock time covers the parallel part only.
+//
+//*******************************************************************************************************************************************
+
+void BatchProcessor::run() {
+
+	vector <size_t> taskOrder(inputFiles.size());
+
+	results.assign(inputFiles.size(), BatchInvoiceResult{ "", 0, false, INVOICE_CANNOT_OPEN, "", "", {} });
+	totalInputBytes = 0;
+
+	for (size_t i = 0; i < inputFiles.size(); i++) {
+
+		error_code sizeError;
+		uintmax_t fileSize = filesystem::file_size(inputFiles[i], sizeError);
+
+		results[i].fileName = inputFiles[i];
+		results[i].inputBytes = sizeError ? 0 : static_cast<size_t>(fileSize);
+		totalInputBytes += results[i].inputBytes;
+		taskOrder[i] = i;
+
+	}
+
+	stable_sort(taskOrder.begin(), taskOrder.end(), [this](size_t left, size_t right) {
+		return results[left].inputBytes > results[right].inputBytes;
+	});
+
+	chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+
+	pool.run(taskOrder, [this](size_t fileIndex) { processInvoice(fileIndex); });
+
+	elapsedSeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function writeResults writes every file in input order, with a header line naming the file and then whatever processInvoice rendered for
+//it (each transaction set's schema report, invoice, or error). A file that couldn't be opened gets its error message in the same spot
+//instead. The rendered text isn't copied again: the whole batch goes to the sink as one list of pieces (one writev() for a file), with only
+//the short header lines built here.
+//
+//*******************************************************************************************************************************************
+
+void BatchProcessor::writeResults(OutputSink& sink) const {
+
+	vector <string> headers(results.size());
+	vector <string_view> pieces;
+
+	pieces.reserve(results.size() * 4);
+
+	for (size_t i = 0; i < results.size(); i++) {
+
+		const BatchInvoiceResult& result = results[i];
+
+		headers[i] = "===== " + result.fileName + " =====\n";
+		pieces.push_back(headers[i]);
+
+		if (result.outcome == INVOICE_CANNOT_OPEN) {
+			pieces.push_back("FAILED: ");
+			pieces.push_back(result.errorMessage);
+			pieces.push_back("\n\n");
+		}
+
+		else {
+			pieces.push_back(result.renderedInvoice);
+		}
+
+	}
+
+	sink.writeBatch(pieces);
+	sink.flush();
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function displaySummary prints how many files and transaction sets went through, how many failed, and the throughput in files/s and MB/s.
+//
+//*******************************************************************************************************************************************
+
+void BatchProcessor::displaySummary(ostream& out) const {
+
+	double seconds = (elapsedSeconds > 0.0) ? elapsedSeconds : 1e-9;
+	double megabytes = totalInputBytes / (1024.0 * 1024.0);
+
+	out << "Processed " << results.size() << " file(s) holding " << getNumTransactionSets() << " transaction set(s) on " << pool.getNumThreads() << " thread(s), " << getNumFailures() << " failed, " << getNumSchemaInvalid() << " with schema errors, " << getNumTotalMismatched() << " with a TDS01 total that doesn't add up." << endl;
+	out << fixed << setprecision(3) << "Elapsed: " << elapsedSeconds << " s" << endl;
+	out << setprecision(1) << "Throughput: " << results.size() / seconds << " files/s, " << setprecision(2) << megabytes / seconds << " MB/s" << endl;
+
+}
+
+
+
+size_t BatchProcessor::getNumTransactionSets() const {
+
+	size_t numTransactionSets = 0;
+
+	for (const BatchInvoiceResult& result : results) {
+		numTransactionSets += result.transactionSets.size();
+	}
+
+	return numTransactionSets;
+
+}
+
+
+
+size_t BatchProcessor::getNumFailures() const {
+
+	size_t numFailures = 0;
+
+	for (const BatchInvoiceResult& result : results) {
+
+		numFailures += (result.outcome == INVOICE_CANNOT_OPEN);
+
+		for (const TransactionSetResult& transactionSet : result.transactionSets) {
+			numFailures += (transactionSet.outcome != INVOICE_RENDERED);
+		}
+
+	}
+
+	return numFailures;
+
+}
+
+
+
+size_t BatchProcessor::getNumSchemaInvalid() const {
+
+	size_t numSchemaInvalid = 0;
+
+	for (const BatchInvoiceResult& result : results) {
+
+		for (const TransactionSetResult& transactionSet : result.transactionSets) {
+			numSchemaInvalid += (transactionSet.outcome == INVOICE_RENDERED && transactionSet.numSchemaErrors > 0);
+		}
+
+	}
+
+	return numSchemaInvalid;
+
+}
+
+
+
+size_t BatchProcessor::getNumTotalMismatched() const {
+
+	size_t numTotalMismatched = 0;
+
+	for (const BatchInvoiceResult& result : results) {
+
+		for (const TransactionSetResult& transactionSet : result.transactionSets) {
+			numTotalMismatched += (transactionSet.outcome == INVOICE_RENDERED && transactionSet.numTotalMismatches > 0);
+		}
+
+	}
+
+	return numTotalMismatched;
+
+}
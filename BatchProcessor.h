@@ -0,0 +1,141 @@
+#ifndef BATCHPROCESSOR_H
+#define BATCHPROCESSOR_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "OutputSink.h"
+#include "WorkStealingPool.h"
+using namespace std;
+
+
+//The BatchProcessor class takes a pile of 810 files (directories, individual files, or @list files with one path per line) and runs each
+//one through the same parse/validate/render pipeline the menu uses, spread across every core. A file can be a bare transaction set or a
+//whole ISA/GS interchange with any number of them; each ST...SE gets its own result, the same as stream mode. Results are kept in the order
+//the files were given, so the output is the same no matter which thread finished first.
+
+enum BatchRenderFormat {
+
+	RENDER_HUMAN,		//The same invoice option 1 shows, with any schema errors listed ahead of it.
+	RENDER_MACHINE,		//Tab-separated sequence number, element ID, and value (appendInvoiceForMachines).
+	RENDER_VALIDATION	//Only the schema validation report; nothing is rendered.
+
+};
+
+enum InvoiceOutcome {
+
+	INVOICE_RENDERED,
+	INVOICE_NOT_TRANSACTION_SET,	//Read fine, but failed validateInvoiceEnvelope.
+	INVOICE_CANNOT_OPEN
+
+};
+
+struct TransactionSetResult {
+
+	size_t sequence; //1 for the first transaction set in the file, 2 for the next...
+	string interchangeControlNumber; //ISA13 and GS06 of the envelope around it, empty if there wasn't one.
+	string groupControlNumber;
+	InvoiceOutcome outcome; //INVOICE_RENDERED or INVOICE_NOT_TRANSACTION_SET.
+	string errorMessage;
+	size_t numSchemaErrors; //From SchemaValidator. These get reported, but the invoice is still rendered.
+	size_t numTotalMismatches; //TDS01s that didn't match their line items (InvoiceTotalReconciler). Reported the same way.
+
+};
+
+struct BatchInvoiceResult {
+
+	string fileName;
+	size_t inputBytes;
+	bool succeeded; //Every transaction set in the file rendered.
+	InvoiceOutcome outcome; //The worst of its transaction sets', or INVOICE_CANNOT_OPEN.
+	string renderedInvoice; //Every transaction set in order, each with its schema report or FAILED line.
+	string errorMessage; //Why the file couldn't be opened.
+	vector <TransactionSetResult> transactionSets;
+
+};
+
+
+class BatchProcessor {
+
+	private:
+
+		vector <string> inputFiles;
+		vector <BatchInvoiceResult> results;
+		WorkStealingPool pool;
+		BatchRenderFormat renderFormat;
+		double elapsedSeconds;
+		size_t totalInputBytes;
+
+		void processInvoice(size_t fileIndex);
+
+	public:
+
+		//Constructors and destructor
+
+		BatchProcessor(); //See BatchProcessor.cpp for definitions
+
+		BatchProcessor(unsigned threadCount);
+
+		~BatchProcessor() {}
+
+
+		void addInputPath(const string& path); //Throws a string if the path doesn't exist.
+
+		static void collectInputFiles(const string& path, vector <string>& files); //What addInputPath would queue. Throws a string if the path doesn't exist.
+
+		void clearInputFiles(); //Forgets the queued files and the last run's results so the same processor (and its pool) can take another batch.
+
+		void run();
+
+		void writeResults(OutputSink& sink) const; //Throws a string if the sink won't take the output.
+
+		void displaySummary(ostream& out) const;
+
+
+
+		//Mutators
+
+		void setRenderFormat(BatchRenderFormat format)
+		{
+			renderFormat = format;
+		}
+
+
+		//Accessors
+
+		BatchRenderFormat getRenderFormat() const
+		{
+			return renderFormat;
+		}
+
+		size_t getNumInputFiles() const
+		{
+			return inputFiles.size();
+		}
+
+		size_t getNumTransactionSets() const;
+
+		size_t getNumFailures() const; //Transaction sets that failed, plus files that couldn't be opened at all.
+
+		size_t getNumSchemaInvalid() const; //Transaction sets that rendered but had at least one schema error.
+
+		size_t getNumTotalMismatched() const; //Transaction sets that rendered but had a TDS01 that didn't reconcile.
+
+		const vector <BatchInvoiceResult>& getResults() const
+		{
+			return results;
+		}
+
+		double getElapsedSeconds() const
+		{
+			return elapsedSeconds;
+		}
+
+		size_t getTotalInputBytes() const
+		{
+			return totalInputBytes;
+		}
+
+};
+
+#endif
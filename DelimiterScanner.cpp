@@ -0,0 +1,309 @@
+#include "DelimiterScanner.h"
+#include <bitset>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define EDI_SCANNER_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define EDI_TARGET_AVX2
+#else
+#define EDI_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+using namespace std;
+
+
+DelimiterScanner::DelimiterScanner() {
+
+	elementDelimiter = '*';
+	lineDelimiter = '~';
+	subElementDelimiter = '>';
+	scanPath = detectScanPath();
+	buildCharClassTable();
+
+}
+
+DelimiterScanner::DelimiterScanner(char elemDelimiter, char lineDelim, char subElemDelimiter) {
+
+	elementDelimiter = elemDelimiter;
+	lineDelimiter = lineDelim;
+	subElementDelimiter = subElemDelimiter;
+	scanPath = detectScanPath();
+	buildCharClassTable();
+
+}
+
+
+
+void DelimiterScanner::buildCharClassTable() {
+
+	for (int value = 0; value < 256; value++) {
+		charClass[value] = CHAR_DATA;
+	}
+
+	charClass[static_cast<unsigned char>('\r')] = CHAR_LINE_BREAK;
+	charClass[static_cast<unsigned char>('\n')] = CHAR_LINE_BREAK;
+
+	//Assigned rather than OR'd in, so a CR or LF that is a separator stops counting as wrapping. The ORs below cover two slots sharing a character.
+
+	charClass[static_cast<unsigned char>(elementDelimiter)] = CHAR_DATA;
+	charClass[static_cast<unsigned char>(lineDelimiter)] = CHAR_DATA;
+	charClass[static_cast<unsigned char>(subElementDelimiter)] = CHAR_DATA;
+
+	charClass[static_cast<unsigned char>(elementDelimiter)] |= CHAR_ELEMENT_SEPARATOR;
+	charClass[static_cast<unsigned char>(lineDelimiter)] |= CHAR_SEGMENT_TERMINATOR;
+	charClass[static_cast<unsigned char>(subElementDelimiter)] |= CHAR_SUB_ELEMENT_SEPARATOR;
+
+}
+
+
+
+//Helpers shared by the three scan paths. lowestSetBit is the position of the first hit within a block's bitmask.
+
+static inline int lowestSetBit(uint32_t mask) {
+
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return static_cast<int>(index);
+#else
+	return __builtin_ctz(mask);
+#endif
+
+}
+
+static inline void emitMaskPositions(uint32_t mask, size_t blockStart, vector <size_t>& positions) {
+
+	while (mask != 0) {
+		positions.push_back(blockStart + lowestSetBit(mask));
+		mask &= mask - 1; //Clear the lowest set bit.
+	}
+
+}
+
+
+static void findPositionsScalar(const char* data, size_t start, size_t length, const uint8_t charClass[256], vector <size_t>& positions) {
+
+	for (size_t i = start; i < length; i++) {
+
+		if (charClass[static_cast<unsigned char>(data[i])] & CHAR_ANY_SEPARATOR) {
+			positions.push_back(i);
+		}
+
+	}
+
+}
+
+static void countScalar(const char* data, size_t start, size_t length, char first, char second, char third, size_t counts[3]) {
+
+	for (size_t i = start; i < length; i++) {
+
+		char current = data[i];
+
+		counts[0] += (current == first);
+		counts[1] += (current == second);
+		counts[2] += (current == third);
+
+	}
+
+}
+
+
+
+#ifdef EDI_SCANNER_X86
+
+static void findPositionsSSE2(const char* data, size_t length, char first, char second, char third, const uint8_t charClass[256], vector <size_t>& positions) {
+
+	const __m128i firstVec = _mm_set1_epi8(first);
+	const __m128i secondVec = _mm_set1_epi8(second);
+	const __m128i thirdVec = _mm_set1_epi8(third);
+	size_t i = 0;
+
+	for (; i + 16 <= length; i += 16) {
+
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+		__m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, firstVec), _mm_cmpeq_epi8(block, secondVec)), _mm_cmpeq_epi8(block, thirdVec));
+
+		emitMaskPositions(static_cast<uint32_t>(_mm_movemask_epi8(hits)), i, positions);
+
+	}
+
+	findPositionsScalar(data, i, length, charClass, positions);
+
+}
+
+static void countSSE2(const char* data, size_t length, char first, char second, char third, size_t counts[3]) {
+
+	const __m128i firstVec = _mm_set1_epi8(first);
+	const __m128i secondVec = _mm_set1_epi8(second);
+	const __m128i thirdVec = _mm_set1_epi8(third);
+	size_t i = 0;
+
+	for (; i + 16 <= length; i += 16) {
+
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+
+		counts[0] += bitset<16>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, firstVec))).count();
+		counts[1] += bitset<16>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, secondVec))).count();
+		counts[2] += bitset<16>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, thirdVec))).count();
+
+	}
+
+	countScalar(data, i, length, first, second, third, counts);
+
+}
+
+
+EDI_TARGET_AVX2 static void findPositionsAVX2(const char* data, size_t length, char first, char second, char third, const uint8_t charClass[256], vector <size_t>& positions) {
+
+	const __m256i firstVec = _mm256_set1_epi8(first);
+	const __m256i secondVec = _mm256_set1_epi8(second);
+	const __m256i thirdVec = _mm256_set1_epi8(third);
+	size_t i = 0;
+
+	for (; i + 32 <= length; i += 32) {
+
+		__m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+		__m256i hits = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, firstVec), _mm256_cmpeq_epi8(block, secondVec)), _mm256_cmpeq_epi8(block, thirdVec));
+
+		emitMaskPositions(static_cast<uint32_t>(_mm256_movemask_epi8(hits)), i, positions);
+
+	}
+
+	findPositionsScalar(data, i, length, charClass, positions);
+
+}
+
+EDI_TARGET_AVX2 static void countAVX2(const char* data, size_t length, char first, char second, char third, size_t counts[3]) {
+
+	const __m256i firstVec = _mm256_set1_epi8(first);
+	const __m256i secondVec = _mm256_set1_epi8(second);
+	const __m256i thirdVec = _mm256_set1_epi8(third);
+	size_t i = 0;
+
+	for (; i + 32 <= length; i += 32) {
+
+		__m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+
+		counts[0] += bitset<32>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, firstVec)))).count();
+		counts[1] += bitset<32>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, secondVec)))).count();
+		counts[2] += bitset<32>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, thirdVec)))).count();
+
+	}
+
+	countScalar(data, i, length, first, second, third, counts);
+
+}
+
+#endif
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function detectScanPath asks the CPU what it supports the first time it's called and remembers the answer. SSE2 is part of the x86-64
+//baseline, so the only real question is AVX2. On MSVC that means checking the CPUID feature bit and that the OS saves the YMM registers.
+//
+//*******************************************************************************************************************************************
+
+ScanPath DelimiterScanner::detectScanPath() {
+
+	static const ScanPath detectedPath = []() {
+
+#ifdef EDI_SCANNER_X86
+#ifdef _MSC_VER
+		int cpuInfo[4];
+		__cpuid(cpuInfo, 1);
+		bool osSavesYmm = (cpuInfo[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+		__cpuidex(cpuInfo, 7, 0);
+		bool hasAvx2 = (cpuInfo[1] & (1 << 5)) != 0;
+		return (osSavesYmm && hasAvx2) ? AVX2_SCAN : SSE2_SCAN;
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") ? AVX2_SCAN : SSE2_SCAN;
+#endif
+#else
+		return SCALAR_SCAN;
+#endif
+
+	}();
+
+	return detectedPath;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function findPositions records where every delimiter is, in order, using whichever path this scanner was set up with. The tokenizer
+//works off this list instead of comparing each byte itself.
+//
+//*******************************************************************************************************************************************
+
+void DelimiterScanner::findPositions(string_view contents, vector <size_t>& positions) const {
+
+	const char* data = contents.data();
+	size_t length = contents.size();
+
+#ifdef EDI_SCANNER_X86
+
+	if (scanPath == AVX2_SCAN) {
+		findPositionsAVX2(data, length, elementDelimiter, lineDelimiter, subElementDelimiter, charClass, positions);
+		return;
+	}
+
+	if (scanPath == SSE2_SCAN) {
+		findPositionsSSE2(data, length, elementDelimiter, lineDelimiter, subElementDelimiter, charClass, positions);
+		return;
+	}
+
+#endif
+
+	findPositionsScalar(data, 0, length, charClass, positions);
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function countDelimiters tallies each kind of delimiter in one sweep. When two of the delimiters are the same character (a caller that
+//doesn't care about sub-elements can pass the element delimiter twice), both counts include it.
+//
+//*******************************************************************************************************************************************
+
+void DelimiterScanner::countDelimiters(string_view contents, size_t& elementCount, size_t& lineCount, size_t& subElementCount) const {
+
+	size_t counts[3] = { 0, 0, 0 };
+	const char* data = contents.data();
+	size_t length = contents.size();
+
+#ifdef EDI_SCANNER_X86
+
+	if (scanPath == AVX2_SCAN) {
+		countAVX2(data, length, elementDelimiter, lineDelimiter, subElementDelimiter, counts);
+	}
+
+	else if (scanPath == SSE2_SCAN) {
+		countSSE2(data, length, elementDelimiter, lineDelimiter, subElementDelimiter, counts);
+	}
+
+	else {
+		countScalar(data, 0, length, elementDelimiter, lineDelimiter, subElementDelimiter, counts);
+	}
+
+#else
+
+	countScalar(data, 0, length, elementDelimiter, lineDelimiter, subElementDelimiter, counts);
+
+#endif
+
+	elementCount = counts[0];
+	lineCount = counts[1];
+	subElementCount = counts[2];
+
+}
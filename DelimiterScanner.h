@@ -0,0 +1,107 @@
+#ifndef DELIMITERSCANNER_H
+#define DELIMITERSCANNER_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+using namespace std;
+
+
+//The DelimiterScanner class finds every element, segment, and sub-element separator in a buffer in one sweep. On x86 it compares 32 bytes
+//at a time with AVX2 (or 16 with SSE2) and only falls back to a byte-by-byte loop where neither is available. Which path gets used is
+//decided once at runtime based on what the CPU supports. The separators are whatever the scanner is built with, so every path runs at the
+//same speed for | ^ or newline terminators as it does for * and ~.
+//
+//It also keeps a 256-entry character-class table for those separators. The scalar path is one lookup per byte, and the tokenizer uses the
+//same table to tell what kind of separator each hit was without comparing against each one in turn.
+
+enum ScanPath { SCALAR_SCAN, SSE2_SCAN, AVX2_SCAN };
+
+enum CharClass : uint8_t { //Bit flags, since a caller that doesn't split sub-elements passes the element separator in that slot too.
+
+	CHAR_DATA = 0,
+	CHAR_ELEMENT_SEPARATOR = 1,
+	CHAR_SEGMENT_TERMINATOR = 2,
+	CHAR_SUB_ELEMENT_SEPARATOR = 4,
+	CHAR_LINE_BREAK = 8, //CR or LF that isn't one of the separators, i.e. wrapping between segments.
+	CHAR_ANY_SEPARATOR = CHAR_ELEMENT_SEPARATOR | CHAR_SEGMENT_TERMINATOR | CHAR_SUB_ELEMENT_SEPARATOR
+
+};
+
+
+class DelimiterScanner {
+
+	private:
+
+		char elementDelimiter;
+		char lineDelimiter;
+		char subElementDelimiter;
+		ScanPath scanPath;
+		uint8_t charClass[256];
+
+		void buildCharClassTable();
+
+	public:
+
+		//Constructors and destructor
+
+		DelimiterScanner(); //See DelimiterScanner.cpp for definitions
+
+		DelimiterScanner(char elemDelimiter, char lineDelim, char subElemDelimiter);
+
+		~DelimiterScanner() {}
+
+
+		//Appends the offset of every delimiter in contents to positions, in order. The kind of each hit is just contents[offset].
+		void findPositions(string_view contents, vector <size_t>& positions) const;
+
+		//Counts each kind of delimiter without recording where they are.
+		void countDelimiters(string_view contents, size_t& elementCount, size_t& lineCount, size_t& subElementCount) const;
+
+		static ScanPath detectScanPath(); //Checks the CPU once and caches the answer.
+
+
+
+		//Mutators
+
+		void setScanPath(ScanPath path) //Mostly useful for benchmarking the paths against each other. Asking for a path the CPU can't run gets the best one it can.
+		{
+			scanPath = (path > detectScanPath()) ? detectScanPath() : path;
+		}
+
+
+		//Accessors
+
+		uint8_t getCharClass(char value) const
+		{
+			return charClass[static_cast<unsigned char>(value)];
+		}
+
+		char getElementDelimiter() const
+		{
+			return elementDelimiter;
+		}
+
+		char getLineDelimiter() const
+		{
+			return lineDelimiter;
+		}
+
+		char getSubElementDelimiter() const
+		{
+			return subElementDelimiter;
+		}
+
+		ScanPath getScanPath() const
+		{
+			return scanPath;
+		}
+
+		static const char* getScanPathName(ScanPath path)
+		{
+			return (path == AVX2_SCAN) ? "AVX2" : (path == SSE2_SCAN) ? "SSE2" : "scalar";
+		}
+
+};
+
+#endif
@@ -0,0 +1,92 @@
+#include "DocumentArena.h"
+using namespace std;
+
+
+DocumentArena::DocumentArena() : DocumentArena(64 * 1024) {}
+
+DocumentArena::DocumentArena(size_t blockBytes) {
+
+	currentBlock = 0;
+	blockOffset = 0;
+	blockSize = (blockBytes < 1024) ? 1024 : blockBytes;
+	bytesInUse = 0;
+	peakBytes = 0;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function allocate hands out the next suitably aligned chunk of the current block. When a block fills up it moves on to the next one
+//(reusing blocks left over from before a reset when it can), and a request bigger than the normal block size just gets a block of its own.
+//
+//*******************************************************************************************************************************************
+
+void* DocumentArena::allocate(size_t bytes, size_t alignment) {
+
+	while (currentBlock < blocks.size()) {
+
+		Block& block = blocks[currentBlock];
+		size_t alignedOffset = (blockOffset + alignment - 1) & ~(alignment - 1);
+
+		if (alignedOffset + bytes <= block.capacity) {
+
+			blockOffset = alignedOffset + bytes;
+			bytesInUse += bytes;
+
+			if (bytesInUse > peakBytes) {
+				peakBytes = bytesInUse;
+			}
+
+			return block.memory.get() + alignedOffset;
+
+		}
+
+		currentBlock++;
+		blockOffset = 0;
+
+	}
+
+	size_t capacity = (bytes + alignment > blockSize) ? bytes + alignment : blockSize;
+
+	blocks.push_back(Block{ unique_ptr<char[]>(new char[capacity]), capacity });
+	currentBlock = blocks.size() - 1;
+	blockOffset = 0;
+
+	return allocate(bytes, alignment);
+
+}
+
+
+
+void DocumentArena::reset() {
+
+	currentBlock = 0;
+	blockOffset = 0;
+	bytesInUse = 0;
+
+}
+
+
+
+void DocumentArena::release() {
+
+	blocks.clear();
+	reset();
+
+}
+
+
+
+size_t DocumentArena::getBytesReserved() const {
+
+	size_t bytesReserved = 0;
+
+	for (const Block& block : blocks) {
+		bytesReserved += block.capacity;
+	}
+
+	return bytesReserved;
+
+}
@@ -0,0 +1,76 @@
+#ifndef DOCUMENTARENA_H
+#define DOCUMENTARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+using namespace std;
+
+
+//The DocumentArena class is a bump allocator for everything that belongs to one parsed document. Allocating is just moving a pointer
+//forward, nothing is ever freed one object at a time, and reset() throws the whole document away at once while keeping the blocks around
+//for the next document.
+
+class DocumentArena {
+
+	private:
+
+		struct Block {
+
+			unique_ptr <char[]> memory;
+			size_t capacity;
+
+		};
+
+		vector <Block> blocks;
+		size_t currentBlock;
+		size_t blockOffset;
+		size_t blockSize;
+		size_t bytesInUse;
+		size_t peakBytes;
+
+	public:
+
+		//Constructors and destructor
+
+		DocumentArena(); //See DocumentArena.cpp for definitions
+
+		DocumentArena(size_t blockBytes);
+
+		~DocumentArena() {}
+
+		DocumentArena(const DocumentArena&) = delete;
+		DocumentArena& operator=(const DocumentArena&) = delete;
+
+
+		void* allocate(size_t bytes, size_t alignment);
+
+		template <typename T>
+		T* allocateArray(size_t count) //Memory is uninitialized; every caller here fills its arrays completely.
+		{
+			return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+		}
+
+		void reset(); //Frees everything in one shot. Blocks are kept for reuse.
+
+		void release(); //Like reset, but hands the blocks back to the system too.
+
+
+
+		//Accessors
+
+		size_t getBytesInUse() const
+		{
+			return bytesInUse;
+		}
+
+		size_t getPeakBytes() const
+		{
+			return peakBytes;
+		}
+
+		size_t getBytesReserved() const;
+
+};
+
+#endif
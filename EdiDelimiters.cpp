@@ -0,0 +1,150 @@
+#include "EdiDelimiters.h"
+using namespace std;
+
+
+//Every element separator in an ISA sits at one of these offsets, since every ISA element has a fixed width.
+static const size_t isaSeparatorOffsets[] = { 3, 6, 17, 20, 31, 34, 50, 53, 69, 76, 81, 83, 89, 99, 101, 103 };
+
+
+static bool isAlphanumeric(char value) {
+
+	return (value >= '0' && value <= '9') || (value >= 'A' && value <= 'Z') || (value >= 'a' && value <= 'z');
+
+}
+
+static bool isUsableSeparator(char value) { //Letters, digits, and spaces all turn up inside element values.
+
+	return !isAlphanumeric(value) && value != ' ';
+
+}
+
+
+
+size_t skipLeadingFiller(string_view contents) {
+
+	size_t start = 0;
+
+	if (contents.substr(0, 3) == "\xEF\xBB\xBF") {
+		start = 3;
+	}
+
+	while (start < contents.size() && (contents[start] == ' ' || contents[start] == '\t' || contents[start] == '\r' || contents[start] == '\n')) {
+		start++;
+	}
+
+	return start;
+
+}
+
+
+
+bool detectDelimiters(string_view contents, EdiDelimiters& delimiters) {
+
+	contents.remove_prefix(skipLeadingFiller(contents));
+
+	if (contents.substr(0, 3) == "ISA") {
+		return detectDelimitersFromISA(contents, delimiters);
+	}
+
+	if (contents.substr(0, 2) == "ST") {
+		return detectDelimitersFromST(contents, delimiters);
+	}
+
+	return false;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function detectDelimitersFromISA reads the separators from their fixed offsets, then checks that the element separator really is at all
+//sixteen places it should be. A truncated or hand-edited ISA with a field the wrong width fails that check rather than being misread.
+//
+//*******************************************************************************************************************************************
+
+bool detectDelimitersFromISA(string_view contents, EdiDelimiters& delimiters) {
+
+	if (contents.size() < ISA_SEGMENT_LENGTH || contents.substr(0, 3) != "ISA") {
+		return false;
+	}
+
+	EdiDelimiters detected;
+
+	detected.element = contents[ISA_ELEMENT_SEPARATOR_OFFSET];
+	detected.subElement = contents[ISA_SUB_ELEMENT_SEPARATOR_OFFSET];
+	detected.segment = contents[ISA_SEGMENT_TERMINATOR_OFFSET];
+	detected.repetition = isUsableSeparator(contents[ISA_REPETITION_SEPARATOR_OFFSET]) ? contents[ISA_REPETITION_SEPARATOR_OFFSET] : '\0';
+	detected.source = DELIMITERS_FROM_ISA;
+
+	for (size_t offset : isaSeparatorOffsets) {
+
+		if (contents[offset] != detected.element) {
+			return false;
+		}
+
+	}
+
+	if (!isUsableSeparator(detected.element) || detected.segment == detected.element || detected.subElement == detected.element || detected.subElement == detected.segment) {
+		return false;
+	}
+
+	if (isAlphanumeric(detected.segment) || detected.repetition == detected.element || detected.repetition == detected.segment || detected.repetition == detected.subElement) {
+		return false;
+	}
+
+	delimiters = detected;
+
+	return true;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function detectDelimitersFromST works from "ST", separator, transaction set ID, separator, control number. ST01 and ST02 (and ST03, if it's
+//there) are letters, digits, and the odd '.' or '-', so the first thing after them that isn't one of those is the terminator. Only the
+//element separator and terminator come from here; the sub-element separator isn't declared anywhere outside an ISA.
+//
+//*******************************************************************************************************************************************
+
+bool detectDelimitersFromST(string_view contents, EdiDelimiters& delimiters) {
+
+	if (contents.size() < 4 || contents.substr(0, 2) != "ST" || !isUsableSeparator(contents[2])) {
+		return false;
+	}
+
+	char element = contents[2];
+	int elementsSeen = 1;
+
+	for (size_t i = 3; i < contents.size() && i < 64; i++) {
+
+		char current = contents[i];
+
+		if (isAlphanumeric(current) || current == '.' || current == '-') {
+			continue;
+		}
+
+		if (current == element) {
+			elementsSeen++;
+			continue;
+		}
+
+		if (elementsSeen < 2 || current == ' ') { //Has to get past ST02 first, and a space is data, not a terminator.
+			return false;
+		}
+
+		delimiters.element = element;
+		delimiters.segment = current;
+		delimiters.subElement = (delimiters.subElement == element || delimiters.subElement == current) ? '\0' : delimiters.subElement;
+		delimiters.repetition = (delimiters.repetition == element || delimiters.repetition == current) ? '\0' : delimiters.repetition;
+		delimiters.source = DELIMITERS_FROM_ST;
+
+		return true;
+
+	}
+
+	return false;
+
+}
@@ -0,0 +1,50 @@
+#ifndef EDIDELIMITERS_H
+#define EDIDELIMITERS_H
+
+#include <cstddef>
+#include <string_view>
+using namespace std;
+
+
+//X12 doesn't fix its separators; each interchange declares its own in the ISA segment, which is the one segment with a fixed layout. ISA is
+//always 106 bytes: the element separator is byte 3, ISA16 (the sub-element separator) is byte 104, and the segment terminator is byte 105.
+//ISA11 (byte 82) is the repetition separator from version 00402 on; in 00401 it's a "U" and there isn't one.
+//
+//A bare transaction set (no ISA, like the Kroger sample) still gives its separators away: the byte right after "ST" is the element
+//separator, and the segment terminator is whatever comes after the ST02 control number (or ST03, if it's there).
+//
+//Kroger's convention is * ~ >, which is what everything falls back to when there's nothing to detect from.
+
+const size_t ISA_SEGMENT_LENGTH = 106;
+const size_t ISA_ELEMENT_SEPARATOR_OFFSET = 3;
+const size_t ISA_REPETITION_SEPARATOR_OFFSET = 82;
+const size_t ISA_SUB_ELEMENT_SEPARATOR_OFFSET = 104;
+const size_t ISA_SEGMENT_TERMINATOR_OFFSET = 105;
+
+enum DelimiterSource { DELIMITERS_DEFAULT, DELIMITERS_FROM_ISA, DELIMITERS_FROM_ST };
+
+struct EdiDelimiters {
+
+	char element;
+	char segment;
+	char subElement;
+	char repetition; //'\0' if the interchange doesn't declare one.
+	DelimiterSource source;
+
+};
+
+constexpr EdiDelimiters DEFAULT_EDI_DELIMITERS = { '*', '~', '>', '\0', DELIMITERS_DEFAULT };
+
+
+//Looks at the start of contents (after any byte-order mark, spaces, or line breaks) and fills in delimiters from the ISA or ST header found
+//there. Returns false, leaving delimiters alone, if neither is there or the header doesn't hang together (separators that are letters or
+//digits, or that collide with each other).
+bool detectDelimiters(string_view contents, EdiDelimiters& delimiters);
+
+bool detectDelimitersFromISA(string_view contents, EdiDelimiters& delimiters); //contents has to start with "ISA".
+
+bool detectDelimitersFromST(string_view contents, EdiDelimiters& delimiters); //contents has to start with "ST".
+
+size_t skipLeadingFiller(string_view contents); //Offset of the first byte past a UTF-8 byte-order mark and any whitespace.
+
+#endif
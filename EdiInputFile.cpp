@@ -0,0 +1,192 @@
+#include "EdiInputFile.h"
+#include "PipelineStats.h"
+#include <fstream>
+#include <iterator>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+
+EdiInputFile::EdiInputFile() {
+
+	fileName = "";
+	data = nullptr;
+	size = 0;
+	mapped = false;
+
+#ifdef _WIN32
+	fileHandle = INVALID_HANDLE_VALUE;
+	mappingHandle = nullptr;
+#else
+	fileDescriptor = -1;
+#endif
+
+}
+
+EdiInputFile::~EdiInputFile() {
+
+	close();
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function open maps the named file read-only. Empty files can't be mapped on either platform, so those just get an empty view. If mapping
+//fails for any other reason, the file is read into fallbackContents instead so callers never have to care which one happened.
+//
+//*******************************************************************************************************************************************
+
+void EdiInputFile::open(const string& path) {
+
+	string cannotLocateFileException = "ERROR. File cannot open. Please check the directory.\n";
+	StageSpan span(STAGE_READ_INPUT); //Mostly the open and map; the pages themselves are read in during tokenize.
+
+	close();
+	fileName = path;
+
+#ifdef _WIN32
+
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE) {
+		throw cannotLocateFileException;
+	}
+
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(file, &fileSize);
+	fileHandle = file;
+	size = static_cast<size_t>(fileSize.QuadPart);
+
+	if (size > 0) {
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		if (mapping != nullptr) {
+
+			const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+			if (view != nullptr) {
+				mappingHandle = mapping;
+				data = static_cast<const char*>(view);
+				mapped = true;
+				span.addWork(size, 0, 0);
+				return;
+			}
+
+			CloseHandle(mapping);
+
+		}
+
+	}
+
+#else
+
+	int fd = ::open(path.c_str(), O_RDONLY);
+
+	if (fd < 0) {
+		throw cannotLocateFileException;
+	}
+
+	struct stat fileStats;
+
+	if (fstat(fd, &fileStats) == 0 && S_ISREG(fileStats.st_mode)) {
+
+		fileDescriptor = fd;
+		size = static_cast<size_t>(fileStats.st_size);
+
+		if (size > 0) {
+
+			void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+			if (view != MAP_FAILED) {
+				madvise(view, size, MADV_SEQUENTIAL); //The tokenizer reads front to back exactly once.
+				data = static_cast<const char*>(view);
+				mapped = true;
+				span.addWork(size, 0, 0);
+				return;
+			}
+
+		}
+
+	}
+
+	else {
+		::close(fd);
+	}
+
+#endif
+
+	//Fallback: either the file is empty or it couldn't be mapped. Read it the old-fashioned way.
+
+	ifstream fallbackStream(path, ios::in | ios::binary);
+
+	if (!fallbackStream) {
+		close();
+		throw cannotLocateFileException;
+	}
+
+	fallbackContents.assign(istreambuf_iterator<char>(fallbackStream), istreambuf_iterator<char>());
+	data = fallbackContents.data();
+	size = fallbackContents.size();
+	span.addWork(size, 0, 0);
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function close releases the mapping (or the fallback buffer) and the file handle. Safe to call more than once.
+//
+//*******************************************************************************************************************************************
+
+void EdiInputFile::close() {
+
+#ifdef _WIN32
+
+	if (mapped) {
+		UnmapViewOfFile(data);
+	}
+
+	if (mappingHandle != nullptr) {
+		CloseHandle(mappingHandle);
+		mappingHandle = nullptr;
+	}
+
+	if (fileHandle != INVALID_HANDLE_VALUE) {
+		CloseHandle(fileHandle);
+		fileHandle = INVALID_HANDLE_VALUE;
+	}
+
+#else
+
+	if (mapped) {
+		munmap(const_cast<char*>(data), size);
+	}
+
+	if (fileDescriptor >= 0) {
+		::close(fileDescriptor);
+		fileDescriptor = -1;
+	}
+
+#endif
+
+	data = nullptr;
+	size = 0;
+	mapped = false;
+	fallbackContents.clear();
+	fallbackContents.shrink_to_fit();
+
+}
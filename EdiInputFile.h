@@ -0,0 +1,76 @@
+#ifndef EDIINPUTFILE_H
+#define EDIINPUTFILE_H
+
+#include <string>
+#include <string_view>
+using namespace std;
+
+
+//The EdiInputFile class maps an EDI file straight into memory so the whole interchange can be handed to the tokenizer as one view with no
+//copy and no per-line allocation. If the file can't be mapped (a pipe, for instance), it quietly falls back to reading it into a string.
+
+class EdiInputFile {
+
+	private:
+
+		string fileName;
+		const char* data;
+		size_t size;
+		bool mapped;
+		string fallbackContents;
+
+#ifdef _WIN32
+		void* fileHandle;
+		void* mappingHandle;
+#else
+		int fileDescriptor;
+#endif
+
+	public:
+
+		//Constructors and destructor
+
+		EdiInputFile(); //See EdiInputFile.cpp for definitions
+
+		~EdiInputFile();
+
+		EdiInputFile(const EdiInputFile&) = delete; //A mapping can only be released once, so copying isn't allowed.
+		EdiInputFile& operator=(const EdiInputFile&) = delete;
+
+
+		void open(const string& path); //Throws a string if the file can't be opened, same as the rest of the program.
+
+		void close();
+
+
+
+		//Accessors
+
+		bool isOpen() const
+		{
+			return data != nullptr;
+		}
+
+		bool isMapped() const
+		{
+			return mapped;
+		}
+
+		string getFileName() const
+		{
+			return fileName;
+		}
+
+		size_t getSize() const
+		{
+			return size;
+		}
+
+		string_view getContents() const
+		{
+			return string_view(data == nullptr ? "" : data, size);
+		}
+
+};
+
+#endif
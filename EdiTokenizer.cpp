@@ -0,0 +1,233 @@
+#include "EdiTokenizer.h"
+#include <algorithm>
+#include "PipelineStats.h"
+using namespace std;
+
+
+EdiTokenizer::EdiTokenizer() : scanner('*', '~', '*') { //The tokenizer doesn't split sub-elements, so the element delimiter stands in for the third scanner slot.
+
+	configuredDelimiters = DEFAULT_EDI_DELIMITERS;
+	delimiters = DEFAULT_EDI_DELIMITERS;
+	autoDetectDelimiters = true;
+
+}
+
+EdiTokenizer::EdiTokenizer(char elemDelimiter, char lineDelim) : scanner(elemDelimiter, lineDelim, elemDelimiter) {
+
+	configuredDelimiters = DEFAULT_EDI_DELIMITERS;
+	configuredDelimiters.element = elemDelimiter;
+	configuredDelimiters.segment = lineDelim;
+	delimiters = configuredDelimiters;
+	autoDetectDelimiters = true;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function useDelimiters switches the scanner over to a new set of separators, keeping whatever scan path it was on. It's skipped when the
+//separators haven't changed, which is every call after the first for a run of same-partner files.
+//
+//*******************************************************************************************************************************************
+
+void EdiTokenizer::useDelimiters(const EdiDelimiters& newDelimiters) {
+
+	bool scannerChanged = (newDelimiters.element != delimiters.element || newDelimiters.segment != delimiters.segment);
+
+	delimiters = newDelimiters;
+
+	if (scannerChanged) {
+
+		ScanPath currentPath = scanner.getScanPath();
+
+		scanner = DelimiterScanner(delimiters.element, delimiters.segment, delimiters.element);
+		scanner.setScanPath(currentPath);
+
+	}
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function tokenize has the DelimiterScanner find every delimiter in one vectorized sweep, then walks that list of positions. Every element
+//delimiter closes off the current element, and every line delimiter closes off both the current element and the current segment. Only
+//offsets and lengths are stored, which replaces the old approach of copying each line and each element through a couple stringstreams.
+//Carriage returns and line feeds that trail a segment terminator (CR/LF-wrapped files) are skipped so they never end up glued to the front
+//of the next segment ID. Any SegmentObservers hear about each segment as soon as it's complete.
+//
+//*******************************************************************************************************************************************
+
+void EdiTokenizer::tokenize(string_view contents) {
+
+	StageSpan span(STAGE_TOKENIZE);
+	EdiDelimiters detectedDelimiters = configuredDelimiters;
+
+	if (autoDetectDelimiters) {
+		detectDelimiters(contents, detectedDelimiters); //Leaves the configured ones in place if there's no header to read.
+	}
+
+	useDelimiters(detectedDelimiters);
+
+	buffer = contents;
+	segments.clear();
+	elements.clear();
+	delimiterPositions.clear();
+
+	scanner.findPositions(buffer, delimiterPositions);
+	elements.reserve(delimiterPositions.size());
+
+	size_t segmentStart = skipLineBreaks(skipLeadingFiller(buffer)); //A byte-order mark or stray leading whitespace isn't part of the first segment ID.
+	size_t elementStart = segmentStart;
+	size_t firstElement = 0;
+
+	for (SegmentObserver* observer : observers) {
+		observer->beginDocument(*this);
+	}
+
+	for (size_t position : delimiterPositions) {
+
+		if (scanner.getCharClass(buffer[position]) & CHAR_SEGMENT_TERMINATOR) {
+
+			elements.push_back({ elementStart, position - elementStart });
+			segments.push_back({ segmentStart, position - segmentStart, firstElement, static_cast<int>(elements.size() - firstElement) });
+
+			for (SegmentObserver* observer : observers) {
+				observer->onSegment(*this, segments.size() - 1);
+			}
+
+			segmentStart = skipLineBreaks(position + 1);
+			elementStart = segmentStart;
+			firstElement = elements.size();
+
+		}
+
+		else {
+
+			elements.push_back({ elementStart, position - elementStart });
+			elementStart = position + 1;
+
+		}
+
+	}
+
+	//Anything after the last line delimiter was never a complete segment, so roll back any elements recorded for it.
+	elements.resize(firstElement);
+
+	for (SegmentObserver* observer : observers) {
+		observer->endDocument(*this);
+	}
+
+	span.addWork(buffer.size(), segments.size(), elements.size());
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function tokenize (from another tokenizer) copies a run of segments and their elements out of sourceTokenizer's tables. The buffer becomes
+//the stretch of source text from the first segment through the last one's terminator, so every offset is moved down by where that stretch
+//starts and every firstElement by the number of elements ahead of it. Observers hear about each segment just as they would from a scan.
+//
+//*******************************************************************************************************************************************
+
+void EdiTokenizer::tokenize(const EdiTokenizer& sourceTokenizer, size_t firstSegment, size_t numSegments) {
+
+	useDelimiters(sourceTokenizer.delimiters);
+
+	segments.clear();
+	elements.clear();
+	delimiterPositions.clear();
+
+	if (numSegments == 0) {
+		buffer = string_view();
+	}
+
+	else {
+
+		const SegmentSpan& first = sourceTokenizer.segments[firstSegment];
+		const SegmentSpan& last = sourceTokenizer.segments[firstSegment + numSegments - 1];
+		size_t textStart = first.offset;
+		size_t textEnd = min(last.offset + last.length + 1, sourceTokenizer.buffer.size()); //Takes in the terminator.
+		size_t elementEnd = last.firstElement + last.numElements;
+
+		buffer = sourceTokenizer.buffer.substr(textStart, textEnd - textStart);
+		segments.reserve(numSegments);
+		elements.reserve(elementEnd - first.firstElement);
+
+		for (size_t i = first.firstElement; i < elementEnd; i++) {
+			elements.push_back({ sourceTokenizer.elements[i].offset - textStart, sourceTokenizer.elements[i].length });
+		}
+
+		for (size_t i = firstSegment; i < firstSegment + numSegments; i++) {
+
+			SegmentSpan segment = sourceTokenizer.segments[i];
+
+			segment.offset -= textStart;
+			segment.firstElement -= first.firstElement;
+			segments.push_back(segment);
+
+		}
+
+	}
+
+	for (SegmentObserver* observer : observers) {
+
+		observer->beginDocument(*this);
+
+		for (size_t i = 0; i < segments.size(); i++) {
+			observer->onSegment(*this, i);
+		}
+
+		observer->endDocument(*this);
+
+	}
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function getElementValue returns the view of an element, substituting "NULL" when there's nothing between the delimiters. This keeps the
+//same convention populateElementDataVect always used.
+//
+//*******************************************************************************************************************************************
+
+string_view EdiTokenizer::getElementValue(size_t elementIndex) const {
+
+	if (elements[elementIndex].length == 0) {
+		return "NULL";
+	}
+
+	return getElementText(elementIndex);
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function skipLineBreaks returns the first position at or after startPos that isn't a CR or LF wrapping character. The scanner's class
+//table already leaves out a CR or LF that's in use as a separator.
+//
+//*******************************************************************************************************************************************
+
+size_t EdiTokenizer::skipLineBreaks(size_t startPos) const {
+
+	while (startPos < buffer.size()) {
+
+		if (scanner.getCharClass(buffer[startPos]) != CHAR_LINE_BREAK) {
+			break;
+		}
+
+		startPos++;
+
+	}
+
+	return startPos;
+
+}
@@ -0,0 +1,181 @@
+#ifndef EDITOKENIZER_H
+#define EDITOKENIZER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "DelimiterScanner.h"
+#include "EdiDelimiters.h"
+using namespace std;
+
+
+//The EdiTokenizer class scans an EDI buffer once and records where every segment and element lives as offset/length pairs into that buffer.
+//Nothing is copied out of the buffer, so whoever owns the buffer has to keep it alive for as long as the tokenizer is being used.
+//
+//Each buffer's separators are read from its own ISA (or ST) header before scanning (see EdiDelimiters.h), so a partner using | ^ or newline
+//terminators tokenizes the same as Kroger's * and ~. The configured delimiters are only the fallback for a buffer with no header to read.
+//Sub-elements aren't split; a composite element comes back whole, and getDelimiters().subElement says how to split it.
+
+struct ElementSpan {
+
+	size_t offset;
+	size_t length;
+
+};
+
+struct SegmentSpan {
+
+	size_t offset;
+	size_t length;
+	size_t firstElement; //Index into the element table of element 00 (the segment ID itself).
+	int numElements;
+
+};
+
+
+class EdiTokenizer;
+
+
+//A SegmentObserver gets called by the tokenizer the moment each segment is closed off, so things like schema validation can run in the same
+//pass as tokenizing instead of walking the document again afterwards. Element spans for the segment are already in place by then.
+
+class SegmentObserver {
+
+	public:
+
+		virtual ~SegmentObserver() {}
+
+		virtual void beginDocument(const EdiTokenizer&) {}
+
+		virtual void onSegment(const EdiTokenizer& invoiceTokenizer, size_t segmentIndex) = 0;
+
+		virtual void endDocument(const EdiTokenizer&) {}
+
+};
+
+
+class EdiTokenizer {
+
+	private:
+
+		string_view buffer;
+		EdiDelimiters configuredDelimiters;
+		EdiDelimiters delimiters; //What the current buffer actually uses.
+		bool autoDetectDelimiters;
+		vector <SegmentSpan> segments;
+		vector <ElementSpan> elements;
+		vector <size_t> delimiterPositions; //Scratch space reused between tokenize calls.
+		DelimiterScanner scanner;
+		vector <SegmentObserver*> observers;
+
+		size_t skipLineBreaks(size_t startPos) const;
+		void useDelimiters(const EdiDelimiters& newDelimiters);
+
+		friend class ParallelTokenizer; //Tokenizes chunks of a buffer on separate tokenizers and merges their tables into this one.
+
+	public:
+
+		//Constructors and destructor
+
+		EdiTokenizer(); //See EdiTokenizer.cpp for definitions
+
+		EdiTokenizer(char elemDelimiter, char lineDelim);
+
+		~EdiTokenizer() {}
+
+
+		void tokenize(string_view contents);
+
+		//Takes numSegments segments starting at firstSegment out of a tokenizer that has already been run (a ParallelTokenizer's merged
+		//tables, say), leaving this one exactly as if the text of just those segments had been tokenized on its own. Nothing is scanned again.
+		void tokenize(const EdiTokenizer& sourceTokenizer, size_t firstSegment, size_t numSegments);
+
+
+		//Mutators
+
+		void setScanPath(ScanPath path)
+		{
+			scanner.setScanPath(path);
+		}
+
+		void setDelimiters(const EdiDelimiters& fallbackDelimiters) //Used as-is when auto-detection is off or finds nothing.
+		{
+			configuredDelimiters = fallbackDelimiters;
+			useDelimiters(fallbackDelimiters);
+		}
+
+		void setAutoDetectDelimiters(bool detect)
+		{
+			autoDetectDelimiters = detect;
+		}
+
+		void addSegmentObserver(SegmentObserver* observer) //The tokenizer doesn't own observers; they have to outlive any tokenize calls.
+		{
+			observers.push_back(observer);
+		}
+
+		void clearSegmentObservers()
+		{
+			observers.clear();
+		}
+
+
+
+
+		//Accessors
+
+		const DelimiterScanner& getScanner() const
+		{
+			return scanner;
+		}
+
+		const EdiDelimiters& getDelimiters() const //The separators the last tokenize call used.
+		{
+			return delimiters;
+		}
+
+		string_view getBuffer() const
+		{
+			return buffer;
+		}
+
+		size_t getNumSegments() const
+		{
+			return segments.size();
+		}
+
+		size_t getNumElements() const
+		{
+			return elements.size();
+		}
+
+		const SegmentSpan& getSegment(size_t segmentIndex) const
+		{
+			return segments[segmentIndex];
+		}
+
+		const ElementSpan& getElement(size_t elementIndex) const
+		{
+			return elements[elementIndex];
+		}
+
+		string_view getSegmentText(size_t segmentIndex) const
+		{
+			return buffer.substr(segments[segmentIndex].offset, segments[segmentIndex].length);
+		}
+
+		string_view getSegmentID(size_t segmentIndex) const
+		{
+			return getElementText(segments[segmentIndex].firstElement);
+		}
+
+		string_view getElementText(size_t elementIndex) const
+		{
+			return buffer.substr(elements[elementIndex].offset, elements[elementIndex].length);
+		}
+
+		string_view getElementValue(size_t elementIndex) const; //Same as getElementText, but gives back "NULL" for empty elements like the rest of the program expects.
+
+};
+
+#endif
@@ -0,0 +1,291 @@
+#include "EdiValueDecoder.h"
+using namespace std;
+
+
+EdiDataType getEdiDataType(string_view schemaType) {
+
+	if (schemaType == "AN") {
+		return TYPE_AN;
+	}
+
+	if (schemaType == "ID") {
+		return TYPE_ID;
+	}
+
+	if (schemaType == "DT") {
+		return TYPE_DT;
+	}
+
+	if (schemaType == "R") {
+		return TYPE_R;
+	}
+
+	if (schemaType == "N0") {
+		return TYPE_N0;
+	}
+
+	if (schemaType == "N2") {
+		return TYPE_N2;
+	}
+
+	return TYPE_UNKNOWN;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function decodeFixedPoint turns a numeric element into ten-thousandths. impliedDecimals is 0 for R and N0 and 2 for N2 ("6770" is 67.70).
+//If the value has an explicit decimal point, the point wins over the implied decimals -- partners do send "67.70" in N2 fields, and
+//SchemaValidator warns about it, but the amount is still clear. Digits past the fourth decimal place are rounded half away from zero.
+//Returns false for anything that isn't a number or won't fit in 64 bits.
+//
+//*******************************************************************************************************************************************
+
+bool decodeFixedPoint(string_view value, int impliedDecimals, int64_t& scaledValue) {
+
+	const int64_t MANTISSA_LIMIT = (INT64_MAX - 9) / 10;
+	bool negative = false;
+	bool hasDecimalPoint = false;
+	int fractionDigits = 0;
+	int digitCount = 0;
+	int64_t mantissa = 0;
+	size_t i = 0;
+
+	if (!value.empty() && value[0] == '-') {
+		negative = true;
+		i = 1;
+	}
+
+	for (; i < value.length(); i++) {
+
+		char valueChar = value[i];
+
+		if (valueChar == '.' && !hasDecimalPoint) {
+			hasDecimalPoint = true;
+			continue;
+		}
+
+		if (valueChar < '0' || valueChar > '9') {
+			return false;
+		}
+
+		digitCount++;
+
+		if (hasDecimalPoint) {
+
+			if (fractionDigits > FIXED_POINT_DECIMALS) { //Already have the digit needed for rounding; the rest can't change the answer.
+				continue;
+			}
+
+			fractionDigits++;
+
+		}
+
+		if (mantissa > MANTISSA_LIMIT) {
+			return false;
+		}
+
+		mantissa = mantissa * 10 + (valueChar - '0');
+
+	}
+
+	if (digitCount == 0) {
+		return false;
+	}
+
+	if (!hasDecimalPoint) {
+		fractionDigits = impliedDecimals;
+	}
+
+	//Line the mantissa up with FIXED_POINT_DECIMALS places, rounding if there were more than that.
+
+	for (int scale = fractionDigits; scale < FIXED_POINT_DECIMALS; scale++) {
+
+		if (mantissa > INT64_MAX / 10) {
+			return false;
+		}
+
+		mantissa *= 10;
+
+	}
+
+	if (fractionDigits > FIXED_POINT_DECIMALS) {
+
+		int64_t divisor = 1;
+
+		for (int scale = FIXED_POINT_DECIMALS; scale < fractionDigits; scale++) {
+			divisor *= 10;
+		}
+
+		mantissa = (mantissa + divisor / 2) / divisor;
+
+	}
+
+	scaledValue = negative ? -mantissa : mantissa;
+
+	return true;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function decodePackedDate checks a CCYYMMDD date and hands it back as the integer CCYYMMDD. Anything that isn't eight digits making a real
+//calendar date returns false.
+//
+//*******************************************************************************************************************************************
+
+bool decodePackedDate(string_view value, uint32_t& packedDate) {
+
+	const int DAYS_IN_MONTH[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+	uint32_t date = 0;
+
+	if (value.length() != 8) {
+		return false;
+	}
+
+	for (char dateChar : value) {
+
+		if (dateChar < '0' || dateChar > '9') {
+			return false;
+		}
+
+		date = date * 10 + (dateChar - '0');
+
+	}
+
+	uint32_t year = date / 10000;
+	uint32_t month = (date / 100) % 100;
+	uint32_t day = date % 100;
+	bool leapYear = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+
+	if (month < 1 || month > 12 || day < 1 || day > DAYS_IN_MONTH[month - 1] + ((month == 2 && leapYear) ? 1u : 0u)) {
+		return false;
+	}
+
+	packedDate = date;
+
+	return true;
+
+}
+
+
+
+bool decodeTypedValue(string_view value, EdiDataType type, int64_t& decodedValue) {
+
+	uint32_t packedDate = 0;
+
+	switch (type) {
+
+	case TYPE_R:
+	case TYPE_N0:
+		return decodeFixedPoint(value, 0, decodedValue);
+
+	case TYPE_N2:
+		return decodeFixedPoint(value, 2, decodedValue);
+
+	case TYPE_DT:
+
+		if (!decodePackedDate(value, packedDate)) {
+			return false;
+		}
+
+		decodedValue = packedDate;
+		return true;
+
+	default:
+		return false;
+
+	}
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function multiplyFixedPoint multiplies two fixed-point values without a double or a 128-bit type. Both sides are split into whole units
+//and fractional ten-thousandths, so the only product that has to be scaled back down is fraction x fraction, which is under 10^8. The
+//whole x right product and each sum are checked before they're made, and it returns false (leaving product alone) if the answer won't fit
+//an int64_t. IT102 and IT104 can each run to 15 digits or more, so this does happen.
+//
+//*******************************************************************************************************************************************
+
+bool multiplyFixedPoint(int64_t leftScaled, int64_t rightScaled, int64_t& product) {
+
+	bool negative = (leftScaled < 0) != (rightScaled < 0);
+	uint64_t left = (leftScaled < 0) ? 0 - static_cast<uint64_t>(leftScaled) : static_cast<uint64_t>(leftScaled);
+	uint64_t right = (rightScaled < 0) ? 0 - static_cast<uint64_t>(rightScaled) : static_cast<uint64_t>(rightScaled);
+	uint64_t leftWhole = left / FIXED_POINT_SCALE;
+	uint64_t leftFraction = left % FIXED_POINT_SCALE;
+
+	if (right != 0 && leftWhole > UINT64_MAX / right) {
+		return false;
+	}
+
+	uint64_t wholePart = leftWhole * right;
+	uint64_t fractionPart = leftFraction * (right / FIXED_POINT_SCALE) + (leftFraction * (right % FIXED_POINT_SCALE) + FIXED_POINT_SCALE / 2) / FIXED_POINT_SCALE; //Can't wrap: right is at most 2^63.
+
+	if (wholePart > static_cast<uint64_t>(INT64_MAX) || fractionPart > static_cast<uint64_t>(INT64_MAX) - wholePart) {
+		return false;
+	}
+
+	product = negative ? -static_cast<int64_t>(wholePart + fractionPart) : static_cast<int64_t>(wholePart + fractionPart);
+
+	return true;
+
+}
+
+
+
+bool addFixedPoint(int64_t& total, int64_t amount) {
+
+	if ((amount > 0 && total > INT64_MAX - amount) || (amount < 0 && total < INT64_MIN - amount)) {
+		return false;
+	}
+
+	total += amount;
+
+	return true;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function formatFixedPoint prints a fixed-point value with the number of decimals asked for (0 to 4). It's done by hand rather than with a
+//stream so the output never depends on the locale.
+//
+//*******************************************************************************************************************************************
+
+string formatFixedPoint(int64_t scaledValue, int decimals) {
+
+	int64_t divisor = 1;
+	bool negative = scaledValue < 0;
+	uint64_t magnitude = negative ? 0 - static_cast<uint64_t>(scaledValue) : static_cast<uint64_t>(scaledValue);
+
+	decimals = (decimals < 0) ? 0 : (decimals > FIXED_POINT_DECIMALS) ? FIXED_POINT_DECIMALS : decimals;
+
+	for (int scale = decimals; scale < FIXED_POINT_DECIMALS; scale++) {
+		divisor *= 10;
+	}
+
+	magnitude = (magnitude + divisor / 2) / divisor; //Now in units of 10^-decimals.
+
+	string digits = to_string(magnitude);
+
+	if (digits.length() <= static_cast<size_t>(decimals)) {
+		digits.insert(0, decimals + 1 - digits.length(), '0');
+	}
+
+	if (decimals > 0) {
+		digits.insert(digits.length() - decimals, 1, '.');
+	}
+
+	return (negative && magnitude != 0) ? "-" + digits : digits;
+
+}
@@ -0,0 +1,35 @@
+#ifndef EDIVALUEDECODER_H
+#define EDIVALUEDECODER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+using namespace std;
+
+
+//These functions decode the typed X12 elements (R, N0, N2, DT) straight from the buffer into integers, so money and quantities never go
+//through atof or a double. Every numeric value comes out as a 64-bit count of ten-thousandths (FIXED_POINT_SCALE), which is enough for the
+//four-decimal unit prices Kroger sends and lets totals be added up exactly. Dates come out packed as a CCYYMMDD integer, which sorts the
+//same way the dates do.
+
+enum EdiDataType { TYPE_AN, TYPE_ID, TYPE_DT, TYPE_R, TYPE_N0, TYPE_N2, TYPE_UNKNOWN };
+
+const int FIXED_POINT_DECIMALS = 4;
+const int64_t FIXED_POINT_SCALE = 10000;
+
+
+EdiDataType getEdiDataType(string_view schemaType); //"N2" -> TYPE_N2, and so on.
+
+bool decodeFixedPoint(string_view value, int impliedDecimals, int64_t& scaledValue);
+
+bool decodePackedDate(string_view value, uint32_t& packedDate);
+
+bool decodeTypedValue(string_view value, EdiDataType type, int64_t& decodedValue); //Fixed-point for R/N0/N2, packed date for DT.
+
+bool multiplyFixedPoint(int64_t leftScaled, int64_t rightScaled, int64_t& product); //Quantity x price, still in ten-thousandths. Rounds half away from zero; false if it won't fit.
+
+bool addFixedPoint(int64_t& total, int64_t amount); //total += amount, unless that won't fit; then it returns false and total is left alone.
+
+string formatFixedPoint(int64_t scaledValue, int decimals); //Rounds half away from zero to the number of decimals asked for.
+
+#endif
@@ -0,0 +1,415 @@
+#include "EdiWriter.h"
+#include <charconv>
+#include <cstring>
+#include "ElementCode.h"
+#include "PipelineStats.h"
+using namespace std;
+
+
+const size_t CONTROL_COUNT_DIGITS = 20; //The most a recomputed count (or a renumbered GS06/ST02) can take; a uint64_t never needs more.
+const size_t INTERCHANGE_CONTROL_DIGITS = 9;
+const uint64_t INTERCHANGE_CONTROL_NUMBER_LIMIT = 1000000000; //ISA13 is nine digits, so renumbering wraps back around to 0.
+
+
+EdiWriter::EdiWriter() {
+
+	delimiters = DEFAULT_EDI_DELIMITERS;
+	trailingLineBreak = false;
+	renumberControlNumbers = false;
+	nextInterchangeControlNumber = 1;
+	outputCapacity = 0;
+	outputLength = 0;
+	numSegmentsWritten = 0;
+	numControlFieldsChanged = 0;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function reserveOutput makes sure the buffer holds at least the number of bytes given. new char[] leaves the bytes as they are instead of
+//zeroing them, which a string or vector would do on every resize. Growing drops whatever was written before, so it's only ever called
+//before a write starts.
+//
+//*******************************************************************************************************************************************
+
+void EdiWriter::reserveOutput(size_t bytes) {
+
+	if (bytes <= outputCapacity) {
+		return;
+	}
+
+	outputBuffer.reset(new char[bytes]);
+	outputCapacity = bytes;
+	outputLength = 0;
+
+}
+
+
+
+static bool isControlSegment(uint8_t segmentCode) {
+
+	switch (segmentCode) {
+
+	case findSegmentCode("ISA"):
+	case findSegmentCode("GS"):
+	case findSegmentCode("ST"):
+	case findSegmentCode("SE"):
+	case findSegmentCode("GE"):
+	case findSegmentCode("IEA"):
+		return true;
+
+	default:
+		return false;
+
+	}
+
+}
+
+static string_view formatControlNumber(char* digits, uint64_t value, size_t minWidth) { //digits has to hold at least 24 bytes.
+
+	char* end = to_chars(digits, digits + 24, value).ptr;
+	size_t length = end - digits;
+
+	if (length < minWidth) {
+		memmove(digits + (minWidth - length), digits, length);
+		memset(digits, '0', minWidth - length);
+		length = minWidth;
+	}
+
+	return string_view(digits, length);
+
+}
+
+static size_t getElementLength(const InvoiceDocumentStore& documentStore, size_t segmentIndex, int elementPosition) { //0 if it isn't there.
+
+	return (elementPosition < documentStore.getSegmentNumElements(segmentIndex)) ? documentStore.getElementText(documentStore.getSegmentFirstElement(segmentIndex) + elementPosition).size() : 0;
+
+}
+
+static string_view getLineBreakAfter(const InvoiceDocumentStore& documentStore, size_t segmentIndex) { //The CR/LF run after the terminator.
+
+	string_view buffer = documentStore.getBuffer();
+	string_view segmentText = documentStore.getSegmentText(segmentIndex);
+	size_t start = (segmentText.data() - buffer.data()) + segmentText.size() + 1;
+	size_t end = start;
+
+	while (end < buffer.size() && (buffer[end] == '\r' || buffer[end] == '\n')) {
+		end++;
+	}
+
+	return (start < buffer.size()) ? buffer.substr(start, end - start) : string_view();
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function matchSourceLayout takes the line break from after the first segment and uses it after every segment, and ends the output with
+//one only if the document ended with one. Partners either wrap every segment or none, so the first one speaks for the rest.
+//
+//*******************************************************************************************************************************************
+
+void EdiWriter::matchSourceLayout(const InvoiceDocumentStore& documentStore) {
+
+	size_t numSegments = documentStore.getNumSegments();
+
+	if (numSegments == 0) {
+		setLineBreak("", false);
+		return;
+	}
+
+	string_view lastLineBreak = getLineBreakAfter(documentStore, numSegments - 1);
+
+	setLineBreak((numSegments > 1) ? getLineBreakAfter(documentStore, 0) : lastLineBreak, !lastLineBreak.empty());
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function writeElement copies one element through the translation table (which swaps the source's sub-element and repetition separators for
+//the configured ones) and stops with an exception on any byte that would read as one of the configured delimiters.
+//
+//*******************************************************************************************************************************************
+
+char* EdiWriter::writeElement(char* out, string_view value, const uint8_t* translation, const uint8_t* rejected) const {
+
+	for (char character : value) {
+
+		uint8_t byte = static_cast<uint8_t>(character);
+
+		if (rejected[byte]) {
+			throw string("ERROR. The value \"" + string(value) + "\" holds '" + character + "', which is one of the output delimiters.\n");
+		}
+
+		*out++ = static_cast<char>(translation[byte]);
+
+	}
+
+	return out;
+
+}
+
+char* EdiWriter::writeControlField(char* out, string_view sourceValue, string_view newValue) {
+
+	if (newValue != sourceValue) {
+		numControlFieldsChanged++;
+	}
+
+	memcpy(out, newValue.data(), newValue.size());
+
+	return out + newValue.size();
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function write makes one pass over the segment table to size the buffer, then one pass to fill it. Ordinary segments are a single memcpy
+//when the delimiters aren't changing. Control segments are always rebuilt element by element so their counts and control numbers can be
+//filled in; the control numbers that get copied into the trailers are views of what was already written for ISA13, GS06 and ST02, so
+//nothing is copied out to the side. The sizing pass follows the same headers, so each trailer is given room for its count plus the control
+//number its header will actually have written, however long that is. Each header starts its control number over, so a trailer never picks
+//up one from an earlier ISA, GS or ST that had one when its own header didn't. ISA11 and ISA16 carry the separators themselves and go through the translation table like anything
+//else, except that an ISA11 separator with no configured repetition separator to become turns back into the 00401 "U".
+//
+//*******************************************************************************************************************************************
+
+string_view EdiWriter::write(const InvoiceDocumentStore& documentStore, const EdiDelimiters& sourceDelimiters) {
+
+	StageSpan span(STAGE_WRITE_X12);
+	size_t numSegments = documentStore.getNumSegments();
+	size_t bytesNeeded = 0;
+	bool sameDelimiters = sourceDelimiters.element == delimiters.element && sourceDelimiters.segment == delimiters.segment &&
+		sourceDelimiters.subElement == delimiters.subElement && sourceDelimiters.repetition == delimiters.repetition;
+	uint8_t translation[256];
+	uint8_t rejected[256] = {};
+
+	for (size_t i = 0; i < 256; i++) {
+		translation[i] = static_cast<uint8_t>(i);
+	}
+
+	rejected[static_cast<uint8_t>(delimiters.element)] = 1;
+	rejected[static_cast<uint8_t>(delimiters.segment)] = 1;
+	rejected[static_cast<uint8_t>(delimiters.subElement)] = 1;
+
+	if (delimiters.repetition != '\0') {
+		rejected[static_cast<uint8_t>(delimiters.repetition)] = 1;
+	}
+
+	translation[static_cast<uint8_t>(sourceDelimiters.subElement)] = static_cast<uint8_t>(delimiters.subElement);
+	rejected[static_cast<uint8_t>(sourceDelimiters.subElement)] = 0;
+
+	if (sourceDelimiters.repetition != '\0') {
+		translation[static_cast<uint8_t>(sourceDelimiters.repetition)] = static_cast<uint8_t>(delimiters.repetition);
+		rejected[static_cast<uint8_t>(sourceDelimiters.repetition)] = (delimiters.repetition == '\0');
+	}
+
+	size_t interchangeControlLength = 0; //ISA13, GS06 and ST02 as they'll be written.
+	size_t groupControlLength = 0;
+	size_t setControlLength = 0;
+
+	for (size_t i = 0; i < numSegments; i++) {
+
+		bytesNeeded += documentStore.getSegmentText(i).size() + 1 + lineBreak.size();
+
+		switch (documentStore.getSegmentCode(i)) { //On top of the segment as it was read, room for whatever replaces its fields.
+
+		case findSegmentCode("ISA"):
+			interchangeControlLength = renumberControlNumbers ? INTERCHANGE_CONTROL_DIGITS : getElementLength(documentStore, i, 13);
+			bytesNeeded += interchangeControlLength + 1; //The 1 is an ISA11 that turns back into "U".
+			break;
+
+		case findSegmentCode("GS"):
+			groupControlLength = renumberControlNumbers ? CONTROL_COUNT_DIGITS : getElementLength(documentStore, i, 6);
+			bytesNeeded += groupControlLength;
+			break;
+
+		case findSegmentCode("ST"):
+			setControlLength = renumberControlNumbers ? CONTROL_COUNT_DIGITS : getElementLength(documentStore, i, 2);
+			bytesNeeded += setControlLength;
+			break;
+
+		case findSegmentCode("SE"):
+			bytesNeeded += CONTROL_COUNT_DIGITS + setControlLength;
+			break;
+
+		case findSegmentCode("GE"):
+			bytesNeeded += CONTROL_COUNT_DIGITS + groupControlLength;
+			break;
+
+		case findSegmentCode("IEA"):
+			bytesNeeded += CONTROL_COUNT_DIGITS + interchangeControlLength;
+			break;
+
+		default:
+			break;
+
+		}
+
+	}
+
+	reserveOutput(bytesNeeded);
+
+	char* out = outputBuffer.get();
+	string_view interchangeControlNumber, groupControlNumber, setControlNumber; //As written, so they point into outputBuffer.
+	uint64_t nextGroupControlNumber = 1;
+	uint64_t nextSetControlNumber = 1;
+	size_t numGroups = 0;
+	size_t numSets = 0;
+	size_t numSetSegments = 0;
+	char digits[24];
+
+	numControlFieldsChanged = 0;
+
+	for (size_t i = 0; i < numSegments; i++) {
+
+		string_view segmentText = documentStore.getSegmentText(i);
+		uint8_t segmentCode = documentStore.getSegmentCode(i);
+
+		numSetSegments = (segmentCode == findSegmentCode("ST")) ? 1 : numSetSegments + 1;
+
+		switch (segmentCode) { //Filled back in below if the header has its control number.
+
+		case findSegmentCode("ISA"):
+			interchangeControlNumber = string_view();
+			break;
+
+		case findSegmentCode("GS"):
+			groupControlNumber = string_view();
+			break;
+
+		case findSegmentCode("ST"):
+			setControlNumber = string_view();
+			break;
+
+		default:
+			break;
+
+		}
+
+		if (sameDelimiters && !isControlSegment(segmentCode)) {
+			memcpy(out, segmentText.data(), segmentText.size());
+			out += segmentText.size();
+		}
+
+		else {
+
+			size_t firstElement = documentStore.getSegmentFirstElement(i);
+			int numElements = documentStore.getSegmentNumElements(i);
+
+			for (int j = 0; j < numElements; j++) {
+
+				string_view value = documentStore.getElementText(firstElement + j);
+				char* fieldStart = out;
+
+				if (j > 0) {
+					*out++ = delimiters.element;
+					fieldStart = out;
+				}
+
+				switch (makeElementCode(segmentCode, j)) {
+
+				case findElementCode("ISA11"):
+					out = (sourceDelimiters.repetition != '\0' && delimiters.repetition == '\0') ? writeControlField(out, value, "U") : writeElement(out, value, translation, rejected);
+					break;
+
+				case findElementCode("ISA13"):
+					out = renumberControlNumbers ? writeControlField(out, value, formatControlNumber(digits, nextInterchangeControlNumber++ % INTERCHANGE_CONTROL_NUMBER_LIMIT, INTERCHANGE_CONTROL_DIGITS)) : writeElement(out, value, translation, rejected);
+					interchangeControlNumber = string_view(fieldStart, out - fieldStart);
+					break;
+
+				case findElementCode("GS06"):
+					out = renumberControlNumbers ? writeControlField(out, value, formatControlNumber(digits, nextGroupControlNumber++, 1)) : writeElement(out, value, translation, rejected);
+					groupControlNumber = string_view(fieldStart, out - fieldStart);
+					break;
+
+				case findElementCode("ST02"):
+					out = renumberControlNumbers ? writeControlField(out, value, formatControlNumber(digits, nextSetControlNumber++, 4)) : writeElement(out, value, translation, rejected);
+					setControlNumber = string_view(fieldStart, out - fieldStart);
+					break;
+
+				case findElementCode("SE01"):
+					out = writeControlField(out, value, formatControlNumber(digits, numSetSegments, 1));
+					break;
+
+				case findElementCode("SE02"):
+					out = writeControlField(out, value, setControlNumber);
+					break;
+
+				case findElementCode("GE01"):
+					out = writeControlField(out, value, formatControlNumber(digits, numSets, 1));
+					break;
+
+				case findElementCode("GE02"):
+					out = writeControlField(out, value, groupControlNumber);
+					break;
+
+				case findElementCode("IEA01"):
+					out = writeControlField(out, value, formatControlNumber(digits, numGroups, 1));
+					break;
+
+				case findElementCode("IEA02"):
+					out = writeControlField(out, value, interchangeControlNumber);
+					break;
+
+				default:
+					out = writeElement(out, value, translation, rejected);
+					break;
+
+				}
+
+			}
+
+		}
+
+		*out++ = delimiters.segment;
+
+		if (i + 1 < numSegments || trailingLineBreak) {
+			memcpy(out, lineBreak.data(), lineBreak.size());
+			out += lineBreak.size();
+		}
+
+		switch (segmentCode) {
+
+		case findSegmentCode("ISA"):
+			numGroups = 0;
+			nextGroupControlNumber = 1;
+			break;
+
+		case findSegmentCode("GS"):
+			numGroups++;
+			numSets = 0;
+			nextSetControlNumber = 1;
+			break;
+
+		case findSegmentCode("ST"):
+			numSets++;
+			break;
+
+		default:
+			break;
+
+		}
+
+	}
+
+	outputLength = out - outputBuffer.get();
+	numSegmentsWritten = numSegments;
+
+	span.addWork(outputLength, numSegments, sameDelimiters ? 0 : documentStore.getNumElements());
+
+	return getOutput();
+
+}
+
+void EdiWriter::write(const InvoiceDocumentStore& documentStore, const EdiDelimiters& sourceDelimiters, OutputSink& sink) {
+
+	sink.write(write(documentStore, sourceDelimiters));
+
+}
@@ -0,0 +1,117 @@
+#ifndef EDIWRITER_H
+#define EDIWRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include "EdiDelimiters.h"
+#include "InvoiceDocumentStore.h"
+#include "OutputSink.h"
+using namespace std;
+
+
+//The EdiWriter class turns a parsed document (the segment and element tables in an InvoiceDocumentStore) back into X12 text, so the program
+//can send out 810s instead of only reading them. It writes with whichever delimiters it's configured with, and the control segments are
+//worked out as they're written instead of copied:
+//	SE01 = segments from ST to SE, counting both		SE02 = ST02
+//	GE01 = transaction sets in the group				GE02 = GS06
+//	IEA01 = functional groups in the interchange		IEA02 = ISA13
+//With renumbering on, ISA13, GS06 and ST02 are handed out in sequence too (ISA13 as nine digits, ST02 as at least four), and the trailers
+//follow them.
+//
+//Output goes into one buffer the writer keeps. Its size is worked out from the segment table before anything is written, so the buffer
+//grows at most once per document and no element ever allocates. Segments are copied whole when the delimiters aren't changing, and element
+//by element (with any sub-element and repetition separators swapped over) when they are. A document that was read with the same
+//delimiters, whose counts were already right, comes back out byte for byte, line breaks included (see matchSourceLayout). The one thing
+//not kept is any byte-order mark or blank space in front of the first segment.
+
+class EdiWriter {
+
+	private:
+
+		EdiDelimiters delimiters;
+		string lineBreak; //Written after each segment terminator; empty for one long line.
+		bool trailingLineBreak; //Whether the last segment gets one too.
+		bool renumberControlNumbers;
+		uint64_t nextInterchangeControlNumber;
+		unique_ptr <char[]> outputBuffer;
+		size_t outputCapacity;
+		size_t outputLength;
+		size_t numSegmentsWritten;
+		size_t numControlFieldsChanged; //Trailer counts and control numbers that came out different from what was read.
+
+		void reserveOutput(size_t bytes);
+		char* writeElement(char* out, string_view value, const uint8_t* translation, const uint8_t* rejected) const;
+		char* writeControlField(char* out, string_view sourceValue, string_view newValue);
+
+	public:
+
+		//Constructors and destructor
+
+		EdiWriter(); //See EdiWriter.cpp for definitions. Kroger's * ~ > with no line breaks.
+
+		~EdiWriter() {}
+
+
+		//Writes the whole document into the output buffer, replacing what was there. sourceDelimiters are the ones the store was read with.
+		//Throws a string if an element holds one of the configured delimiters and can't be written without changing what it means.
+		string_view write(const InvoiceDocumentStore& documentStore, const EdiDelimiters& sourceDelimiters);
+
+		void write(const InvoiceDocumentStore& documentStore, const EdiDelimiters& sourceDelimiters, OutputSink& sink); //Same, then sent to the sink.
+
+		void matchSourceLayout(const InvoiceDocumentStore& documentStore); //Copies the line breaks the document was read with.
+
+		void reserve(size_t bytes) //Sizes the buffer ahead of time, for callers that know how big their documents run.
+		{
+			reserveOutput(bytes);
+		}
+
+
+
+		//Mutators
+
+		void setDelimiters(const EdiDelimiters& outputDelimiters)
+		{
+			delimiters = outputDelimiters;
+		}
+
+		void setLineBreak(string_view segmentLineBreak, bool afterLastSegment)
+		{
+			lineBreak = segmentLineBreak;
+			trailingLineBreak = afterLastSegment;
+		}
+
+		void setRenumberControlNumbers(bool renumber, uint64_t firstInterchangeControlNumber = 1)
+		{
+			renumberControlNumbers = renumber;
+			nextInterchangeControlNumber = firstInterchangeControlNumber;
+		}
+
+
+		//Accessors
+
+		const EdiDelimiters& getDelimiters() const
+		{
+			return delimiters;
+		}
+
+		string_view getOutput() const
+		{
+			return string_view(outputBuffer.get(), outputLength);
+		}
+
+		size_t getNumSegmentsWritten() const
+		{
+			return numSegmentsWritten;
+		}
+
+		size_t getNumControlFieldsChanged() const
+		{
+			return numControlFieldsChanged;
+		}
+
+};
+
+#endif
@@ -0,0 +1,164 @@
+#ifndef ELEMENTCODE_H
+#define ELEMENTCODE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "Schema.h"
+using namespace std;
+
+
+//Interned segment and element identifiers. Every segment ID an 810 can hold (the ones in Schema.h plus the ISA/GS envelope around them)
+//gets a small fixed segment code, and an element is its segment code shifted up seven bits plus its position, so "BIG02" is one 16-bit
+//number that's the same in every document and every run. Comparing two elements is then an integer compare instead of building "BIG" + "02"
+//and comparing strings. The text form is only put together when something is going to print it.
+//
+//Like Schema.h, all of this is constexpr: the segment lookup is a perfect hash the compiler builds, and a code for a fixed ID like
+//findElementCode("TDS01") can be worked out at compile time. Segment IDs that aren't in the table (a partner's custom segment, say) get
+//ELEMENT_CODE_UNKNOWN, and whoever holds one keeps the segment ID text alongside it.
+
+typedef uint16_t ElementCode;
+
+constexpr string_view internedSegmentIDs[] = {
+
+	"ISA", "GS", "ST", "BIG", "CUR", "N1", "ITD", "IT1", "IT3", "SAC", "TDS", "SE", "GE", "IEA"
+
+};
+
+constexpr size_t NUM_SEGMENT_CODES = sizeof(internedSegmentIDs) / sizeof(internedSegmentIDs[0]);
+constexpr uint8_t SEGMENT_CODE_UNKNOWN = 0xFF;
+constexpr ElementCode ELEMENT_CODE_UNKNOWN = 0xFFFF;
+constexpr int ELEMENT_CODE_POSITION_BITS = 7; //Positions run 00-99.
+constexpr size_t NUM_ELEMENT_CODES = NUM_SEGMENT_CODES << ELEMENT_CODE_POSITION_BITS; //Every code is below this, so codes can index an array.
+
+
+constexpr auto packInternedSegmentKeys() {
+
+	struct KeyArray { uint64_t keys[NUM_SEGMENT_CODES]; } keyArray{};
+
+	for (size_t i = 0; i < NUM_SEGMENT_CODES; i++) {
+		keyArray.keys[i] = packSchemaKey(internedSegmentIDs[i]);
+	}
+
+	return keyArray;
+
+}
+
+constexpr auto internedSegmentKeys = packInternedSegmentKeys();
+constexpr SchemaHashTable<5> internedSegmentHash = buildSchemaHashTable<5>(internedSegmentKeys.keys);
+
+
+
+constexpr uint8_t findSegmentCode(string_view segmentID) {
+
+	int entry = internedSegmentHash.find(packSchemaKey(segmentID));
+	return (entry < 0) ? SEGMENT_CODE_UNKNOWN : static_cast<uint8_t>(entry);
+
+}
+
+constexpr ElementCode makeElementCode(uint8_t segmentCode, int elementPosition) {
+
+	if (segmentCode >= NUM_SEGMENT_CODES || elementPosition < 0 || elementPosition > 99) {
+		return ELEMENT_CODE_UNKNOWN;
+	}
+
+	return static_cast<ElementCode>((segmentCode << ELEMENT_CODE_POSITION_BITS) | elementPosition);
+
+}
+
+constexpr ElementCode makeElementCode(string_view segmentID, int elementPosition) {
+
+	return makeElementCode(findSegmentCode(segmentID), elementPosition);
+
+}
+
+constexpr ElementCode findElementCode(string_view elementID) { //"BIG02" -> the code for BIG position 2.
+
+	if (elementID.length() < 3) {
+		return ELEMENT_CODE_UNKNOWN;
+	}
+
+	char tens = elementID[elementID.length() - 2];
+	char ones = elementID[elementID.length() - 1];
+
+	if (tens < '0' || tens > '9' || ones < '0' || ones > '9') {
+		return ELEMENT_CODE_UNKNOWN;
+	}
+
+	return makeElementCode(elementID.substr(0, elementID.length() - 2), (tens - '0') * 10 + (ones - '0'));
+
+}
+
+constexpr string_view getElementCodeSegmentID(ElementCode code) {
+
+	size_t segmentCode = code >> ELEMENT_CODE_POSITION_BITS;
+	return (segmentCode < NUM_SEGMENT_CODES) ? internedSegmentIDs[segmentCode] : string_view();
+
+}
+
+constexpr int getElementCodePosition(ElementCode code) {
+
+	return code & ((1 << ELEMENT_CODE_POSITION_BITS) - 1);
+
+}
+
+
+//Builds "BIG02" from "BIG" and 2 in one allocation, padding single-digit positions with a 0. Only for output; identity should use codes.
+inline string formatElementID(string_view segmentID, int elementPosition) {
+
+	string elementID;
+
+	elementID.reserve(segmentID.length() + 3);
+	elementID.append(segmentID);
+
+	if (elementPosition >= 0 && elementPosition < 10) {
+		elementID.push_back('0');
+	}
+
+	elementID.append(to_string(elementPosition));
+
+	return elementID;
+
+}
+
+
+//Checked by the compiler, so the table above can't drift away from Schema.h.
+
+constexpr bool allSchemaIDsInterned() {
+
+	for (size_t i = 0; i < NUM_SEGMENT_SCHEMAS; i++) {
+
+		if (findSegmentCode(segmentSchemaTable[i].id) == SEGMENT_CODE_UNKNOWN) {
+			return false;
+		}
+
+	}
+
+	for (size_t i = 0; i < NUM_ELEMENT_SCHEMAS; i++) {
+
+		ElementCode code = findElementCode(elementSchemaTable[i].ref);
+
+		if (code == ELEMENT_CODE_UNKNOWN || getElementCodeSegmentID(code) != elementSchemaTable[i].segmentId) {
+			return false;
+		}
+
+	}
+
+	for (size_t i = 0; i < NUM_SEGMENT_CODES; i++) {
+
+		if (findSegmentCode(internedSegmentIDs[i]) != i) {
+			return false;
+		}
+
+	}
+
+	return true;
+
+}
+
+static_assert(allSchemaIDsInterned(), "Every segment and element in Schema.h must have an interned code.");
+static_assert(findElementCode("BIG02") == makeElementCode("BIG", 2) && getElementCodePosition(findElementCode("TDS01")) == 1, "Element codes must round-trip.");
+static_assert(findElementCode("ZZZ01") == ELEMENT_CODE_UNKNOWN && findElementCode("BIG") == ELEMENT_CODE_UNKNOWN, "Unknown IDs must not get a code.");
+
+#endif
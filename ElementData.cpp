@@ -1,10 +1,12 @@
 #include "ElementData.h"
+#include <cctype>
 using namespace std;
 
 
 ElementData::ElementData() {
 
-	elementNum = "";
+	elementCode = ELEMENT_CODE_UNKNOWN;
+	elementPosition = 0;
 	strValue = "";
 	elementLength = 0;
 
@@ -12,9 +14,37 @@ ElementData::ElementData() {
 
 ElementData::ElementData(string elemNum, string strVal, int elemLen){
 
-	elementNum = elemNum;
+	setElementNum(elemNum);
 	strValue = strVal;
 	elementLength = elemLen;
 
 }
 
+
+
+//*******************************************************************************************************************************************
+//
+//Function setElementNum takes an element ID in text form, the last two digits being the position and everything ahead of them the segment
+//ID. The segment ID goes into the inherited segmentID so an ID with no interned code still prints back the same.
+//
+//*******************************************************************************************************************************************
+
+void ElementData::setElementNum(string elemNum) {
+
+	elementCode = findElementCode(elemNum);
+	elementPosition = 0;
+
+	if (elemNum.length() >= 2 && isdigit(static_cast<unsigned char>(elemNum[elemNum.length() - 2])) && isdigit(static_cast<unsigned char>(elemNum[elemNum.length() - 1]))) {
+
+		elementPosition = (elemNum[elemNum.length() - 2] - '0') * 10 + (elemNum[elemNum.length() - 1] - '0');
+		segmentID = elemNum.substr(0, elemNum.length() - 2);
+
+	}
+
+	else {
+
+		segmentID = elemNum;
+
+	}
+
+}
@@ -3,13 +3,19 @@
 
 #include <string>
 #include "InvDocument.h"
+#include "ElementCode.h"
 using namespace std;
 
+//The element ID ("BIG02") isn't kept as a string. It's the interned ElementCode plus the position (see ElementCode.h), and the text is only
+//built if getElementNum is called. Segments that aren't in the code table keep their ID in the inherited segmentID, which is where the text
+//comes from for them.
+
 class ElementData : public InvDocument {
 
 private:
 
-	string elementNum;
+	ElementCode elementCode;
+	int elementPosition;
 	string strValue;
 	int elementLength;
 
@@ -25,9 +31,12 @@ public:
 
 	//Mutators
 
-	void setElementNum(string elemNum)
+	void setElementNum(string elemNum); //Splits "BIG02" back into the segment ID and position. See ElementData.cpp.
+
+	void setElementID(ElementCode code, int position) //What the parse uses; no text involved.
 	{
-		elementNum = elemNum;
+		elementCode = code;
+		elementPosition = position;
 	}
 
 
@@ -46,7 +55,17 @@ public:
 
 	string getElementNum() const
 	{
-		return elementNum;
+		return (elementCode == ELEMENT_CODE_UNKNOWN) ? formatElementID(segmentID, elementPosition) : formatElementID(getElementCodeSegmentID(elementCode), elementPosition);
+	}
+
+	ElementCode getElementCode() const
+	{
+		return elementCode;
+	}
+
+	int getElementPosition() const
+	{
+		return elementPosition;
 	}
 	
 
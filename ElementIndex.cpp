@@ -0,0 +1,123 @@
+#include "ElementIndex.h"
+#include "PipelineStats.h"
+using namespace std;
+
+
+//*******************************************************************************************************************************************
+//
+//Function build works out the ElementCode of every element (from the tokenizer right after parsing, or from a document store that was
+//loaded from a cache), then buildFromElementCodes makes two passes over the codes. The first counts how many times each code occurs. Then
+//each code is given its own run inside the occurrences array, and the second pass drops every element number into its run in document
+//order.
+//
+//*******************************************************************************************************************************************
+
+void ElementIndex::build(const EdiTokenizer& invoiceTokenizer) {
+
+	StageSpan span(STAGE_BUILD_ELEMENT_INDEX);
+	vector <ElementCode> elementCodes(invoiceTokenizer.getNumElements(), ELEMENT_CODE_UNKNOWN);
+
+	for (size_t i = 0; i < invoiceTokenizer.getNumSegments(); i++) {
+
+		const SegmentSpan& segment = invoiceTokenizer.getSegment(i);
+		uint8_t segmentCode = findSegmentCode(invoiceTokenizer.getSegmentID(i)); //Once per segment; each element is this plus its position.
+
+		for (int j = 0; j < segment.numElements; j++) {
+			elementCodes[segment.firstElement + j] = makeElementCode(segmentCode, j);
+		}
+
+	}
+
+	buildFromElementCodes(elementCodes);
+	span.addWork(0, invoiceTokenizer.getNumSegments(), elementCodes.size());
+
+}
+
+void ElementIndex::build(const InvoiceDocumentStore& documentStore) {
+
+	StageSpan span(STAGE_BUILD_ELEMENT_INDEX);
+	vector <ElementCode> elementCodes(documentStore.getNumElements(), ELEMENT_CODE_UNKNOWN);
+
+	for (size_t i = 0; i < documentStore.getNumElements(); i++) {
+		elementCodes[i] = documentStore.getElementCode(i);
+	}
+
+	buildFromElementCodes(elementCodes);
+	span.addWork(0, documentStore.getNumSegments(), elementCodes.size());
+
+}
+
+void ElementIndex::buildFromElementCodes(const vector <ElementCode>& elementCodes) {
+
+	runs.assign(NUM_ELEMENT_CODES, Run{ 0, 0 });
+	occurrences.clear();
+
+	for (ElementCode code : elementCodes) {
+
+		if (code != ELEMENT_CODE_UNKNOWN) {
+			runs[code].numOccurrences++;
+		}
+
+	}
+
+	//Carve out a run for each code, then reset the counts so they can be used as fill cursors.
+
+	uint32_t runStart = 0;
+
+	for (Run& run : runs) {
+		run.firstOccurrence = runStart;
+		runStart += run.numOccurrences;
+		run.numOccurrences = 0;
+	}
+
+	occurrences.resize(runStart);
+
+	for (size_t i = 0; i < elementCodes.size(); i++) {
+
+		if (elementCodes[i] == ELEMENT_CODE_UNKNOWN) {
+			continue;
+		}
+
+		Run& run = runs[elementCodes[i]];
+		occurrences[run.firstOccurrence + run.numOccurrences] = i;
+		run.numOccurrences++;
+
+	}
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function find looks up every occurrence of an element. The code is the array index, so there's nothing to hash or compare.
+//
+//*******************************************************************************************************************************************
+
+ElementOccurrences ElementIndex::find(ElementCode elementCode) const {
+
+	countElementLookup();
+
+	if (elementCode >= runs.size()) { //ELEMENT_CODE_UNKNOWN, or an index that was never built.
+		return ElementOccurrences{ nullptr, 0 };
+	}
+
+	const Run& run = runs[elementCode];
+
+	return ElementOccurrences{ occurrences.data() + run.firstOccurrence, run.numOccurrences };
+
+}
+
+
+
+size_t ElementIndex::getNumKeys() const {
+
+	size_t numKeys = 0;
+
+	for (const Run& run : runs) {
+		numKeys += (run.numOccurrences != 0);
+	}
+
+	return numKeys;
+
+}
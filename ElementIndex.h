@@ -0,0 +1,94 @@
+#ifndef ELEMENTINDEX_H
+#define ELEMENTINDEX_H
+
+#include <cstdint>
+#include <vector>
+#include "ElementCode.h"
+#include "EdiTokenizer.h"
+#include "InvoiceDocumentStore.h"
+using namespace std;
+
+
+//The ElementIndex class is built once right after tokenizing and maps an element, by its ElementCode (see ElementCode.h), to every place it
+//occurs in the document. Codes are small and dense, so the index is a plain array with one run per possible code: building it is a counting
+//sort and a lookup is one array read, with no hashing and no text involved. Elements of segments outside the interned table have no code
+//and aren't indexed. Occurrences are element numbers, which line up one-to-one with elementDataVect.
+
+struct ElementOccurrences {
+
+	const size_t* positions; //Element numbers in document order.
+	size_t count;
+
+	bool found() const
+	{
+		return count > 0;
+	}
+
+	size_t first() const
+	{
+		return positions[0];
+	}
+
+	size_t last() const
+	{
+		return positions[count - 1];
+	}
+
+	const size_t* begin() const
+	{
+		return positions;
+	}
+
+	const size_t* end() const
+	{
+		return positions + count;
+	}
+
+};
+
+
+class ElementIndex {
+
+	private:
+
+		struct Run {
+
+			uint32_t firstOccurrence;
+			uint32_t numOccurrences;
+
+		};
+
+		vector <Run> runs; //Indexed by ElementCode; NUM_ELEMENT_CODES of them once built.
+		vector <size_t> occurrences; //All occurrences grouped by code, so each run is just a stretch of them.
+
+		void buildFromElementCodes(const vector <ElementCode>& elementCodes);
+
+	public:
+
+		//Constructors and destructor
+
+		ElementIndex() {}
+
+		~ElementIndex() {}
+
+
+		void build(const EdiTokenizer& invoiceTokenizer);
+
+		void build(const InvoiceDocumentStore& documentStore); //Same index, for a store that didn't come from a tokenizer (see InvoiceCacheFile).
+
+		ElementOccurrences find(ElementCode elementCode) const; //found() is false if the element never shows up (or the code is ELEMENT_CODE_UNKNOWN).
+
+
+
+		//Accessors
+
+		size_t getNumKeys() const;
+
+		size_t getNumOccurrences() const
+		{
+			return occurrences.size();
+		}
+
+};
+
+#endif
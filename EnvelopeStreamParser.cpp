@@ -0,0 +1,506 @@
+#include "EnvelopeStreamParser.h"
+#include "PipelineStats.h"
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+using namespace std;
+
+
+const size_t MAX_ENVELOPE_ERRORS = 1000; //Keeps a garbage file from growing the error list without bound.
+
+
+EnvelopeStreamParser::EnvelopeStreamParser() : EnvelopeStreamParser(1 << 20, '*', '~') {}
+
+EnvelopeStreamParser::EnvelopeStreamParser(size_t chunkBytes, char elemDelimiter, char lineDelim) {
+
+	chunkSize = (chunkBytes < 64) ? 64 : chunkBytes;
+	bufferStart = 0;
+	bufferEnd = 0;
+	bufferFileOffset = 0;
+	endOfInput = false;
+
+	configuredDelimiters = DEFAULT_EDI_DELIMITERS;
+	configuredDelimiters.element = elemDelimiter;
+	configuredDelimiters.segment = lineDelim;
+	delimiters = configuredDelimiters;
+
+	insideTransactionSet = false;
+	transactionSetsInGroup = 0;
+	groupsInInterchange = 0;
+	transactionSetsReturned = 0;
+	bytesConsumed = 0;
+
+}
+
+
+
+//Pulls element number elementPosition (00 = the segment ID) out of a raw segment without allocating anything.
+
+static string_view getSegmentElement(const char* segmentStart, size_t segmentLength, char separator, int elementPosition) {
+
+	string_view segment(segmentStart, segmentLength);
+	size_t elementStart = 0;
+
+	for (int i = 0; i < elementPosition; i++) {
+
+		size_t nextDelimiter = segment.find(separator, elementStart);
+
+		if (nextDelimiter == string_view::npos) {
+			return string_view();
+		}
+
+		elementStart = nextDelimiter + 1;
+
+	}
+
+	size_t elementEnd = segment.find(separator, elementStart);
+
+	return segment.substr(elementStart, (elementEnd == string_view::npos) ? string_view::npos : elementEnd - elementStart);
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function open gets the file ready to stream. The chunk buffer is allocated once here and only ever grows if a single segment turns out to
+//be bigger than a whole chunk.
+//
+//*******************************************************************************************************************************************
+
+void EnvelopeStreamParser::open(const string& path) {
+
+	inputStream.close();
+	inputStream.clear();
+	inputStream.open(path, ios::in | ios::binary);
+
+	if (!inputStream) {
+		throw string("ERROR. File cannot open. Please check the directory.\n");
+	}
+
+	chunkBuffer.assign(chunkSize, '\0');
+	bufferStart = 0;
+	bufferEnd = 0;
+	bufferFileOffset = 0;
+	endOfInput = false;
+
+	interchangeControlNumber = "";
+	functionalIDCode = "";
+	groupControlNumber = "";
+	insideTransactionSet = false;
+	transactionSetsInGroup = 0;
+	groupsInInterchange = 0;
+	transactionSetsReturned = 0;
+	bytesConsumed = 0;
+	envelopeErrors.clear();
+	delimiters = configuredDelimiters;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function refillBuffer slides whatever's left of a partial segment to the front of the buffer and reads the next chunk in behind it.
+//Returns false once there's nothing left to read.
+//
+//*******************************************************************************************************************************************
+
+bool EnvelopeStreamParser::refillBuffer() {
+
+	size_t leftover = bufferEnd - bufferStart;
+
+	if (bufferStart > 0) {
+		memmove(chunkBuffer.data(), chunkBuffer.data() + bufferStart, leftover);
+		bufferFileOffset += bufferStart;
+		bufferStart = 0;
+		bufferEnd = leftover;
+	}
+
+	if (bufferEnd == chunkBuffer.size()) { //One segment is bigger than the whole buffer, so the buffer has to grow to finish it.
+		chunkBuffer.resize(chunkBuffer.size() * 2);
+	}
+
+	inputStream.read(chunkBuffer.data() + bufferEnd, static_cast<streamsize>(chunkBuffer.size() - bufferEnd));
+	size_t bytesRead = static_cast<size_t>(inputStream.gcount());
+
+	bufferEnd += bytesRead;
+
+	if (bytesRead == 0) {
+		endOfInput = true;
+	}
+
+	return bytesRead > 0;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function readNextSegment finds the next complete segment. The pointer it hands back is into the chunk buffer and is only good until the
+//next call, so callers copy what they need right away. CR/LF wrapping between segments is skipped.
+//
+//*******************************************************************************************************************************************
+
+bool EnvelopeStreamParser::readNextSegment(const char*& segmentStart, size_t& segmentLength, size_t& segmentOffset) {
+
+	while (true) {
+
+		while (bufferStart < bufferEnd && (chunkBuffer[bufferStart] == '\r' || chunkBuffer[bufferStart] == '\n') && chunkBuffer[bufferStart] != delimiters.segment) {
+			bufferStart++;
+		}
+
+		//Every interchange declares its own separators, so each ISA gets read before searching for its terminator. It needs all 106 bytes.
+
+		if (bufferEnd - bufferStart >= 3 && memcmp(chunkBuffer.data() + bufferStart, "ISA", 3) == 0) {
+
+			if (bufferEnd - bufferStart < ISA_SEGMENT_LENGTH && !endOfInput && refillBuffer()) {
+				continue;
+			}
+
+			if (!detectDelimitersFromISA(string_view(chunkBuffer.data() + bufferStart, bufferEnd - bufferStart), delimiters) && envelopeErrors.size() < MAX_ENVELOPE_ERRORS) {
+				envelopeErrors.push_back("The ISA at offset " + to_string(bufferFileOffset + bufferStart) + " isn't laid out to X12's fixed widths, so its separators can't be read from it.");
+			}
+
+		}
+
+		const char* searchStart = chunkBuffer.data() + bufferStart;
+		const char* terminator = static_cast<const char*>(memchr(searchStart, delimiters.segment, bufferEnd - bufferStart));
+
+		if (terminator != nullptr) {
+
+			segmentStart = searchStart;
+			segmentLength = static_cast<size_t>(terminator - searchStart);
+			segmentOffset = bufferFileOffset + bufferStart;
+
+			bufferStart += segmentLength + 1;
+			bytesConsumed = bufferFileOffset + bufferStart;
+
+			return true;
+
+		}
+
+		if (endOfInput || !refillBuffer()) {
+
+			if (bufferStart < bufferEnd && envelopeErrors.size() < MAX_ENVELOPE_ERRORS) {
+				envelopeErrors.push_back("File ends with an unterminated segment at offset " + to_string(bufferFileOffset + bufferStart) + ".");
+			}
+
+			bufferStart = bufferEnd;
+			bytesConsumed = bufferFileOffset + bufferEnd;
+
+			return false;
+
+		}
+
+	}
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function handleEnvelopeSegment keeps track of the ISA/GS envelope around the transaction sets and checks the GE/IEA trailer counts and
+//control numbers against what was actually seen.
+//
+//*******************************************************************************************************************************************
+
+void EnvelopeStreamParser::handleEnvelopeSegment(const char* segmentStart, size_t segmentLength, size_t segmentOffset) {
+
+	string_view segmentID = getSegmentElement(segmentStart, segmentLength, delimiters.element, 0);
+	string errorMessage;
+
+	if (segmentID == "ISA") {
+
+		interchangeControlNumber = string(getSegmentElement(segmentStart, segmentLength, delimiters.element, 13));
+		groupsInInterchange = 0;
+
+	}
+
+	else if (segmentID == "GS") {
+
+		functionalIDCode = string(getSegmentElement(segmentStart, segmentLength, delimiters.element, 1));
+		groupControlNumber = string(getSegmentElement(segmentStart, segmentLength, delimiters.element, 6));
+		transactionSetsInGroup = 0;
+		groupsInInterchange++;
+
+	}
+
+	else if (segmentID == "GE") {
+
+		if (getSegmentElement(segmentStart, segmentLength, delimiters.element, 1) != to_string(transactionSetsInGroup)) {
+			errorMessage = "GE01 does not match the " + to_string(transactionSetsInGroup) + " transaction set(s) in group " + groupControlNumber + ".";
+		}
+
+		else if (getSegmentElement(segmentStart, segmentLength, delimiters.element, 2) != groupControlNumber) {
+			errorMessage = "GE02 does not match GS06 (" + groupControlNumber + ").";
+		}
+
+	}
+
+	else if (segmentID == "IEA") {
+
+		if (getSegmentElement(segmentStart, segmentLength, delimiters.element, 1) != to_string(groupsInInterchange)) {
+			errorMessage = "IEA01 does not match the " + to_string(groupsInInterchange) + " functional group(s) in interchange " + interchangeControlNumber + ".";
+		}
+
+		else if (getSegmentElement(segmentStart, segmentLength, delimiters.element, 2) != interchangeControlNumber) {
+			errorMessage = "IEA02 does not match ISA13 (" + interchangeControlNumber + ").";
+		}
+
+	}
+
+	else {
+
+		errorMessage = "Segment " + string(segmentID) + " is outside of any transaction set.";
+
+	}
+
+	if (!errorMessage.empty() && envelopeErrors.size() < MAX_ENVELOPE_ERRORS) {
+		envelopeErrors.push_back(errorMessage + " (offset " + to_string(segmentOffset) + ")");
+	}
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function nextTransactionSet reads segments until it has a whole ST...SE transaction set and hands it back. transactionSet.contents is
+//cleared but not shrunk between calls, so after the first few invoices it stops allocating altogether. Returns false at end of file.
+//
+//*******************************************************************************************************************************************
+
+bool EnvelopeStreamParser::nextTransactionSet(TransactionSet& transactionSet) {
+
+	StageSpan span(STAGE_READ_INPUT);
+	const char* segmentStart = nullptr;
+	size_t segmentLength = 0;
+	size_t segmentOffset = 0;
+
+	while (readNextSegment(segmentStart, segmentLength, segmentOffset)) {
+
+		string_view segmentID = getSegmentElement(segmentStart, segmentLength, delimiters.element, 0);
+
+		if (segmentID == "ST") {
+
+			if (insideTransactionSet && envelopeErrors.size() < MAX_ENVELOPE_ERRORS) {
+				envelopeErrors.push_back("ST at offset " + to_string(segmentOffset) + " starts before the previous transaction set's SE.");
+			}
+
+			transactionSet.contents.clear();
+			transactionSet.startOffset = segmentOffset;
+			insideTransactionSet = true;
+
+		}
+
+		if (!insideTransactionSet) {
+			handleEnvelopeSegment(segmentStart, segmentLength, segmentOffset);
+			continue;
+		}
+
+		transactionSet.contents.append(segmentStart, segmentLength);
+		transactionSet.contents.push_back(delimiters.segment);
+
+		if (segmentID == "SE") {
+
+			insideTransactionSet = false;
+			transactionSetsInGroup++;
+			transactionSetsReturned++;
+
+			transactionSet.interchangeControlNumber = interchangeControlNumber;
+			transactionSet.functionalIDCode = functionalIDCode;
+			transactionSet.groupControlNumber = groupControlNumber;
+			transactionSet.sequence = transactionSetsReturned;
+			transactionSet.delimiters = delimiters;
+			span.addWork(transactionSet.contents.size(), 0, 0);
+
+			return true;
+
+		}
+
+	}
+
+	if (insideTransactionSet && envelopeErrors.size() < MAX_ENVELOPE_ERRORS) {
+		envelopeErrors.push_back("File ends inside a transaction set that started at offset " + to_string(transactionSet.startOffset) + ".");
+	}
+
+	insideTransactionSet = false;
+
+	return false;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function splitTransactionSets walks the buffer a segment at a time, the same way readNextSegment does (separators re-read at every ISA,
+//CR/LF between segments skipped), and cuts it at every ST and after every SE. An ST that turns up before the last one's SE closes off the
+//unfinished one, and the envelope segments close off any stray segments gathered ahead of them. An unterminated tail is only kept if it's
+//inside a transaction set; otherwise it's dropped, the same as the tokenizer would.
+//
+//*******************************************************************************************************************************************
+
+void splitTransactionSets(string_view contents, const EdiDelimiters& fallbackDelimiters, vector <TransactionSetSpan>& transactionSets) {
+
+	EdiDelimiters delimiters = fallbackDelimiters;
+	string_view interchangeControlNumber;
+	string_view groupControlNumber;
+	size_t position = skipLeadingFiller(contents);
+	size_t spanStart = string_view::npos; //Where the transaction set (or the stray segments) being gathered started, if there is one.
+
+	transactionSets.clear();
+	detectDelimiters(contents, delimiters);
+
+	auto closeSpan = [&](size_t spanEnd) {
+
+		if (spanStart != string_view::npos) {
+			transactionSets.push_back(TransactionSetSpan{ contents.substr(spanStart, spanEnd - spanStart), interchangeControlNumber, groupControlNumber, transactionSets.size() + 1, spanStart, delimiters });
+			spanStart = string_view::npos;
+		}
+
+	};
+
+	while (position < contents.size()) {
+
+		char character = contents[position];
+
+		if ((character == '\r' || character == '\n' || character == ' ' || character == '\t') && character != delimiters.segment) {
+			position++;
+			continue;
+		}
+
+		if (contents.compare(position, 3, "ISA") == 0) {
+			closeSpan(position); //Before the separators change; whatever came ahead of this ISA was written with the old ones.
+			detectDelimitersFromISA(contents.substr(position), delimiters);
+		}
+
+		const char* segmentStart = contents.data() + position;
+		const char* terminator = static_cast<const char*>(memchr(segmentStart, delimiters.segment, contents.size() - position));
+
+		if (terminator == nullptr) {
+			break;
+		}
+
+		size_t segmentLength = static_cast<size_t>(terminator - segmentStart);
+		string_view segmentID = getSegmentElement(segmentStart, segmentLength, delimiters.element, 0);
+
+		if (segmentID == "ST") {
+			closeSpan(position);
+			spanStart = position;
+		}
+
+		else if (segmentID == "ISA" || segmentID == "GS" || segmentID == "GE" || segmentID == "IEA") {
+
+			closeSpan(position);
+
+			if (segmentID == "ISA") {
+				interchangeControlNumber = getSegmentElement(segmentStart, segmentLength, delimiters.element, 13);
+				groupControlNumber = string_view();
+			}
+
+			else if (segmentID == "GS") {
+				groupControlNumber = getSegmentElement(segmentStart, segmentLength, delimiters.element, 6);
+			}
+
+		}
+
+		else if (spanStart == string_view::npos) { //A segment outside of any transaction set starts a span that will fail validation.
+			spanStart = position;
+		}
+
+		position += segmentLength + 1;
+
+		if (segmentID == "SE") {
+			closeSpan(position);
+		}
+
+	}
+
+	closeSpan(contents.size());
+
+	if (transactionSets.empty()) {
+		transactionSets.push_back(TransactionSetSpan{ contents, string_view(), string_view(), 1, 0, delimiters });
+	}
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function splitTransactionSets (by segment) makes the same cuts as the buffer version: at every ST and after every SE, with envelope
+//segments closing off anything gathered ahead of them and stray segments kept as a range of their own. Only segment IDs are looked at, and
+//ISA13 and GS06 come straight out of the element table.
+//
+//*******************************************************************************************************************************************
+
+void splitTransactionSets(const EdiTokenizer& invoiceTokenizer, vector <TransactionSetRange>& transactionSets) {
+
+	string_view interchangeControlNumber;
+	string_view groupControlNumber;
+	size_t rangeStart = SIZE_MAX; //First segment of the transaction set (or the stray segments) being gathered, if there is one.
+
+	transactionSets.clear();
+
+	auto closeRange = [&](size_t rangeEnd) {
+
+		if (rangeStart != SIZE_MAX) {
+			transactionSets.push_back(TransactionSetRange{ rangeStart, rangeEnd - rangeStart, interchangeControlNumber, groupControlNumber, transactionSets.size() + 1 });
+			rangeStart = SIZE_MAX;
+		}
+
+	};
+
+	auto getControlNumber = [&](size_t segmentIndex, int elementPosition) {
+
+		const SegmentSpan& segment = invoiceTokenizer.getSegment(segmentIndex);
+
+		return (elementPosition < segment.numElements) ? invoiceTokenizer.getElementText(segment.firstElement + elementPosition) : string_view();
+
+	};
+
+	for (size_t i = 0; i < invoiceTokenizer.getNumSegments(); i++) {
+
+		string_view segmentID = invoiceTokenizer.getSegmentID(i);
+
+		if (segmentID == "ST") {
+			closeRange(i);
+			rangeStart = i;
+		}
+
+		else if (segmentID == "ISA" || segmentID == "GS" || segmentID == "GE" || segmentID == "IEA") {
+
+			closeRange(i);
+
+			if (segmentID == "ISA") {
+				interchangeControlNumber = getControlNumber(i, 13);
+				groupControlNumber = string_view();
+			}
+
+			else if (segmentID == "GS") {
+				groupControlNumber = getControlNumber(i, 6);
+			}
+
+		}
+
+		else if (rangeStart == SIZE_MAX) { //A segment outside of any transaction set starts a range that will fail validation.
+			rangeStart = i;
+		}
+
+		if (segmentID == "SE") {
+			closeRange(i + 1);
+		}
+
+	}
+
+	closeRange(invoiceTokenizer.getNumSegments());
+
+	if (transactionSets.empty()) {
+		transactionSets.push_back(TransactionSetRange{ 0, invoiceTokenizer.getNumSegments(), string_view(), string_view(), 1 });
+	}
+
+}
@@ -0,0 +1,138 @@
+#ifndef ENVELOPESTREAMPARSER_H
+#define ENVELOPESTREAMPARSER_H
+
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "EdiDelimiters.h"
+#include "EdiTokenizer.h"
+using namespace std;
+
+
+//The EnvelopeStreamParser class reads an interchange in fixed-size chunks and hands back one ST/SE transaction set at a time, along with
+//the ISA/GS envelope it came from. Only one chunk plus the transaction set being built are ever held in memory, so a multi-GB interchange
+//with thousands of invoices in it costs the same memory as a file with one. Segments that get cut in half by a chunk boundary are carried
+//over and finished when the next chunk comes in. Separators are read from each ISA as it comes up, so interchanges with different separators
+//can be concatenated into one file.
+
+struct TransactionSet {
+
+	string contents; //ST through SE, terminators included, ready to hand to EdiTokenizer.
+	string interchangeControlNumber; //ISA13
+	string functionalIDCode; //GS01
+	string groupControlNumber; //GS06
+	size_t sequence; //1 for the first transaction set in the file, 2 for the next...
+	size_t startOffset; //Byte offset of the ST segment in the file.
+	EdiDelimiters delimiters; //From the enclosing ISA; contents uses these.
+
+};
+
+struct TransactionSetSpan { //What splitTransactionSets finds: the same as a TransactionSet, but pointing into the buffer it was given.
+
+	string_view contents; //ST through SE, or a run of segments that isn't a transaction set at all (see splitTransactionSets).
+	string_view interchangeControlNumber; //ISA13, empty when there's no ISA around it.
+	string_view groupControlNumber; //GS06, likewise.
+	size_t sequence;
+	size_t startOffset;
+	EdiDelimiters delimiters;
+
+};
+
+
+//Splits a whole interchange that's already in memory (a mapped file, say) into its transaction sets without copying any of it. Segments
+//between sets that aren't ISA/GS/GE/IEA are kept together as a span of their own, so the caller's validateInvoiceEnvelope can say what's
+//wrong with them; a buffer with no transaction set in it at all comes back as one span holding everything. The envelope isn't checked here
+//(that's what EnvelopeStreamParser's getEnvelopeErrors is for).
+void splitTransactionSets(string_view contents, const EdiDelimiters& fallbackDelimiters, vector <TransactionSetSpan>& transactionSets);
+
+
+struct TransactionSetRange { //The same cut as a TransactionSetSpan, but as a run of segments in a tokenizer that has already been run.
+
+	size_t firstSegment;
+	size_t numSegments;
+	string_view interchangeControlNumber;
+	string_view groupControlNumber;
+	size_t sequence;
+
+};
+
+
+//Cuts an already tokenized interchange into transaction sets by segment number, with the same rules as the overload above, so a caller
+//holding the whole file's tables (see ParallelTokenizer) can hand each set to EdiTokenizer's range tokenize without scanning it again.
+//The tokenizer read the whole buffer with one set of separators, so an interchange whose later ISAs switch separators should go through
+//the overload above instead.
+void splitTransactionSets(const EdiTokenizer& invoiceTokenizer, vector <TransactionSetRange>& transactionSets);
+
+
+class EnvelopeStreamParser {
+
+	private:
+
+		ifstream inputStream;
+		vector <char> chunkBuffer;
+		size_t chunkSize;
+		size_t bufferStart; //Unconsumed bytes in chunkBuffer run from bufferStart to bufferEnd.
+		size_t bufferEnd;
+		size_t bufferFileOffset; //File offset of chunkBuffer[0].
+		bool endOfInput;
+
+		EdiDelimiters configuredDelimiters; //Used until the first ISA says otherwise.
+		EdiDelimiters delimiters;
+
+		string interchangeControlNumber;
+		string functionalIDCode;
+		string groupControlNumber;
+		bool insideTransactionSet;
+		size_t transactionSetsInGroup;
+		size_t groupsInInterchange;
+		size_t transactionSetsReturned;
+		size_t bytesConsumed;
+		vector <string> envelopeErrors;
+
+		bool readNextSegment(const char*& segmentStart, size_t& segmentLength, size_t& segmentOffset);
+		bool refillBuffer();
+		void handleEnvelopeSegment(const char* segmentStart, size_t segmentLength, size_t segmentOffset);
+
+	public:
+
+		//Constructors and destructor
+
+		EnvelopeStreamParser(); //See EnvelopeStreamParser.cpp for definitions
+
+		EnvelopeStreamParser(size_t chunkBytes, char elemDelimiter, char lineDelim); //The delimiters are a fallback; each ISA's own separators win.
+
+		~EnvelopeStreamParser() {}
+
+
+		void open(const string& path); //Throws a string if the file can't be opened.
+
+		bool nextTransactionSet(TransactionSet& transactionSet); //Returns false once the file is used up.
+
+
+
+		//Accessors
+
+		size_t getChunkSize() const
+		{
+			return chunkSize;
+		}
+
+		size_t getBytesConsumed() const
+		{
+			return bytesConsumed;
+		}
+
+		size_t getTransactionSetsReturned() const
+		{
+			return transactionSetsReturned;
+		}
+
+		const vector <string>& getEnvelopeErrors() const //GE01/IEA01 count mismatches, a segment cut off at end of file, and so on.
+		{
+			return envelopeErrors;
+		}
+
+};
+
+#endif
@@ -0,0 +1,290 @@
+#include "FolderWatcher.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iterator>
+#include <thread>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+
+FolderWatcher::FolderWatcher() {
+
+	usingNotifications = false;
+	notifyDescriptor = -1;
+	pollIntervalMs = 250;
+	batchWindowMs = 2;
+
+}
+
+FolderWatcher::~FolderWatcher() {
+
+	close();
+
+}
+
+
+
+void FolderWatcher::open(const string& watchDirectory, bool forcePolling) {
+
+	error_code directoryError;
+
+	close();
+
+	if (!filesystem::is_directory(watchDirectory, directoryError)) {
+		throw string("ERROR. " + watchDirectory + " is not a directory.\n");
+	}
+
+	directory = watchDirectory;
+
+#ifdef __linux__
+
+	if (!forcePolling) {
+
+		notifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+		if (notifyDescriptor >= 0 && inotify_add_watch(notifyDescriptor, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) >= 0) {
+			usingNotifications = true;
+		}
+
+		else if (notifyDescriptor >= 0) { //Out of watches, or the filesystem doesn't support it. Polling still works.
+			::close(notifyDescriptor);
+			notifyDescriptor = -1;
+		}
+
+	}
+
+#endif
+
+	if (!usingNotifications) {
+
+		for (const string& path : scanDirectory()) { //Files already sitting there count as settled from the start.
+
+			FileStamp stamp;
+
+			if (getFileStamp(path, stamp)) {
+				previousScan[path] = stamp;
+			}
+
+		}
+
+	}
+
+}
+
+
+
+void FolderWatcher::close() {
+
+#ifdef __linux__
+
+	if (notifyDescriptor >= 0) {
+		::close(notifyDescriptor);
+	}
+
+#endif
+
+	notifyDescriptor = -1;
+	usingNotifications = false;
+	previousScan.clear();
+	changedFiles.clear();
+
+}
+
+
+
+bool FolderWatcher::isIgnoredFileName(const string& fileName) {
+
+	auto endsWith = [&fileName](const string& suffix) {
+		return fileName.length() >= suffix.length() && fileName.compare(fileName.length() - suffix.length(), suffix.length(), suffix) == 0;
+	};
+
+	return fileName.empty() || fileName[0] == '.' || endsWith(".tmp") || endsWith(".part");
+
+}
+
+
+
+bool FolderWatcher::getFileStamp(const string& path, FileStamp& stamp) {
+
+	error_code statusError;
+
+	if (!filesystem::is_regular_file(path, statusError)) {
+		return false;
+	}
+
+	uintmax_t fileSize = filesystem::file_size(path, statusError);
+
+	if (statusError) {
+		return false;
+	}
+
+	filesystem::file_time_type modifiedTime = filesystem::last_write_time(path, statusError);
+
+	if (statusError) {
+		return false;
+	}
+
+	stamp.size = static_cast<uint64_t>(fileSize);
+	stamp.modifiedTime = static_cast<int64_t>(modifiedTime.time_since_epoch().count());
+
+	return true;
+
+}
+
+
+
+vector <string> FolderWatcher::scanDirectory() const {
+
+	vector <string> files;
+	error_code iteratorError;
+
+	for (filesystem::directory_iterator entry(directory, iteratorError), end; !iteratorError && entry != end; entry.increment(iteratorError)) {
+
+		if (entry->is_regular_file() && !isIgnoredFileName(entry->path().filename().string())) {
+			files.push_back(entry->path().string());
+		}
+
+	}
+
+	sort(files.begin(), files.end());
+
+	return files;
+
+}
+
+
+
+bool FolderWatcher::waitForFiles(vector <string>& readyFiles, int timeoutMs) {
+
+	readyFiles.clear();
+
+	if (usingNotifications) {
+		return waitForNotifications(readyFiles, timeoutMs);
+	}
+
+	return pollForSettledFiles(readyFiles, timeoutMs);
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function waitForNotifications sleeps in poll() until inotify has something, then keeps collecting for batchWindowMs so a burst of drops
+//comes back as one batch instead of one file at a time.
+//
+//*******************************************************************************************************************************************
+
+bool FolderWatcher::waitForNotifications(vector <string>& readyFiles, int timeoutMs) {
+
+#ifdef __linux__
+
+	struct pollfd notifyPoll = { notifyDescriptor, POLLIN, 0 };
+
+	if (poll(&notifyPoll, 1, timeoutMs) <= 0) {
+		return false;
+	}
+
+	drainNotifications(readyFiles);
+
+	if (batchWindowMs > 0) {
+
+		while (poll(&notifyPoll, 1, batchWindowMs) > 0) {
+			drainNotifications(readyFiles);
+		}
+
+	}
+
+	sort(readyFiles.begin(), readyFiles.end());
+	readyFiles.erase(unique(readyFiles.begin(), readyFiles.end()), readyFiles.end());
+
+	return !readyFiles.empty();
+
+#else
+
+	return false;
+
+#endif
+
+}
+
+void FolderWatcher::drainNotifications(vector <string>& readyFiles) {
+
+#ifdef __linux__
+
+	alignas(struct inotify_event) char eventBuffer[16384];
+	ssize_t bytesRead;
+
+	while ((bytesRead = read(notifyDescriptor, eventBuffer, sizeof(eventBuffer))) > 0) {
+
+		for (ssize_t offset = 0; offset < bytesRead; ) {
+
+			const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(eventBuffer + offset);
+
+			if (event->len > 0 && !(event->mask & IN_ISDIR) && !isIgnoredFileName(event->name)) {
+				readyFiles.push_back((filesystem::path(directory) / event->name).string());
+			}
+
+			offset += sizeof(struct inotify_event) + event->len;
+
+		}
+
+	}
+
+#endif
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function pollForSettledFiles rescans the directory after one poll interval. A file is ready once it looks exactly the same as it did on the
+//previous scan; it's only reported on the scan where it first settles, so the caller sees each version of a file once.
+//
+//*******************************************************************************************************************************************
+
+bool FolderWatcher::pollForSettledFiles(vector <string>& readyFiles, int timeoutMs) {
+
+	map <string, FileStamp> currentScan;
+
+	this_thread::sleep_for(chrono::milliseconds((timeoutMs < 0) ? pollIntervalMs : min(pollIntervalMs, timeoutMs)));
+
+	for (const string& path : scanDirectory()) {
+
+		FileStamp stamp;
+
+		if (!getFileStamp(path, stamp)) {
+			continue;
+		}
+
+		map <string, FileStamp>::const_iterator previous = previousScan.find(path);
+
+		currentScan[path] = stamp;
+
+		if (previous == previousScan.end() || !(previous->second == stamp)) { //New or still being written. Look again next time.
+			changedFiles.insert(path);
+		}
+
+		else if (changedFiles.erase(path) > 0) { //Changed before, held still since.
+			readyFiles.push_back(path);
+		}
+
+	}
+
+	for (set <string>::iterator changed = changedFiles.begin(); changed != changedFiles.end(); ) { //Forget anything deleted mid-write.
+		changed = (currentScan.count(*changed) > 0) ? next(changed) : changedFiles.erase(changed);
+	}
+
+	previousScan.swap(currentScan);
+
+	return !readyFiles.empty();
+
+}
@@ -0,0 +1,102 @@
+#ifndef FOLDERWATCHER_H
+#define FOLDERWATCHER_H
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+using namespace std;
+
+
+//The FolderWatcher class tells its caller when files land in a directory. On Linux it uses inotify and only reports a file once it has been
+//closed after writing (IN_CLOSE_WRITE) or renamed into the directory (IN_MOVED_TO), so a half-written file is never picked up. Everywhere
+//else, or if inotify can't be set up, it falls back to polling: the directory is rescanned every pollIntervalMs and a file is reported
+//once its size and modification time have held still for one whole interval.
+//
+//Hidden files (leading '.') and the usual in-progress names (*.tmp, *.part) are ignored, since gateways write to those and rename when
+//they're done.
+
+struct FileStamp {
+
+	uint64_t size;
+	int64_t modifiedTime; //Filesystem clock ticks; only ever compared for equality.
+
+	bool operator==(const FileStamp& other) const
+	{
+		return size == other.size && modifiedTime == other.modifiedTime;
+	}
+
+};
+
+
+class FolderWatcher {
+
+	private:
+
+		string directory;
+		bool usingNotifications;
+		int notifyDescriptor; //inotify instance, -1 when polling.
+		int pollIntervalMs;
+		int batchWindowMs;
+		map <string, FileStamp> previousScan; //Polling only: what each file looked like last time around.
+		set <string> changedFiles; //Polling only: files that were new or different on the last scan and haven't settled yet.
+
+		bool waitForNotifications(vector <string>& readyFiles, int timeoutMs);
+		void drainNotifications(vector <string>& readyFiles);
+		bool pollForSettledFiles(vector <string>& readyFiles, int timeoutMs);
+
+	public:
+
+		//Constructors and destructor
+
+		FolderWatcher(); //See FolderWatcher.cpp for definitions
+
+		~FolderWatcher();
+
+		FolderWatcher(const FolderWatcher&) = delete;
+		FolderWatcher& operator=(const FolderWatcher&) = delete;
+
+
+		void open(const string& watchDirectory, bool forcePolling = false); //Throws a string if the directory isn't there.
+
+		void close();
+
+		vector <string> scanDirectory() const; //Every file currently in the directory that isn't ignored, sorted by name.
+
+		bool waitForFiles(vector <string>& readyFiles, int timeoutMs); //Blocks up to timeoutMs. Returns true with full paths if anything landed.
+
+		static bool isIgnoredFileName(const string& fileName);
+
+		static bool getFileStamp(const string& path, FileStamp& stamp); //False if the path isn't a regular file.
+
+
+
+		//Mutators
+
+		void setPollIntervalMs(int intervalMs)
+		{
+			pollIntervalMs = (intervalMs < 1) ? 1 : intervalMs;
+		}
+
+		void setBatchWindowMs(int windowMs) //After the first notification, how long to keep collecting more before handing back the batch.
+		{
+			batchWindowMs = (windowMs < 0) ? 0 : windowMs;
+		}
+
+
+		//Accessors
+
+		bool isUsingNotifications() const
+		{
+			return usingNotifications;
+		}
+
+		const string& getDirectory() const
+		{
+			return directory;
+		}
+
+};
+
+#endif
@@ -0,0 +1,237 @@
+#include "HeadlessRunner.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <thread>
+using namespace std;
+
+
+HeadlessRunner::HeadlessRunner() {
+
+	outputPath = "-";
+	renderFormat = RENDER_HUMAN;
+	threadCount = 0;
+	quiet = false;
+
+	exitCode = HEADLESS_EXIT_OK;
+	numFiles = 0;
+	numTransactionSets = 0;
+	numSchemaInvalid = 0;
+	numNotTransactionSets = 0;
+	numInputsMissing = 0;
+
+}
+
+
+
+string HeadlessRunner::getUsage(const string& programName) {
+
+	return "Usage: " + programName + " --headless [--format human|machine|validate] [--output <file> | -] [--threads <n>] [--quiet] [--] <file | directory | @listFile> ...\n"
+		"Exit codes: 0 all clean, 1 schema errors or a TDS01 that doesn't add up, 2 not a transaction set (checked per ST/SE), 3 input missing, 4 output failed, 64 bad arguments.\n";
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function parseArguments reads everything from firstArgument on. Options can come in any order ahead of or among the paths; "--" ends the
+//options for a path that starts with a dash.
+//
+//*******************************************************************************************************************************************
+
+void HeadlessRunner::parseArguments(int argc, char* argv[], int firstArgument) {
+
+	bool optionsEnded = false;
+
+	for (int i = firstArgument; i < argc; i++) {
+
+		string argument = argv[i];
+
+		if (optionsEnded || argument.empty() || argument[0] != '-' || argument == "-") {
+			inputPaths.push_back(argument);
+			continue;
+		}
+
+		if (argument == "--") {
+			optionsEnded = true;
+			continue;
+		}
+
+		if (argument == "--quiet") {
+			quiet = true;
+			continue;
+		}
+
+		if (argument != "--format" && argument != "--output" && argument != "--threads") {
+			throw string("ERROR. Unknown option " + argument + ".\n");
+		}
+
+		if (i + 1 >= argc) {
+			throw string("ERROR. " + argument + " needs a value.\n");
+		}
+
+		string value = argv[++i];
+
+		if (argument == "--format") {
+
+			if (value == "human") {
+				renderFormat = RENDER_HUMAN;
+			}
+
+			else if (value == "machine") {
+				renderFormat = RENDER_MACHINE;
+			}
+
+			else if (value == "validate") {
+				renderFormat = RENDER_VALIDATION;
+			}
+
+			else {
+				throw string("ERROR. --format has to be human, machine, or validate.\n");
+			}
+
+		}
+
+		else if (argument == "--output") {
+
+			outputPath = value;
+
+		}
+
+		else {
+
+			if (value.empty() || value.find_first_not_of("0123456789") != string::npos || value.length() > 4) {
+				throw string("ERROR. --threads needs a whole number.\n");
+			}
+
+			threadCount = static_cast<unsigned>(stoul(value));
+
+		}
+
+	}
+
+	if (inputPaths.empty()) {
+		throw string("ERROR. No input files were given.\n");
+	}
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function run expands the paths, then renders them a chunk at a time, writing each chunk as soon as it's finished. The output is in the same
+//order as the paths were given regardless of the thread count.
+//
+//*******************************************************************************************************************************************
+
+HeadlessExitCode HeadlessRunner::run(ostream& log) {
+
+	FdOutputSink standardOutputSink(1);
+	FileOutputSink outputFileSink;
+	OutputSink* outputSink = &standardOutputSink;
+	BatchProcessor batchProcessor((threadCount == 0) ? thread::hardware_concurrency() : threadCount);
+	vector <string> inputFiles;
+	chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+	uint64_t inputBytes = 0;
+
+	for (const string& path : inputPaths) {
+
+		try {
+			BatchProcessor::collectInputFiles(path, inputFiles);
+		}
+
+		catch (string exceptionMsg) {
+			log << exceptionMsg;
+			numInputsMissing++;
+			noteOutcome(HEADLESS_EXIT_INPUT_MISSING);
+		}
+
+	}
+
+	try {
+
+		if (outputPath != "-") {
+			outputFileSink.open(outputPath);
+			outputSink = &outputFileSink;
+		}
+
+		batchProcessor.setRenderFormat(renderFormat);
+
+		for (size_t chunkStart = 0; chunkStart < inputFiles.size(); chunkStart += HEADLESS_CHUNK_FILES) {
+
+			size_t chunkEnd = min(inputFiles.size(), chunkStart + HEADLESS_CHUNK_FILES);
+
+			batchProcessor.clearInputFiles();
+
+			for (size_t i = chunkStart; i < chunkEnd; i++) {
+				batchProcessor.addInputPath(inputFiles[i]); //Already expanded, so these are plain files.
+			}
+
+			batchProcessor.run();
+			batchProcessor.writeResults(*outputSink);
+
+			for (const BatchInvoiceResult& result : batchProcessor.getResults()) {
+
+				if (result.outcome == INVOICE_CANNOT_OPEN) {
+					log << result.fileName << ": " << result.errorMessage;
+					numInputsMissing++;
+					noteOutcome(HEADLESS_EXIT_INPUT_MISSING);
+				}
+
+				for (const TransactionSetResult& transactionSet : result.transactionSets) {
+
+					if (transactionSet.outcome == INVOICE_NOT_TRANSACTION_SET) {
+
+						log << result.fileName;
+
+						if (result.transactionSets.size() > 1) {
+							log << " (transaction set " << transactionSet.sequence << ")";
+						}
+
+						log << ": " << transactionSet.errorMessage << "\n";
+						numNotTransactionSets++;
+						noteOutcome(HEADLESS_EXIT_NOT_TRANSACTION_SET);
+
+					}
+
+					else if (transactionSet.numSchemaErrors > 0 || transactionSet.numTotalMismatches > 0) { //A TDS01 that doesn't add up breaks the convention's own rule for it.
+						numSchemaInvalid++;
+						noteOutcome(HEADLESS_EXIT_SCHEMA_ERRORS);
+					}
+
+				}
+
+			}
+
+			numFiles += batchProcessor.getResults().size();
+			numTransactionSets += batchProcessor.getNumTransactionSets();
+			inputBytes += batchProcessor.getTotalInputBytes();
+
+		}
+
+		outputFileSink.close();
+
+	}
+
+	catch (string exceptionMsg) { //Opening or writing the output.
+
+		log << exceptionMsg;
+		noteOutcome(HEADLESS_EXIT_OUTPUT_FAILED);
+		return exitCode;
+
+	}
+
+	if (!quiet) {
+
+		double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+		log << numFiles << " file(s) holding " << numTransactionSets << " transaction set(s), " << numSchemaInvalid << " with schema errors, " << numNotTransactionSets << " not transaction sets, " << numInputsMissing << " missing or unreadable. ";
+		log << fixed << setprecision(3) << seconds << " s, " << setprecision(2) << inputBytes / (1024.0 * 1024.0) / ((seconds > 0.0) ? seconds : 1e-9) << " MB/s. Exit code " << exitCode << "." << endl;
+
+	}
+
+	return exitCode;
+
+}
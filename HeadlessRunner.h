@@ -0,0 +1,92 @@
+#ifndef HEADLESSRUNNER_H
+#define HEADLESSRUNNER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "BatchProcessor.h"
+#include "OutputSink.h"
+using namespace std;
+
+
+//The HeadlessRunner class is the program with nobody at the keyboard: everything comes from the command line, the invoices go to stdout
+//or a file, anything meant for a person goes to stderr, and the exit code says how it went. It never prompts, never clears the screen, and
+//never starts a shell, so a scheduler can push thousands of invoices through one process.
+//
+//	program --headless [--format human|machine|validate] [--output <file> | -] [--threads <n>] [--quiet] [--] <file | directory | @listFile> ...
+//
+//Files are run through a BatchProcessor in chunks of HEADLESS_CHUNK_FILES, each chunk written with one batched write as soon as it's
+//done, so memory stays level however many files there are. A path that can't be found is reported and skipped rather than ending the run.
+//A file can be one bare transaction set or a whole ISA/GS interchange; each ST...SE in it is rendered and counted on its own.
+//
+//The exit code is the worst thing that happened to any file or transaction set. The values only ever grow with severity, so a caller can
+//just test >=.
+
+enum HeadlessExitCode {
+
+	HEADLESS_EXIT_OK = 0,
+	HEADLESS_EXIT_SCHEMA_ERRORS = 1,		//Everything was read and rendered, but at least one invoice broke the implementation convention or its TDS01 didn't reconcile.
+	HEADLESS_EXIT_NOT_TRANSACTION_SET = 2,	//At least one file (or a stretch of one) wasn't a usable ST/SE transaction set.
+	HEADLESS_EXIT_INPUT_MISSING = 3,		//At least one path didn't exist or couldn't be opened.
+	HEADLESS_EXIT_OUTPUT_FAILED = 4,		//The output couldn't be written. Nothing after the failure is trustworthy.
+	HEADLESS_EXIT_USAGE = 64				//Bad arguments; nothing was processed. (Same number as EX_USAGE in sysexits.h.)
+
+};
+
+const size_t HEADLESS_CHUNK_FILES = 512;
+
+
+class HeadlessRunner {
+
+	private:
+
+		vector <string> inputPaths;
+		string outputPath; //"-" for stdout.
+		BatchRenderFormat renderFormat;
+		unsigned threadCount; //0 means one per core.
+		bool quiet;
+
+		HeadlessExitCode exitCode;
+		size_t numFiles;
+		size_t numTransactionSets;
+		size_t numSchemaInvalid; //These two count transaction sets.
+		size_t numNotTransactionSets;
+		size_t numInputsMissing;
+
+		void noteOutcome(HeadlessExitCode outcome)
+		{
+			exitCode = (outcome > exitCode) ? outcome : exitCode;
+		}
+
+	public:
+
+		//Constructors and destructor
+
+		HeadlessRunner(); //See HeadlessRunner.cpp for definitions
+
+		~HeadlessRunner() {}
+
+
+		void parseArguments(int argc, char* argv[], int firstArgument); //Throws a string describing the mistake.
+
+		HeadlessExitCode run(ostream& log); //log gets the per-file errors and the summary (unless quiet). Returns the exit code too.
+
+		static string getUsage(const string& programName);
+
+
+
+		//Accessors
+
+		HeadlessExitCode getExitCode() const
+		{
+			return exitCode;
+		}
+
+		size_t getNumFiles() const
+		{
+			return numFiles;
+		}
+
+};
+
+#endif
@@ -0,0 +1,429 @@
+#include "InvoiceAnalytics.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include "EdiInputFile.h"
+#include "EdiTokenizer.h"
+#include "ElementCode.h"
+using namespace std;
+
+
+constexpr uint8_t SEGMENT_CODE_ST = findSegmentCode("ST");
+constexpr uint8_t SEGMENT_CODE_BIG = findSegmentCode("BIG");
+constexpr uint8_t SEGMENT_CODE_N1 = findSegmentCode("N1");
+constexpr uint8_t SEGMENT_CODE_IT1 = findSegmentCode("IT1");
+
+const size_t ANALYTICS_MIN_BLOCK_ROWS = 64 * 1024; //Fewer rows than this per thread isn't worth a thread when grouping.
+const size_t ANALYTICS_MAX_GROUPS_FOR_LANES = 16 * 1024; //Four sets of partial sums only pay off while they all stay in cache.
+
+
+InvoiceAnalytics::InvoiceAnalytics() {
+
+	numFailedFiles = 0;
+	loadSeconds = 0.0;
+
+}
+
+InvoiceAnalytics::InvoiceAnalytics(unsigned threadCount) : pool(threadCount) {
+
+	numFailedFiles = 0;
+	loadSeconds = 0.0;
+
+}
+
+
+
+uint32_t InvoiceAnalytics::KeyDictionary::intern(string_view key) {
+
+	auto [entry, inserted] = codes.try_emplace(string(key), static_cast<uint32_t>(keys.size()));
+
+	if (inserted) {
+		keys.push_back(entry->first);
+	}
+
+	return entry->second;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function extractLineItems walks a document's segments once, remembering the PO number from BIG and the vendor from the N1*VN party as it
+//goes, and adds a row for every IT1 under them. ST starts a new invoice, so a vendor or PO never leaks from one transaction set into the
+//next. Segment IDs are compared as the interned codes the store keeps for every segment (see ElementCode.h).
+//
+//*******************************************************************************************************************************************
+
+void InvoiceAnalytics::extractLineItems(const InvoiceDocumentStore& documentStore, LineItemColumns& columns) {
+
+	uint32_t vendorCode = columns.dictionaries[BY_VENDOR].intern("");
+	uint32_t purchaseOrderCode = columns.dictionaries[BY_PURCHASE_ORDER].intern("");
+
+	auto elementText = [&documentStore](size_t segmentIndex, int position) {
+		return (position < documentStore.getSegmentNumElements(segmentIndex)) ? documentStore.getElementText(documentStore.getSegmentFirstElement(segmentIndex) + position) : string_view();
+	};
+
+	auto elementFixedPoint = [&documentStore](size_t segmentIndex, int position, int64_t& scaledValue) {
+		return position < documentStore.getSegmentNumElements(segmentIndex) && documentStore.getElementFixedPoint(documentStore.getSegmentFirstElement(segmentIndex) + position, scaledValue);
+	};
+
+	for (size_t i = 0; i < documentStore.getNumSegments(); i++) {
+
+		uint8_t segmentCode = documentStore.getSegmentCode(i);
+
+		if (segmentCode == SEGMENT_CODE_ST) {
+
+			columns.numInvoices++;
+			vendorCode = columns.dictionaries[BY_VENDOR].intern("");
+			purchaseOrderCode = columns.dictionaries[BY_PURCHASE_ORDER].intern("");
+
+		}
+
+		else if (segmentCode == SEGMENT_CODE_BIG) {
+
+			purchaseOrderCode = columns.dictionaries[BY_PURCHASE_ORDER].intern(elementText(i, 4));
+
+		}
+
+		else if (segmentCode == SEGMENT_CODE_N1 && elementText(i, 1) == "VN") {
+
+			vendorCode = columns.dictionaries[BY_VENDOR].intern(elementText(i, 4));
+
+		}
+
+		else if (segmentCode == SEGMENT_CODE_IT1) {
+
+			int64_t quantity = 0;
+			int64_t unitPrice = 0;
+			string_view productID = elementText(i, 9);
+
+			if (!elementFixedPoint(i, 2, quantity) || !elementFixedPoint(i, 4, unitPrice)) {
+				quantity = 0;
+				unitPrice = 0;
+				columns.numUnpricedLineItems++;
+			}
+
+			if (productID.empty()) {
+				productID = elementText(i, 7);
+			}
+
+			columns.quantity.push_back(quantity);
+			columns.unitPrice.push_back(unitPrice);
+			int64_t extendedAmount = 0;
+
+			if (!multiplyFixedPoint(quantity, unitPrice, extendedAmount)) { //Too big for 64 bits; counted the same as a line with no price.
+				quantity = 0;
+				unitPrice = 0;
+				columns.numUnpricedLineItems++;
+			}
+
+			columns.extendedAmount.push_back(extendedAmount);
+			columns.keyCodes[BY_VENDOR].push_back(vendorCode);
+			columns.keyCodes[BY_PRODUCT].push_back(columns.dictionaries[BY_PRODUCT].intern(productID));
+			columns.keyCodes[BY_PURCHASE_ORDER].push_back(purchaseOrderCode);
+
+		}
+
+	}
+
+}
+
+
+
+void InvoiceAnalytics::addDocument(const InvoiceDocumentStore& documentStore) {
+
+	LineItemColumns part;
+
+	extractLineItems(documentStore, part);
+	appendColumns(part);
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function appendColumns merges one file's rows in. Its key dictionaries are tiny next to its rows, so each local key is looked up in the
+//global dictionary once and the key columns are then rewritten through a plain array. Each new row's amount is added, sign dropped, to a
+//running total as it comes in; a row that would take that total past INT64_MAX is zeroed and counted as unpriced, which is what lets the
+//summing loops in groupBy and getTotalExtendedAmount go unchecked.
+//
+//*******************************************************************************************************************************************
+
+void InvoiceAnalytics::appendColumns(const LineItemColumns& part) {
+
+	for (size_t dimension = 0; dimension < NUM_ANALYTICS_DIMENSIONS; dimension++) {
+
+		vector <uint32_t> globalCodes(part.dictionaries[dimension].keys.size());
+
+		for (size_t code = 0; code < globalCodes.size(); code++) {
+			globalCodes[code] = lineItems.dictionaries[dimension].intern(part.dictionaries[dimension].keys[code]);
+		}
+
+		vector <uint32_t>& keyColumn = lineItems.keyCodes[dimension];
+		size_t start = keyColumn.size();
+
+		keyColumn.resize(start + part.keyCodes[dimension].size());
+
+		for (size_t row = 0; row < part.keyCodes[dimension].size(); row++) {
+			keyColumn[start + row] = globalCodes[part.keyCodes[dimension][row]];
+		}
+
+	}
+
+	size_t start = lineItems.extendedAmount.size();
+
+	lineItems.quantity.insert(lineItems.quantity.end(), part.quantity.begin(), part.quantity.end());
+	lineItems.unitPrice.insert(lineItems.unitPrice.end(), part.unitPrice.begin(), part.unitPrice.end());
+	lineItems.extendedAmount.insert(lineItems.extendedAmount.end(), part.extendedAmount.begin(), part.extendedAmount.end());
+	lineItems.numInvoices += part.numInvoices;
+	lineItems.numUnpricedLineItems += part.numUnpricedLineItems;
+
+	for (size_t row = start; row < lineItems.extendedAmount.size(); row++) { //multiplyFixedPoint never hands back INT64_MIN, so the sign always drops cleanly.
+
+		int64_t amount = lineItems.extendedAmount[row];
+
+		if (!addFixedPoint(lineItems.absoluteAmountTotal, (amount < 0) ? -amount : amount)) {
+
+			lineItems.quantity[row] = 0;
+			lineItems.unitPrice[row] = 0;
+			lineItems.extendedAmount[row] = 0;
+			lineItems.numUnpricedLineItems++;
+
+		}
+
+	}
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function addFiles maps, tokenizes, and stores each file on its own worker, pulling its rows into a separate set of columns, then merges
+//them in the order the files were given so the dictionary codes (and ties in the reports) come out the same on every run.
+//
+//*******************************************************************************************************************************************
+
+void InvoiceAnalytics::addFiles(const vector <string>& files) {
+
+	vector <LineItemColumns> parts(files.size());
+	vector <char> failed(files.size(), 0);
+	vector <size_t> taskOrder(files.size());
+
+	for (size_t i = 0; i < files.size(); i++) {
+		taskOrder[i] = i;
+	}
+
+	chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+
+	pool.run(taskOrder, [&](size_t fileIndex) {
+
+		EdiInputFile invoiceInputFile;
+		EdiTokenizer invoiceTokenizer;
+		InvoiceDocumentStore documentStore;
+
+		try {
+			invoiceInputFile.open(files[fileIndex]);
+		}
+
+		catch (string exceptionMsg) {
+			failed[fileIndex] = 1;
+			return;
+		}
+
+		invoiceTokenizer.tokenize(invoiceInputFile.getContents());
+
+		try {
+			documentStore.build(invoiceTokenizer);
+		}
+
+		catch (const string& exceptionMsg) { //Too big for the store's columns.
+			failed[fileIndex] = 1;
+			return;
+		}
+
+		extractLineItems(documentStore, parts[fileIndex]);
+
+	});
+
+	for (size_t i = 0; i < files.size(); i++) {
+
+		numFailedFiles += failed[i];
+		appendColumns(parts[i]);
+		parts[i] = LineItemColumns(); //Let each file's rows go as soon as they're merged.
+
+	}
+
+	loadSeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+}
+
+
+
+void InvoiceAnalytics::clear() {
+
+	lineItems = LineItemColumns();
+	numFailedFiles = 0;
+	loadSeconds = 0.0;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function groupBy is the aggregation kernel. The rows are split into one contiguous block per thread, and each block adds its amounts and
+//counts into its own dense arrays indexed by key code. When there are few enough groups, each block keeps four interleaved sets of arrays so
+//back-to-back rows for the same vendor don't wait on each other's store. Blocks are cut down when there are so many distinct keys (products,
+//usually) that the partial arrays would outweigh the rows themselves. Everything is folded into one array at the end, and only then are the
+//groups ranked; partial_sort keeps top-N cheap when there are a lot of them. None of the sums can overflow, since appendColumns keeps the
+//amounts' combined size within an int64_t.
+//
+//*******************************************************************************************************************************************
+
+vector <AnalyticsGroup> InvoiceAnalytics::groupBy(AnalyticsDimension dimension, size_t topN) const {
+
+	const vector <uint32_t>& keyColumn = lineItems.keyCodes[dimension];
+	const int64_t* amounts = lineItems.extendedAmount.data();
+	const uint32_t* keys = keyColumn.data();
+	size_t numRows = keyColumn.size();
+	size_t numGroups = lineItems.dictionaries[dimension].keys.size();
+	size_t numLanes = (numGroups <= ANALYTICS_MAX_GROUPS_FOR_LANES) ? 4 : 1;
+	size_t numBlocks = (numRows + ANALYTICS_MIN_BLOCK_ROWS - 1) / ANALYTICS_MIN_BLOCK_ROWS;
+
+	if (numBlocks > pool.getNumThreads()) {
+		numBlocks = pool.getNumThreads();
+	}
+
+	if (numGroups > 0 && numBlocks * numLanes * numGroups > numRows) {
+		numBlocks = (numRows / (numLanes * numGroups) > 0) ? numRows / (numLanes * numGroups) : 1;
+	}
+
+	vector <int64_t> blockSums(numBlocks * numLanes * numGroups, 0);
+	vector <uint64_t> blockCounts(numBlocks * numLanes * numGroups, 0);
+	vector <size_t> taskOrder(numBlocks);
+
+	for (size_t block = 0; block < numBlocks; block++) {
+		taskOrder[block] = block;
+	}
+
+	pool.run(taskOrder, [&](size_t block) {
+
+		int64_t* sums = blockSums.data() + block * numLanes * numGroups;
+		uint64_t* counts = blockCounts.data() + block * numLanes * numGroups;
+		size_t row = numRows / numBlocks * block;
+		size_t end = (block + 1 == numBlocks) ? numRows : numRows / numBlocks * (block + 1);
+
+		if (numLanes == 4) {
+
+			for (; row + 4 <= end; row += 4) {
+
+				sums[keys[row]] += amounts[row];
+				sums[numGroups + keys[row + 1]] += amounts[row + 1];
+				sums[2 * numGroups + keys[row + 2]] += amounts[row + 2];
+				sums[3 * numGroups + keys[row + 3]] += amounts[row + 3];
+
+				counts[keys[row]]++;
+				counts[numGroups + keys[row + 1]]++;
+				counts[2 * numGroups + keys[row + 2]]++;
+				counts[3 * numGroups + keys[row + 3]]++;
+
+			}
+
+		}
+
+		for (; row < end; row++) {
+			sums[keys[row]] += amounts[row];
+			counts[keys[row]]++;
+		}
+
+	});
+
+	vector <AnalyticsGroup> groups(numGroups);
+
+	for (size_t group = 0; group < numGroups; group++) {
+
+		int64_t total = 0;
+		uint64_t count = 0;
+
+		for (size_t lane = 0; lane < numBlocks * numLanes; lane++) {
+			total += blockSums[lane * numGroups + group];
+			count += blockCounts[lane * numGroups + group];
+		}
+
+		groups[group] = AnalyticsGroup{ lineItems.dictionaries[dimension].keys[group], total, count };
+
+	}
+
+	groups.erase(remove_if(groups.begin(), groups.end(), [](const AnalyticsGroup& group) { return group.numLineItems == 0; }), groups.end()); //An invoice with no IT1 still interns its vendor and PO.
+
+	size_t numToRank = (topN == 0 || topN > groups.size()) ? groups.size() : topN;
+
+	partial_sort(groups.begin(), groups.begin() + numToRank, groups.end(), [](const AnalyticsGroup& left, const AnalyticsGroup& right) {
+		return (left.extendedAmount != right.extendedAmount) ? left.extendedAmount > right.extendedAmount : left.key < right.key;
+	});
+
+	groups.resize(numToRank);
+
+	return groups;
+
+}
+
+
+
+int64_t InvoiceAnalytics::getTotalExtendedAmount() const {
+
+	int64_t total = 0;
+
+	for (int64_t amount : lineItems.extendedAmount) { //No branches and one contiguous column, so the compiler vectorizes it. Can't overflow; see appendColumns.
+		total += amount;
+	}
+
+	return total;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function displayReport prints the totals and a top-N table for each dimension, with how long each grouping took.
+//
+//*******************************************************************************************************************************************
+
+void InvoiceAnalytics::displayReport(ostream& out, size_t topN) const {
+
+	out << "Loaded " << getNumLineItems() << " line item(s) from " << getNumInvoices() << " invoice(s) on " << pool.getNumThreads() << " thread(s) in ";
+	out << fixed << setprecision(3) << loadSeconds << " s";
+
+	if (numFailedFiles > 0) {
+		out << "; " << numFailedFiles << " file(s) could not be opened";
+	}
+
+	out << "." << endl;
+
+	if (getNumUnpricedLineItems() > 0) {
+		out << getNumUnpricedLineItems() << " line item(s) had no usable IT102/IT104, or came to more than can be added up, and count as $0.00." << endl;
+	}
+
+	out << "Total extended amount (IT102 x IT104): $" << formatFixedPoint(getTotalExtendedAmount(), 2) << endl;
+
+	for (size_t dimension = 0; dimension < NUM_ANALYTICS_DIMENSIONS; dimension++) {
+
+		chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+		vector <AnalyticsGroup> groups = groupBy(static_cast<AnalyticsDimension>(dimension), topN);
+		double milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - startTime).count();
+
+		out << endl << getDimensionName(static_cast<AnalyticsDimension>(dimension)) << ": top " << groups.size() << " (" << fixed << setprecision(2) << milliseconds << " ms)" << endl;
+		out << left << setw(32) << "Key" << right << setw(22) << "Extended amount" << setw(14) << "Line items" << endl;
+		out << "--------------------------------------------------------------------" << endl;
+
+		for (const AnalyticsGroup& group : groups) {
+			out << left << setw(32) << (group.key.empty() ? string_view("(none)") : group.key) << right << setw(22) << "$" + formatFixedPoint(group.extendedAmount, 2) << setw(14) << group.numLineItems << endl;
+		}
+
+	}
+
+}
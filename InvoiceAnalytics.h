@@ -0,0 +1,138 @@
+#ifndef INVOICEANALYTICS_H
+#define INVOICEANALYTICS_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "InvoiceDocumentStore.h"
+#include "WorkStealingPool.h"
+using namespace std;
+
+
+//The InvoiceAnalytics class pulls every IT1 line item out of any number of parsed invoices into one column store, so finance questions
+//("spend by vendor", "top products", "what did PO 123 cost") are a pass over a few arrays instead of re-reading files. Each line item is a
+//row: quantity (IT102) and unit price (IT104) as exact fixed-point, the extended amount worked out once when the row is added, and three
+//dictionary-encoded key columns -- the vendor (N104 of the N1*VN party), the product (IT109, or IT107 when there's no IT109), and the
+//purchase order (BIG04). Every distinct key string is stored once; a row just holds its 32-bit code.
+//
+//Grouped totals are dense: codes run 0 to the number of distinct keys, so summing by vendor is a scatter-add into an array indexed by code
+//with no hashing at query time. The rows are split into blocks that run on the WorkStealingPool, each with its own partial sums, and the
+//partials are added together at the end. No row is let in whose amount would take the sum of every amount, signs dropped, past what an
+//int64_t holds, so no group total or grand total can overflow and the summing loops don't have to check.
+
+enum AnalyticsDimension { BY_VENDOR, BY_PRODUCT, BY_PURCHASE_ORDER };
+
+const size_t NUM_ANALYTICS_DIMENSIONS = 3;
+
+struct AnalyticsGroup {
+
+	string_view key; //Good until more invoices are added.
+	int64_t extendedAmount; //Fixed-point ten-thousandths.
+	uint64_t numLineItems;
+
+};
+
+
+class InvoiceAnalytics {
+
+	private:
+
+		struct KeyDictionary {
+
+			vector <string> keys;
+			unordered_map <string, uint32_t> codes;
+
+			uint32_t intern(string_view key);
+
+		};
+
+		struct LineItemColumns { //Also used on its own for one file's rows before they're merged in.
+
+			vector <int64_t> quantity;
+			vector <int64_t> unitPrice;
+			vector <int64_t> extendedAmount;
+			vector <uint32_t> keyCodes[NUM_ANALYTICS_DIMENSIONS];
+			KeyDictionary dictionaries[NUM_ANALYTICS_DIMENSIONS];
+			size_t numInvoices = 0;
+			size_t numUnpricedLineItems = 0; //IT102 or IT104 missing or not a number, or an amount too big to add up. Kept as a row with a zero amount.
+			int64_t absoluteAmountTotal = 0; //Every row's amount added up with the sign dropped. Never let past INT64_MAX (see appendColumns).
+
+		};
+
+		LineItemColumns lineItems;
+		WorkStealingPool pool;
+		size_t numFailedFiles;
+		double loadSeconds;
+
+		static void extractLineItems(const InvoiceDocumentStore& documentStore, LineItemColumns& columns);
+		void appendColumns(const LineItemColumns& part);
+
+	public:
+
+		//Constructors and destructor
+
+		InvoiceAnalytics(); //See InvoiceAnalytics.cpp for definitions. Uses one thread per core.
+
+		InvoiceAnalytics(unsigned threadCount);
+
+		~InvoiceAnalytics() {}
+
+
+		void addDocument(const InvoiceDocumentStore& documentStore); //Every ST/SE in the document adds its line items.
+
+		void addFiles(const vector <string>& files); //Parses the files across every core. Files that can't be opened are counted and skipped.
+
+		void clear();
+
+		//Every group along a dimension with its total and row count, biggest total first. topN of 0 means all of them.
+		vector <AnalyticsGroup> groupBy(AnalyticsDimension dimension, size_t topN) const;
+
+		int64_t getTotalExtendedAmount() const;
+
+		void displayReport(ostream& out, size_t topN) const;
+
+		static const char* getDimensionName(AnalyticsDimension dimension)
+		{
+			return (dimension == BY_VENDOR) ? "Vendor (N104)" : (dimension == BY_PRODUCT) ? "Product (IT109/IT107)" : "Purchase order (BIG04)";
+		}
+
+
+
+		//Accessors
+
+		size_t getNumLineItems() const
+		{
+			return lineItems.extendedAmount.size();
+		}
+
+		size_t getNumInvoices() const
+		{
+			return lineItems.numInvoices;
+		}
+
+		size_t getNumUnpricedLineItems() const
+		{
+			return lineItems.numUnpricedLineItems;
+		}
+
+		size_t getNumGroups(AnalyticsDimension dimension) const //Distinct keys seen, including a vendor or PO that only had invoices with no line items.
+		{
+			return lineItems.dictionaries[dimension].keys.size();
+		}
+
+		size_t getNumFailedFiles() const
+		{
+			return numFailedFiles;
+		}
+
+		double getLoadSeconds() const //Wall-clock time of the last addFiles.
+		{
+			return loadSeconds;
+		}
+
+};
+
+#endif
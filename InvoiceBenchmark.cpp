@@ -0,0 +1,232 @@
+#include "InvoiceBenchmark.h"
+#include <iomanip>
+#include <sstream>
+#include "InvoicePipeline.h"
+#include "ParallelTokenizer.h"
+#include "Schema.h"
+using namespace std;
+
+
+InvoiceBenchmark::InvoiceBenchmark() {
+
+	inputBytes = 0;
+	numSegments = 0;
+	numElements = 0;
+	lookupRounds = 100000;
+	renderRounds = 1;
+	parallelMatchesSerial = true;
+
+}
+
+
+
+void InvoiceBenchmark::addStage(const string& name, chrono::steady_clock::time_point startTime, const AllocationSnapshot& startAllocations, uint64_t bytesProcessed, uint64_t operations) {
+
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+	stages.push_back(BenchmarkStage{ name, seconds, bytesProcessed, operations, getAllocationsSince(startAllocations) });
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function run puts the file through every stage in the same order main does, timing each one separately. Lookups are too quick to time
+//once, so they repeat (lookupRounds) and report a rate. Rendering walks every line item in the file, so it reports MB/s like the parsing
+//stages. The checksum just keeps the compiler from deciding the lookups aren't needed.
+//
+//*******************************************************************************************************************************************
+
+void InvoiceBenchmark::run(const string& inputFileName) {
+
+	EdiInputFile invoiceInputFile;
+	EdiTokenizer invoiceTokenizer;
+	ElementIndex elementIndex;
+	InvoiceDocumentStore documentStore;
+	InvoiceLoopTree loopTree;
+	vector <ElementData> elementDataVect;
+	InvDocument* invDocumentStructureArr = nullptr;
+	int totalElementDelimiterCounter = 0;
+	int totalLineDelimiterCounter = 0;
+	chrono::steady_clock::time_point startTime;
+	AllocationSnapshot startAllocations;
+
+	stages.clear();
+	enableAllocationTracking(); //The allocation columns come from the tracked counters, which are only kept while tracking is on.
+
+	//Read
+
+	startTime = chrono::steady_clock::now();
+	startAllocations = getAllocationSnapshot();
+
+	openInvoiceInputFile(invoiceInputFile, inputFileName);
+	readInvoiceInputFile(invoiceInputFile, invoiceTokenizer, totalElementDelimiterCounter, totalLineDelimiterCounter);
+
+	inputBytes = invoiceInputFile.getSize();
+	numSegments = invoiceTokenizer.getNumSegments();
+	numElements = invoiceTokenizer.getNumElements();
+	addStage("read (map + tokenize)", startTime, startAllocations, inputBytes, 0);
+
+	//Parallel tokenize, into its own tokenizer so the serial tables above are left alone to compare against
+
+	ParallelTokenizer parallelTokenizer;
+	EdiTokenizer parallelResultTokenizer;
+
+	startTime = chrono::steady_clock::now();
+	startAllocations = getAllocationSnapshot();
+
+	parallelTokenizer.tokenize(invoiceInputFile.getContents(), parallelResultTokenizer);
+
+	addStage("tokenize (" + to_string(parallelTokenizer.getNumThreads()) + " threads, " + to_string(parallelTokenizer.getNumChunksUsed()) + " chunks)", startTime, startAllocations, inputBytes, 0);
+
+	parallelMatchesSerial = (parallelResultTokenizer.getNumSegments() == numSegments && parallelResultTokenizer.getNumElements() == numElements);
+
+	for (size_t i = 0; parallelMatchesSerial && i < numElements; i++) {
+		parallelMatchesSerial = (parallelResultTokenizer.getElement(i).offset == invoiceTokenizer.getElement(i).offset && parallelResultTokenizer.getElement(i).length == invoiceTokenizer.getElement(i).length);
+	}
+
+	//Document structure array
+
+	startTime = chrono::steady_clock::now();
+	startAllocations = getAllocationSnapshot();
+
+	invDocumentStructureArr = new InvDocument[totalLineDelimiterCounter];
+	populateInvoiceDocumentStructureArr(invDocumentStructureArr, invoiceTokenizer, totalLineDelimiterCounter);
+
+	addStage("populateInvoiceDocumentStructureArr", startTime, startAllocations, inputBytes, 0);
+
+	//Element data vector
+
+	startTime = chrono::steady_clock::now();
+	startAllocations = getAllocationSnapshot();
+
+	populateElementDataVect(elementDataVect, invoiceTokenizer);
+
+	addStage("populateElementDataVect", startTime, startAllocations, inputBytes, 0);
+
+	//Document store and element index
+
+	startTime = chrono::steady_clock::now();
+	startAllocations = getAllocationSnapshot();
+
+	documentStore.build(invoiceTokenizer);
+	elementIndex.build(invoiceTokenizer);
+
+	addStage("document store + element index", startTime, startAllocations, inputBytes, 0);
+
+	//Lazy element data: the same ElementData objects, but only for the elements the renderers actually ask for
+
+	LazyInvoiceDocument lazyDocument;
+
+	startTime = chrono::steady_clock::now();
+	startAllocations = getAllocationSnapshot();
+
+	lazyDocument.attach(invoiceTokenizer);
+
+	for (size_t i = 0; i < NUM_ELEMENT_SCHEMAS; i++) {
+		lazyDocument.findElement(elementIndex, findElementCode(elementSchemaTable[i].ref));
+	}
+
+	addStage("lazy ElementData (" + to_string(lazyDocument.getNumMaterializedElements()) + " built)", startTime, startAllocations, inputBytes, 0);
+
+	//Loop tree
+
+	startTime = chrono::steady_clock::now();
+	startAllocations = getAllocationSnapshot();
+
+	loopTree.build(documentStore);
+
+	addStage("loop tree", startTime, startAllocations, inputBytes, 0);
+
+	//Lookups. Codes are worked out before the clock starts, the way the renderers have theirs worked out by the compiler.
+
+	size_t checksum = 0;
+	ElementCode schemaElementCodes[NUM_ELEMENT_SCHEMAS];
+
+	for (size_t i = 0; i < NUM_ELEMENT_SCHEMAS; i++) {
+		schemaElementCodes[i] = findElementCode(elementSchemaTable[i].ref);
+	}
+
+	startTime = chrono::steady_clock::now();
+	startAllocations = getAllocationSnapshot();
+
+	for (uint64_t round = 0; round < lookupRounds; round++) {
+
+		for (size_t i = 0; i < NUM_ELEMENT_SCHEMAS; i++) {
+			checksum += lookupElementStrValue(documentStore, elementIndex, schemaElementCodes[i]).length();
+		}
+
+	}
+
+	addStage("lookup", startTime, startAllocations, 0, lookupRounds * NUM_ELEMENT_SCHEMAS);
+
+	//Render
+
+	RenderBuffer renderedInvoice;
+
+	startTime = chrono::steady_clock::now();
+	startAllocations = getAllocationSnapshot();
+
+	for (uint64_t round = 0; round < renderRounds; round++) {
+
+		renderedInvoice.clear();
+		appendInvoiceForHumans(documentStore, elementIndex, loopTree, renderedInvoice);
+		checksum += renderedInvoice.getSize();
+
+	}
+
+	addStage("render", startTime, startAllocations, inputBytes * renderRounds, renderRounds);
+
+	delete[] invDocumentStructureArr;
+	invDocumentStructureArr = nullptr;
+
+	closeInvoiceInputFile(invoiceInputFile);
+
+	if (checksum == 0) {
+		cout << "(Nothing was found during the lookup and render stages.)" << endl;
+	}
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function displayResults prints one line per stage: time, throughput (MB/s for stages that go through the input, operations/s for the
+//repeating ones), and heap allocations.
+//
+//*******************************************************************************************************************************************
+
+void InvoiceBenchmark::displayResults(ostream& out) const {
+
+	out << "Input: " << inputBytes << " bytes, " << numSegments << " segments, " << numElements << " elements" << endl << endl;
+
+	out << left << setw(38) << "Stage" << right << setw(12) << "Seconds" << setw(20) << "Throughput" << setw(14) << "Allocations" << setw(14) << "Alloc MB" << endl;
+	out << "--------------------------------------------------------------------------------------------------" << endl;
+
+	for (const BenchmarkStage& stage : stages) {
+
+		double seconds = (stage.seconds > 0.0) ? stage.seconds : 1e-9;
+		ostringstream throughput;
+
+		if (stage.bytesProcessed > 0) {
+			throughput << fixed << setprecision(1) << stage.bytesProcessed / (1024.0 * 1024.0) / seconds << " MB/s";
+		}
+
+		else {
+			throughput << fixed << setprecision(0) << stage.operations / seconds << " ops/s";
+		}
+
+		out << left << setw(38) << stage.name << right << fixed << setprecision(4) << setw(12) << stage.seconds << setw(20) << throughput.str();
+		out << setw(14) << stage.allocations.allocations << setw(14) << setprecision(2) << stage.allocations.bytesAllocated / (1024.0 * 1024.0) << endl;
+
+	}
+
+	if (!parallelMatchesSerial) {
+		out << endl << "WARNING: the parallel tokenizer's element table doesn't match the serial one." << endl;
+	}
+
+	out << endl << "Peak RSS: " << fixed << setprecision(1) << getPeakResidentBytes() / (1024.0 * 1024.0) << " MB" << endl;
+
+}
@@ -0,0 +1,81 @@
+#ifndef INVOICEBENCHMARK_H
+#define INVOICEBENCHMARK_H
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "MemoryStats.h"
+using namespace std;
+
+
+//The InvoiceBenchmark class times each stage of the pipeline on its own against one input file (normally one made by
+//SyntheticInvoiceGenerator): read (map + tokenize), tokenizing again on every core with ParallelTokenizer, populateInvoiceDocumentStructureArr,
+//populateElementDataVect, building the document store and element index, LazyInvoiceDocument building only the ElementData the schema
+//names, the loop tree, element lookups, and rendering. For every stage it keeps the wall-clock time, the throughput, and how many heap
+//allocations the stage made; the peak resident set size of the whole run is reported at the end.
+
+struct BenchmarkStage {
+
+	string name;
+	double seconds;
+	uint64_t bytesProcessed; //For stages that work through the input; 0 otherwise.
+	uint64_t operations; //Lookups or renders for the stages that repeat; 0 otherwise.
+	AllocationSnapshot allocations;
+
+};
+
+
+class InvoiceBenchmark {
+
+	private:
+
+		vector <BenchmarkStage> stages;
+		uint64_t inputBytes;
+		size_t numSegments;
+		size_t numElements;
+		uint64_t lookupRounds;
+		uint64_t renderRounds;
+		bool parallelMatchesSerial; //Whether the parallel tokenize came out element-for-element the same as the serial one.
+
+		void addStage(const string& name, chrono::steady_clock::time_point startTime, const AllocationSnapshot& startAllocations, uint64_t bytesProcessed, uint64_t operations);
+
+	public:
+
+		//Constructors and destructor
+
+		InvoiceBenchmark(); //See InvoiceBenchmark.cpp for definitions
+
+		~InvoiceBenchmark() {}
+
+
+		void run(const string& inputFileName); //Throws a string if the file can't be opened.
+
+		void displayResults(ostream& out) const;
+
+
+
+		//Mutators
+
+		void setLookupRounds(uint64_t rounds) //Each round looks up every element ref in Schema.h once.
+		{
+			lookupRounds = rounds;
+		}
+
+		void setRenderRounds(uint64_t rounds)
+		{
+			renderRounds = rounds;
+		}
+
+
+		//Accessors
+
+		const vector <BenchmarkStage>& getStages() const
+		{
+			return stages;
+		}
+
+};
+
+#endif
@@ -0,0 +1,276 @@
+#include "InvoiceCacheFile.h"
+#include <cstring>
+#include "EdiValueDecoder.h"
+#include "ElementCode.h"
+#include <fstream>
+#include <vector>
+using namespace std;
+
+
+const uint64_t CACHE_SECTION_ALIGNMENT = 8;
+
+
+uint64_t InvoiceCacheFile::getSectionBytes(CacheSection section, uint64_t textBytes, uint64_t numSegments, uint64_t numElements) {
+
+	switch (section) {
+
+	case CACHE_TEXT:
+		return textBytes;
+
+	case CACHE_SEGMENT_OFFSET:
+		return numSegments * sizeof(uint64_t);
+
+	case CACHE_SEGMENT_LENGTH:
+	case CACHE_SEGMENT_FIRST_ELEMENT:
+		return numSegments * sizeof(uint32_t);
+
+	case CACHE_SEGMENT_NUM_ELEMENTS:
+		return numSegments * sizeof(uint16_t);
+
+	case CACHE_SEGMENT_CODE:
+		return numSegments * sizeof(uint8_t);
+
+	case CACHE_ELEMENT_OFFSET:
+	case CACHE_ELEMENT_LENGTH:
+	case CACHE_ELEMENT_SEGMENT:
+		return numElements * sizeof(uint32_t);
+
+	case CACHE_ELEMENT_POSITION:
+	case CACHE_ELEMENT_DATA_TYPE:
+		return numElements * sizeof(uint8_t);
+
+	case CACHE_ELEMENT_DECODED_VALUE:
+		return numElements * sizeof(int64_t);
+
+	default:
+		return 0;
+
+	}
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function write saves the store's columns as-is. The header is written twice: once as a placeholder, then again at the end once every
+//section's offset is known.
+//
+//*******************************************************************************************************************************************
+
+void InvoiceCacheFile::write(const InvoiceDocumentStore& documentStore, const string& path) {
+
+	ofstream cacheFile(path, ios::out | ios::binary | ios::trunc);
+	InvoiceCacheHeader header{};
+	const char padding[CACHE_SECTION_ALIGNMENT] = {};
+	string_view text = documentStore.getBuffer();
+
+	if (!cacheFile) {
+		throw string("ERROR. Cannot create cache file " + path + ".\n");
+	}
+
+	const void* sectionData[NUM_CACHE_SECTIONS] = {
+		text.data(), documentStore.segmentOffset, documentStore.segmentLength, documentStore.segmentFirstElement, documentStore.segmentNumElements,
+		documentStore.segmentCode, documentStore.elementOffset, documentStore.elementLength, documentStore.elementSegment,
+		documentStore.elementPosition, documentStore.elementDecodedValue, documentStore.elementDataType
+	};
+
+	memcpy(header.magic, INVOICE_CACHE_MAGIC, sizeof(header.magic));
+	header.version = INVOICE_CACHE_VERSION;
+	header.byteOrderMark = INVOICE_CACHE_BYTE_ORDER_MARK;
+	header.textBytes = text.size();
+	header.numSegments = documentStore.numSegments;
+	header.numElements = documentStore.numElements;
+
+	cacheFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	uint64_t fileOffset = sizeof(header);
+
+	for (int section = 0; section < NUM_CACHE_SECTIONS; section++) {
+
+		uint64_t sectionBytes = getSectionBytes(static_cast<CacheSection>(section), header.textBytes, header.numSegments, header.numElements);
+		uint64_t paddingBytes = (CACHE_SECTION_ALIGNMENT - fileOffset % CACHE_SECTION_ALIGNMENT) % CACHE_SECTION_ALIGNMENT;
+
+		cacheFile.write(padding, paddingBytes);
+		fileOffset += paddingBytes;
+
+		header.sectionOffset[section] = fileOffset;
+
+		if (sectionBytes > 0) {
+			cacheFile.write(static_cast<const char*>(sectionData[section]), sectionBytes);
+		}
+
+		fileOffset += sectionBytes;
+
+	}
+
+	header.fileBytes = fileOffset;
+
+	cacheFile.seekp(0);
+	cacheFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	cacheFile.close();
+
+	if (cacheFile.fail()) {
+		throw string("ERROR. Could not finish writing cache file " + path + ".\n");
+	}
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function open maps a cache file and points the store's columns into it. Every section is checked to be inside the file and aligned before
+//anything is pointed at it, so a truncated or foreign file is turned away with a message instead of being read past its end. The column
+//contents themselves aren't rescanned (that would cost as much as parsing); they're trusted the same way the program trusts its own files.
+//
+//*******************************************************************************************************************************************
+
+void InvoiceCacheFile::open(const string& path, InvoiceDocumentStore& documentStore) {
+
+	InvoiceCacheHeader header;
+
+	close();
+	mappedFile.open(path);
+
+	string_view contents = mappedFile.getContents();
+
+	if (contents.size() < sizeof(header)) {
+		close();
+		throw string("ERROR. " + path + " is too small to be an invoice cache file.\n");
+	}
+
+	contents.copy(reinterpret_cast<char*>(&header), sizeof(header));
+
+	if (memcmp(header.magic, INVOICE_CACHE_MAGIC, sizeof(header.magic)) != 0) {
+		close();
+		throw string("ERROR. " + path + " is not an invoice cache file.\n");
+	}
+
+	if (header.version != INVOICE_CACHE_VERSION || header.byteOrderMark != INVOICE_CACHE_BYTE_ORDER_MARK) {
+		close();
+		throw string("ERROR. " + path + " was written by a different version of this program (or on a different kind of machine). Re-create it from the .dat file.\n");
+	}
+
+	if (header.fileBytes != contents.size() || header.numSegments > contents.size() || header.numElements > contents.size()) {
+		close();
+		throw string("ERROR. " + path + " is damaged.\n");
+	}
+
+	for (int section = 0; section < NUM_CACHE_SECTIONS; section++) {
+
+		uint64_t sectionBytes = getSectionBytes(static_cast<CacheSection>(section), header.textBytes, header.numSegments, header.numElements);
+
+		if (header.sectionOffset[section] % CACHE_SECTION_ALIGNMENT != 0 || header.sectionOffset[section] > contents.size() || sectionBytes > contents.size() - header.sectionOffset[section]) {
+			close();
+			throw string("ERROR. " + path + " is damaged.\n");
+		}
+
+	}
+
+	const char* base = contents.data();
+
+	//The mapping is read-only and the store never writes to its columns outside of build(), which allocates fresh ones first.
+
+	documentStore.reset();
+	documentStore.buffer = string_view(base + header.sectionOffset[CACHE_TEXT], header.textBytes);
+	documentStore.numSegments = header.numSegments;
+	documentStore.numElements = header.numElements;
+
+	documentStore.segmentOffset = const_cast<uint64_t*>(reinterpret_cast<const uint64_t*>(base + header.sectionOffset[CACHE_SEGMENT_OFFSET]));
+	documentStore.segmentLength = const_cast<uint32_t*>(reinterpret_cast<const uint32_t*>(base + header.sectionOffset[CACHE_SEGMENT_LENGTH]));
+	documentStore.segmentFirstElement = const_cast<uint32_t*>(reinterpret_cast<const uint32_t*>(base + header.sectionOffset[CACHE_SEGMENT_FIRST_ELEMENT]));
+	documentStore.segmentNumElements = const_cast<uint16_t*>(reinterpret_cast<const uint16_t*>(base + header.sectionOffset[CACHE_SEGMENT_NUM_ELEMENTS]));
+	documentStore.segmentCode = const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(base + header.sectionOffset[CACHE_SEGMENT_CODE]));
+
+	documentStore.elementOffset = const_cast<uint32_t*>(reinterpret_cast<const uint32_t*>(base + header.sectionOffset[CACHE_ELEMENT_OFFSET]));
+	documentStore.elementLength = const_cast<uint32_t*>(reinterpret_cast<const uint32_t*>(base + header.sectionOffset[CACHE_ELEMENT_LENGTH]));
+	documentStore.elementSegment = const_cast<uint32_t*>(reinterpret_cast<const uint32_t*>(base + header.sectionOffset[CACHE_ELEMENT_SEGMENT]));
+	documentStore.elementPosition = const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(base + header.sectionOffset[CACHE_ELEMENT_POSITION]));
+	documentStore.elementDecodedValue = const_cast<int64_t*>(reinterpret_cast<const int64_t*>(base + header.sectionOffset[CACHE_ELEMENT_DECODED_VALUE]));
+	documentStore.elementDataType = const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(base + header.sectionOffset[CACHE_ELEMENT_DATA_TYPE]));
+
+	if (!areColumnsInRange(documentStore)) {
+		documentStore.reset();
+		close();
+		throw string("ERROR. " + path + " is damaged.\n");
+	}
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function areColumnsInRange checks everything the store's accessors use as an offset or an index, once, so nothing read from the file can
+//send them outside the text or the tables later: every segment lies inside the text, the segments' runs of the element table follow one
+//another and cover it exactly, every element belongs to the segment whose run it's in and lies inside that segment's text, and the codes
+//and types are ones the program knows.
+//
+//*******************************************************************************************************************************************
+
+bool InvoiceCacheFile::areColumnsInRange(const InvoiceDocumentStore& documentStore) {
+
+	uint64_t textBytes = documentStore.buffer.size();
+	uint64_t numElements = documentStore.numElements;
+	uint64_t nextFirstElement = 0; //The runs have to follow one another with no gaps or overlaps, the way build() lays them out.
+
+	for (size_t i = 0; i < documentStore.numSegments; i++) {
+
+		if (documentStore.segmentOffset[i] > textBytes || documentStore.segmentLength[i] > textBytes - documentStore.segmentOffset[i]) {
+			return false;
+		}
+
+		if (documentStore.segmentNumElements[i] == 0 || documentStore.segmentFirstElement[i] != nextFirstElement || documentStore.segmentNumElements[i] > numElements - nextFirstElement) {
+			return false;
+		}
+
+		nextFirstElement += documentStore.segmentNumElements[i];
+
+		if (documentStore.segmentCode[i] >= NUM_SEGMENT_CODES && documentStore.segmentCode[i] != SEGMENT_CODE_UNKNOWN) {
+			return false;
+		}
+
+	}
+
+	if (nextFirstElement != numElements) {
+		return false;
+	}
+
+	for (size_t i = 0; i < numElements; i++) {
+
+		uint32_t segmentIndex = documentStore.elementSegment[i];
+
+		if (segmentIndex >= documentStore.numSegments || i < documentStore.segmentFirstElement[segmentIndex] || i - documentStore.segmentFirstElement[segmentIndex] != documentStore.elementPosition[i]) {
+			return false;
+		}
+
+		if (documentStore.elementPosition[i] >= documentStore.segmentNumElements[segmentIndex]) {
+			return false;
+		}
+
+		uint64_t segmentLength = documentStore.segmentLength[segmentIndex];
+
+		if (documentStore.elementOffset[i] > segmentLength || documentStore.elementLength[i] > segmentLength - documentStore.elementOffset[i]) {
+			return false;
+		}
+
+		if (documentStore.elementDataType[i] > TYPE_UNKNOWN) {
+			return false;
+		}
+
+	}
+
+	return true;
+
+}
+
+
+
+void InvoiceCacheFile::close() {
+
+	if (mappedFile.isOpen()) {
+		mappedFile.close();
+	}
+
+}
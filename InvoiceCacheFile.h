@@ -0,0 +1,96 @@
+#ifndef INVOICECACHEFILE_H
+#define INVOICECACHEFILE_H
+
+#include <cstdint>
+#include <string>
+#include "EdiInputFile.h"
+#include "InvoiceDocumentStore.h"
+using namespace std;
+
+
+//The InvoiceCacheFile class saves a parsed invoice (an InvoiceDocumentStore) to a binary file and maps it back in later. The file holds the
+//original text plus every column of the segment and element tables, decoded values included, each starting on an 8-byte boundary. Opening
+//one is a memory map, a header check, and one pass over the columns to make sure every offset, length and index in them stays inside the
+//file and the tables: the store's columns point straight into the mapping, so nothing is tokenized, decoded, or even copied, and a damaged
+//or hand-edited file is turned away instead of read out of bounds.
+//
+//Layout: an InvoiceCacheHeader, then the sections in CacheSection order. The header records the format version and a byte-order mark, and
+//every section's offset; the reader refuses anything it can't trust rather than guessing. Bump INVOICE_CACHE_VERSION whenever the column
+//layout or the meaning of a decoded value changes.
+
+const char INVOICE_CACHE_MAGIC[8] = { 'E', 'D', 'I', '8', '1', '0', 'C', 'F' };
+const uint32_t INVOICE_CACHE_VERSION = 2; //2: segment codes are ElementCode.h's 8-bit ones, with no table of ID names.
+const uint32_t INVOICE_CACHE_BYTE_ORDER_MARK = 0x01020304;
+
+enum CacheSection {
+
+	CACHE_TEXT,
+	CACHE_SEGMENT_OFFSET,
+	CACHE_SEGMENT_LENGTH,
+	CACHE_SEGMENT_FIRST_ELEMENT,
+	CACHE_SEGMENT_NUM_ELEMENTS,
+	CACHE_SEGMENT_CODE,
+	CACHE_ELEMENT_OFFSET,
+	CACHE_ELEMENT_LENGTH,
+	CACHE_ELEMENT_SEGMENT,
+	CACHE_ELEMENT_POSITION,
+	CACHE_ELEMENT_DECODED_VALUE,
+	CACHE_ELEMENT_DATA_TYPE,
+	NUM_CACHE_SECTIONS
+
+};
+
+struct InvoiceCacheHeader {
+
+	char magic[8];
+	uint32_t version;
+	uint32_t byteOrderMark;
+	uint64_t fileBytes;
+	uint64_t textBytes;
+	uint64_t numSegments;
+	uint64_t numElements;
+	uint64_t sectionOffset[NUM_CACHE_SECTIONS];
+
+};
+
+
+class InvoiceCacheFile {
+
+	private:
+
+		EdiInputFile mappedFile;
+
+		static uint64_t getSectionBytes(CacheSection section, uint64_t textBytes, uint64_t numSegments, uint64_t numElements);
+
+		static bool areColumnsInRange(const InvoiceDocumentStore& documentStore);
+
+	public:
+
+		//Constructors and destructor
+
+		InvoiceCacheFile() {}
+
+		~InvoiceCacheFile() {}
+
+		InvoiceCacheFile(const InvoiceCacheFile&) = delete;
+		InvoiceCacheFile& operator=(const InvoiceCacheFile&) = delete;
+
+
+		static void write(const InvoiceDocumentStore& documentStore, const string& path); //Throws a string if the file can't be written.
+
+		void open(const string& path, InvoiceDocumentStore& documentStore); //Throws a string if the file is missing, damaged, or the wrong version.
+
+		void close(); //The store must not be used after this (it points into the mapping) until it's rebuilt.
+
+
+
+		//Accessors
+
+		bool isOpen() const
+		{
+			return mappedFile.isOpen();
+		}
+
+};
+
+#endif
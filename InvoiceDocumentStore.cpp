@@ -0,0 +1,151 @@
+#include "InvoiceDocumentStore.h"
+#include <cstdint>
+#include "Schema.h"
+#include "PipelineStats.h"
+using namespace std;
+
+
+const size_t MAX_STORE_SEGMENT_ELEMENTS = UINT8_MAX + 1; //elementPosition is a uint8_t, so element 00 through 255.
+
+
+InvoiceDocumentStore::InvoiceDocumentStore() {
+
+	numSegments = 0;
+	numElements = 0;
+
+	segmentOffset = nullptr;
+	segmentLength = nullptr;
+	segmentFirstElement = nullptr;
+	segmentNumElements = nullptr;
+	segmentCode = nullptr;
+
+	elementOffset = nullptr;
+	elementLength = nullptr;
+	elementSegment = nullptr;
+	elementPosition = nullptr;
+	elementDecodedValue = nullptr;
+	elementDataType = nullptr;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function build copies the tokenizer's spans into the arena-backed columns. Every array is sized exactly up front, so there's one arena
+//allocation per column and none per segment or element. Each element's schema entry is looked up by its ref ("TDS01") through the perfect
+//hash in Schema.h, and typed values are decoded right here in the same pass. The columns are narrower than the tokenizer's spans, so
+//anything that wouldn't fit them (more than 4 GB of segments or elements in one document, a segment over 4 GB long, or more than 256
+//elements in one segment) throws a string before anything is written; element offsets and lengths fit once their segment's length does.
+//
+//*******************************************************************************************************************************************
+
+void InvoiceDocumentStore::build(const EdiTokenizer& invoiceTokenizer) {
+
+	StageSpan span(STAGE_BUILD_DOCUMENT_STORE);
+
+	reset();
+
+	if (invoiceTokenizer.getNumSegments() > UINT32_MAX || invoiceTokenizer.getNumElements() > UINT32_MAX) {
+		throw string("ERROR. The document has too many segments or elements to store.\n");
+	}
+
+	for (size_t i = 0; i < invoiceTokenizer.getNumSegments(); i++) {
+
+		const SegmentSpan& segment = invoiceTokenizer.getSegment(i);
+
+		if (segment.length > UINT32_MAX) {
+			throw string("ERROR. Segment " + to_string(i + 1) + " is too long to store.\n");
+		}
+
+		if (static_cast<size_t>(segment.numElements) > MAX_STORE_SEGMENT_ELEMENTS) {
+			throw string("ERROR. Segment " + to_string(i + 1) + " has " + to_string(segment.numElements) + " elements; no more than " + to_string(MAX_STORE_SEGMENT_ELEMENTS) + " can be stored.\n");
+		}
+
+	}
+
+	buffer = invoiceTokenizer.getBuffer();
+	numSegments = invoiceTokenizer.getNumSegments();
+	numElements = invoiceTokenizer.getNumElements();
+
+	segmentOffset = arena.allocateArray<uint64_t>(numSegments);
+	segmentLength = arena.allocateArray<uint32_t>(numSegments);
+	segmentFirstElement = arena.allocateArray<uint32_t>(numSegments);
+	segmentNumElements = arena.allocateArray<uint16_t>(numSegments);
+	segmentCode = arena.allocateArray<uint8_t>(numSegments);
+
+	elementOffset = arena.allocateArray<uint32_t>(numElements);
+	elementLength = arena.allocateArray<uint32_t>(numElements);
+	elementSegment = arena.allocateArray<uint32_t>(numElements);
+	elementPosition = arena.allocateArray<uint8_t>(numElements);
+	elementDecodedValue = arena.allocateArray<int64_t>(numElements);
+	elementDataType = arena.allocateArray<uint8_t>(numElements);
+
+	for (size_t i = 0; i < numSegments; i++) {
+
+		const SegmentSpan& segment = invoiceTokenizer.getSegment(i);
+		string_view segmentID = invoiceTokenizer.getSegmentID(i);
+		char elementRef[8] = {};
+		size_t idLength = (segmentID.length() < 5) ? segmentID.length() : 5;
+
+		segmentOffset[i] = segment.offset;
+		segmentLength[i] = static_cast<uint32_t>(segment.length);
+		segmentFirstElement[i] = static_cast<uint32_t>(segment.firstElement);
+		segmentNumElements[i] = static_cast<uint16_t>(segment.numElements);
+		segmentCode[i] = findSegmentCode(segmentID);
+		segmentID.copy(elementRef, idLength);
+
+		for (int j = 0; j < segment.numElements; j++) {
+
+			const ElementSpan& element = invoiceTokenizer.getElement(segment.firstElement + j);
+			size_t elementIndex = segment.firstElement + j;
+			const Segment* elementSchema = nullptr;
+			EdiDataType type = TYPE_UNKNOWN;
+
+			if (j > 0 && j < 100) {
+				elementRef[idLength] = static_cast<char>('0' + j / 10);
+				elementRef[idLength + 1] = static_cast<char>('0' + j % 10);
+				elementSchema = findElementSchema(string_view(elementRef, idLength + 2));
+			}
+
+			if (elementSchema != nullptr) {
+				type = getEdiDataType(elementSchema->type);
+			}
+
+			elementDecodedValue[elementIndex] = 0;
+
+			if ((type == TYPE_R || type == TYPE_N0 || type == TYPE_N2 || type == TYPE_DT) && !decodeTypedValue(invoiceTokenizer.getElementText(elementIndex), type, elementDecodedValue[elementIndex])) {
+				type = TYPE_UNKNOWN;
+			}
+
+			elementDataType[elementIndex] = static_cast<uint8_t>(type);
+
+			elementOffset[elementIndex] = static_cast<uint32_t>(element.offset - segment.offset);
+			elementLength[elementIndex] = static_cast<uint32_t>(element.length);
+			elementSegment[elementIndex] = static_cast<uint32_t>(i);
+			elementPosition[elementIndex] = static_cast<uint8_t>(j);
+
+		}
+
+	}
+
+	span.addWork(buffer.size(), numSegments, numElements);
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function reset frees the whole document at once.
+//
+//*******************************************************************************************************************************************
+
+void InvoiceDocumentStore::reset() {
+
+	arena.reset();
+	buffer = string_view();
+	numSegments = 0;
+	numElements = 0;
+
+}
@@ -0,0 +1,174 @@
+#ifndef INVOICEDOCUMENTSTORE_H
+#define INVOICEDOCUMENTSTORE_H
+
+#include <cstdint>
+#include <string_view>
+#include "DocumentArena.h"
+#include "ElementCode.h"
+#include "EdiTokenizer.h"
+#include "EdiValueDecoder.h"
+using namespace std;
+
+
+//The InvoiceDocumentStore class is the compact, column-by-column version of what InvDocument and ElementData hold. There's a segment table
+//and an element table, each stored as parallel arrays in a DocumentArena, and the text itself stays in the input buffer. Each segment
+//carries its segment code from ElementCode.h instead of its own string (the ID text is still there as the segment's element 00), so an
+//element's ElementCode is just its segment's code plus its position. Throwing a document away is a single arena reset. Typed elements (R, N0, N2, DT in Schema.h) are decoded once while the store is
+//built, so amounts and dates are sitting in a column as integers by the time anything reads them.
+
+class InvoiceDocumentStore {
+
+	private:
+
+		DocumentArena arena;
+		string_view buffer;
+		size_t numSegments;
+		size_t numElements;
+
+		//Segment table
+		uint64_t* segmentOffset;
+		uint32_t* segmentLength;
+		uint32_t* segmentFirstElement;
+		uint16_t* segmentNumElements;
+		uint8_t* segmentCode; //findSegmentCode of the segment ID; SEGMENT_CODE_UNKNOWN for IDs outside the interned table.
+
+		//Element table. Offsets are relative to the start of the element's segment, which keeps them to 32 bits even in huge files.
+		uint32_t* elementOffset;
+		uint32_t* elementLength;
+		uint32_t* elementSegment;
+		uint8_t* elementPosition;
+		int64_t* elementDecodedValue; //Fixed-point ten-thousandths for R/N0/N2, CCYYMMDD for DT. Only meaningful where elementDataType says so.
+		uint8_t* elementDataType; //EdiDataType from the schema, or TYPE_UNKNOWN if there's no schema entry or the value didn't decode.
+
+		friend class InvoiceCacheFile; //Saves the columns and points them into a mapped cache file.
+
+	public:
+
+		//Constructors and destructor
+
+		InvoiceDocumentStore(); //See InvoiceDocumentStore.cpp for definitions
+
+		~InvoiceDocumentStore() {}
+
+		InvoiceDocumentStore(const InvoiceDocumentStore&) = delete;
+		InvoiceDocumentStore& operator=(const InvoiceDocumentStore&) = delete;
+
+
+		void build(const EdiTokenizer& invoiceTokenizer); //Replaces whatever document was there before. Throws a string if the document won't fit the columns.
+
+		void reset();
+
+
+
+		//Accessors
+
+		string_view getBuffer() const
+		{
+			return buffer;
+		}
+
+		size_t getNumSegments() const
+		{
+			return numSegments;
+		}
+
+		size_t getNumElements() const
+		{
+			return numElements;
+		}
+
+		uint8_t getSegmentCode(size_t segmentIndex) const
+		{
+			return segmentCode[segmentIndex];
+		}
+
+		string_view getSegmentID(size_t segmentIndex) const //Element 00, so it's there even for segments with no interned code.
+		{
+			return getElementText(segmentFirstElement[segmentIndex]);
+		}
+
+		string_view getSegmentText(size_t segmentIndex) const
+		{
+			return buffer.substr(segmentOffset[segmentIndex], segmentLength[segmentIndex]);
+		}
+
+		size_t getSegmentFirstElement(size_t segmentIndex) const
+		{
+			return segmentFirstElement[segmentIndex];
+		}
+
+		int getSegmentNumElements(size_t segmentIndex) const
+		{
+			return segmentNumElements[segmentIndex];
+		}
+
+		size_t getElementSegment(size_t elementIndex) const
+		{
+			return elementSegment[elementIndex];
+		}
+
+		int getElementPosition(size_t elementIndex) const
+		{
+			return elementPosition[elementIndex];
+		}
+
+		ElementCode getElementCode(size_t elementIndex) const //ELEMENT_CODE_UNKNOWN if its segment has no interned code.
+		{
+			return makeElementCode(segmentCode[elementSegment[elementIndex]], elementPosition[elementIndex]);
+		}
+
+		string_view getElementText(size_t elementIndex) const
+		{
+			return buffer.substr(segmentOffset[elementSegment[elementIndex]] + elementOffset[elementIndex], elementLength[elementIndex]);
+		}
+
+		string_view getElementValue(size_t elementIndex) const //"NULL" for empty elements, same as everywhere else.
+		{
+			return (elementLength[elementIndex] == 0) ? string_view("NULL") : getElementText(elementIndex);
+		}
+
+		EdiDataType getElementDataType(size_t elementIndex) const
+		{
+			return static_cast<EdiDataType>(elementDataType[elementIndex]);
+		}
+
+		bool getElementFixedPoint(size_t elementIndex, int64_t& scaledValue) const //False unless the element is an R/N0/N2 that decoded.
+		{
+			EdiDataType type = getElementDataType(elementIndex);
+
+			if (type != TYPE_R && type != TYPE_N0 && type != TYPE_N2) {
+				return false;
+			}
+
+			scaledValue = elementDecodedValue[elementIndex];
+			return true;
+		}
+
+		bool getElementDate(size_t elementIndex, uint32_t& packedDate) const
+		{
+			if (getElementDataType(elementIndex) != TYPE_DT) {
+				return false;
+			}
+
+			packedDate = static_cast<uint32_t>(elementDecodedValue[elementIndex]);
+			return true;
+		}
+
+		size_t getBytesInUse() const
+		{
+			return arena.getBytesInUse();
+		}
+
+		size_t getPeakBytes() const
+		{
+			return arena.getPeakBytes();
+		}
+
+		static size_t getBytesPerElement() //Element table cost only; segment table cost is per segment.
+		{
+			return sizeof(uint32_t) * 3 + sizeof(uint8_t) * 2 + sizeof(int64_t);
+		}
+
+};
+
+#endif
@@ -0,0 +1,155 @@
+#include "InvoiceLoopTree.h"
+#include "PipelineStats.h"
+using namespace std;
+
+
+void InvoiceLoopTree::reset() {
+
+	loops.clear();
+	lastChild.clear();
+	openLoops.clear();
+	partyLoops.clear();
+	lineItemLoops.clear();
+	summaryAllowanceLoops.clear();
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function openLoop starts a loop at segmentIndex, nested inside the innermost open loop if there is one, and files it under parties, line
+//items, or summary allowances if it's one of those.
+//
+//*******************************************************************************************************************************************
+
+void InvoiceLoopTree::openLoop(string_view loopID, DocLocation area, uint32_t segmentIndex, const InvoiceDocumentStore& documentStore) {
+
+	uint32_t loopIndex = static_cast<uint32_t>(loops.size());
+	uint32_t parent = openLoops.empty() ? NO_LOOP : openLoops.back();
+
+	loops.push_back(LoopNode{ loopID, area, segmentIndex, segmentIndex, static_cast<uint32_t>(documentStore.getSegmentFirstElement(segmentIndex)), 0, parent, NO_LOOP, NO_LOOP });
+	lastChild.push_back(NO_LOOP);
+
+	if (parent != NO_LOOP) {
+
+		if (lastChild[parent] == NO_LOOP) {
+			loops[parent].firstChild = loopIndex;
+		}
+
+		else {
+			loops[lastChild[parent]].nextSibling = loopIndex;
+		}
+
+		lastChild[parent] = loopIndex;
+
+	}
+
+	else if (area == HEADING && loopID == "N1") {
+		partyLoops.push_back(loopIndex);
+	}
+
+	else if (area == DETAIL && loopID == "IT1") {
+		lineItemLoops.push_back(loopIndex);
+	}
+
+	else if (area == SUMMARY && loopID == "SAC") {
+		summaryAllowanceLoops.push_back(loopIndex);
+	}
+
+	openLoops.push_back(loopIndex);
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function closeLoopsFrom ends every open loop from stackPosition up (the innermost ones) just before segmentIndex.
+//
+//*******************************************************************************************************************************************
+
+void InvoiceLoopTree::closeLoopsFrom(size_t stackPosition, uint32_t segmentIndex, const InvoiceDocumentStore& documentStore) {
+
+	uint32_t endElement = (segmentIndex < documentStore.getNumSegments()) ? static_cast<uint32_t>(documentStore.getSegmentFirstElement(segmentIndex)) : static_cast<uint32_t>(documentStore.getNumElements());
+
+	for (size_t i = stackPosition; i < openLoops.size(); i++) {
+
+		loops[openLoops[i]].endSegment = segmentIndex;
+		loops[openLoops[i]].endElement = endElement;
+
+	}
+
+	openLoops.resize(stackPosition < openLoops.size() ? stackPosition : openLoops.size());
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function build makes one pass over the segments. The open loops are kept as a stack (innermost last); they're never more than a couple
+//deep, so finding a loop ID in it is a short scan from the top.
+//
+//*******************************************************************************************************************************************
+
+void InvoiceLoopTree::build(const InvoiceDocumentStore& documentStore) {
+
+	StageSpan span(STAGE_BUILD_LOOP_TREE);
+	DocLocation currentArea = HEADING;
+	uint32_t numSegments = static_cast<uint32_t>(documentStore.getNumSegments());
+
+	reset();
+
+	for (uint32_t i = 0; i < numSegments; i++) {
+
+		const Invoice* segmentSchema = findSegmentSchemaInArea(documentStore.getSegmentID(i), currentArea);
+
+		if (segmentSchema == nullptr) {
+			continue;
+		}
+
+		if (segmentSchema->placement != currentArea) {
+
+			closeLoopsFrom(0, i, documentStore);
+
+			if (segmentSchema->placement > currentArea) {
+				currentArea = segmentSchema->placement;
+			}
+
+		}
+
+		if (segmentSchema->loopID == "None") {
+			closeLoopsFrom(0, i, documentStore);
+			continue;
+		}
+
+		size_t stackPosition = openLoops.size();
+
+		while (stackPosition > 0 && loops[openLoops[stackPosition - 1]].loopID != segmentSchema->loopID) {
+			stackPosition--;
+		}
+
+		if (segmentSchema->loopID == segmentSchema->id) {
+
+			if (stackPosition > 0) { //Same loop already open: close it (and anything inside it) so this one becomes its sibling.
+				closeLoopsFrom(stackPosition - 1, i, documentStore);
+			}
+
+			openLoop(segmentSchema->loopID, segmentSchema->placement, i, documentStore);
+
+		}
+
+		else {
+
+			closeLoopsFrom(stackPosition, i, documentStore); //Belongs to that loop, so anything nested deeper is finished. With no such loop open, everything closes.
+
+		}
+
+	}
+
+	closeLoopsFrom(0, numSegments, documentStore);
+	lastChild.clear();
+	span.addWork(0, numSegments, 0);
+
+}
@@ -0,0 +1,97 @@
+#ifndef INVOICELOOPTREE_H
+#define INVOICELOOPTREE_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "InvoiceDocumentStore.h"
+#include "Schema.h"
+using namespace std;
+
+
+//The InvoiceLoopTree class works out the loop structure of a document using the loopID field in Schema.h: the N1 party loops in the
+//heading, the IT1 line item loops in the detail area (with their IT3 and SAC segments underneath), and the SAC allowance/charge loops in
+//the summary. Each loop is just a range of segment indexes and element indexes into the InvoiceDocumentStore, so nothing is copied, and
+//the line items (or parties, or summary allowances) can be walked in order without searching for anything.
+//
+//A segment whose loopID matches its own ID starts a loop. If a loop with the same ID is already open, the new one is its sibling;
+//otherwise it's nested inside whatever loop is open (that's how a detail SAC ends up under its IT1). Segments whose loopID names an open loop
+//belong to it, segments with no loop ("None") close every open loop, and so does moving into a new area. Segments that aren't in the schema
+//at all are left inside whatever loop they turn up in.
+
+const uint32_t NO_LOOP = UINT32_MAX;
+
+struct LoopNode {
+
+	string_view loopID; //"N1", "IT1", "SAC"
+	DocLocation area;
+	uint32_t headerSegment; //The segment that started the loop.
+	uint32_t endSegment; //One past the last segment in the loop, nested loops included.
+	uint32_t firstElement; //Same range in element indexes.
+	uint32_t endElement;
+	uint32_t parent; //NO_LOOP for loops that aren't nested.
+	uint32_t firstChild;
+	uint32_t nextSibling;
+
+};
+
+
+class InvoiceLoopTree {
+
+	private:
+
+		vector <LoopNode> loops; //In document order, so a parent always comes before its children.
+		vector <uint32_t> lastChild; //Only used while building, to link siblings.
+		vector <uint32_t> openLoops;
+		vector <uint32_t> partyLoops;
+		vector <uint32_t> lineItemLoops;
+		vector <uint32_t> summaryAllowanceLoops;
+
+		void openLoop(string_view loopID, DocLocation area, uint32_t segmentIndex, const InvoiceDocumentStore& documentStore);
+		void closeLoopsFrom(size_t stackPosition, uint32_t segmentIndex, const InvoiceDocumentStore& documentStore);
+
+	public:
+
+		//Constructors and destructor
+
+		InvoiceLoopTree() {}
+
+		~InvoiceLoopTree() {}
+
+
+		void build(const InvoiceDocumentStore& documentStore); //Replaces whatever tree was there before.
+
+		void reset();
+
+
+
+		//Accessors
+
+		size_t getNumLoops() const
+		{
+			return loops.size();
+		}
+
+		const LoopNode& getLoop(uint32_t loopIndex) const
+		{
+			return loops[loopIndex];
+		}
+
+		const vector <uint32_t>& getPartyLoops() const //Heading N1 loops.
+		{
+			return partyLoops;
+		}
+
+		const vector <uint32_t>& getLineItemLoops() const //Detail IT1 loops.
+		{
+			return lineItemLoops;
+		}
+
+		const vector <uint32_t>& getSummaryAllowanceLoops() const //Summary SAC loops.
+		{
+			return summaryAllowanceLoops;
+		}
+
+};
+
+#endif
@@ -0,0 +1,617 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Schema.h"
+#include "InvoicePipeline.h"
+#include "PipelineStats.h"
+using namespace std;
+
+
+constexpr ElementCode ELEMENT_CODE_BIG01 = findElementCode("BIG01"); //Worked out by the compiler, so a lookup never touches the text.
+constexpr ElementCode ELEMENT_CODE_BIG02 = findElementCode("BIG02");
+constexpr ElementCode ELEMENT_CODE_BIG04 = findElementCode("BIG04");
+constexpr ElementCode ELEMENT_CODE_TDS01 = findElementCode("TDS01");
+constexpr uint8_t SEGMENT_CODE_IT3 = findSegmentCode("IT3");
+constexpr uint8_t SEGMENT_CODE_SAC = findSegmentCode("SAC");
+
+
+//*******************************************************************************************************************************************
+//
+//Function openInvoiceInputFile maps the input file into memory through the EdiInputFile passed in by reference. Process and close
+//activites are left to other functions. EdiInputFile::open throws a string if the file isn't there. The menu always reads the sample
+//file (that's the default argument); batch mode passes in each file it was given.
+//
+//*******************************************************************************************************************************************
+
+
+EdiInputFile& openInvoiceInputFile(EdiInputFile& invoiceInputFile, const string& inputFileName) {
+
+	invoiceInputFile.open(inputFileName);
+
+	return invoiceInputFile;
+
+}
+
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function readInvoiceInputFile takes in the mapped inputFile by reference and tokenizes the whole thing in one pass. That single pass gives
+//back the segment boundary offsets (kept in the tokenizer) and also sets the reference variables for a couple key things other functions
+//need (number of lines, number of element delimiters). The returned view points directly into the mapping -- nothing is copied, and
+//CR/LF-wrapped files work because the whole file is kept rather than only the last line getline saw.
+//
+//*******************************************************************************************************************************************
+
+string_view readInvoiceInputFile(EdiInputFile& invoiceInputFile, EdiTokenizer& invoiceTokenizer, int& totalElementDelimiterCounter, int& totalLineDelimiterCounter) {
+
+	string_view fileContents = invoiceInputFile.getContents();
+
+	invoiceTokenizer.tokenize(fileContents);
+
+	totalLineDelimiterCounter = static_cast<int>(invoiceTokenizer.getNumSegments());
+	totalElementDelimiterCounter = static_cast<int>(invoiceTokenizer.getNumElements() - invoiceTokenizer.getNumSegments()); //Each segment has one more element than it has element delimiters.
+
+	return fileContents;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function closeInvoiceInputFile simply closes the inputFile (releasing the mapping) if it is open.
+//
+//*******************************************************************************************************************************************
+
+void closeInvoiceInputFile(EdiInputFile& invoiceInputFile) {
+
+	if (invoiceInputFile.isOpen()) {
+		invoiceInputFile.close();
+	}
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function populateInvoiceDocumentStructureArr populates the invoiceDocumentStructureArr array of type InvDocument to have key items
+//about the document's structure in one place within InvDocument instances' member variables. InvDocument is the base class for the ElementData
+//derived class. All the splitting already happened in the tokenizer, so this is just reading segment spans back out of it.
+//
+//*******************************************************************************************************************************************
+
+InvDocument* populateInvoiceDocumentStructureArr(InvDocument* invoiceDocumentStructureArr, const EdiTokenizer& invoiceTokenizer, const int totalLineDelimiterCounter) {
+
+	StageSpan span(STAGE_POPULATE_SEGMENTS);
+	int numSegments = static_cast<int>(invoiceTokenizer.getNumSegments());
+
+	for (int i = 0; i < numSegments && i < totalLineDelimiterCounter; i++) {
+
+		string_view lineView = invoiceTokenizer.getSegmentText(i);
+		string_view segmentIDView = invoiceTokenizer.getSegmentID(i);
+
+		invoiceDocumentStructureArr[i].setLineContents(string(lineView));
+		invoiceDocumentStructureArr[i].setLineLength(lineView.length());
+		invoiceDocumentStructureArr[i].setSequence(i + 1);
+		invoiceDocumentStructureArr[i].setSegmentID(string(segmentIDView));
+		invoiceDocumentStructureArr[i].setSegmentIDLen(segmentIDView.length());
+		invoiceDocumentStructureArr[i].setNumElements(invoiceTokenizer.getSegment(i).numElements);
+
+	}
+
+	span.addWork(0, (numSegments < totalLineDelimiterCounter) ? numSegments : totalLineDelimiterCounter, 0);
+
+	return invoiceDocumentStructureArr;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function populateElementDataVect takes the element spans found by the tokenizer and populates a vector containing ElementData objects.
+//The output of this function is the elementDataVect vector passed back by reference with every element in the EDI document mapped to a
+//particular segment address. Each element value is copied exactly once, straight out of the input buffer.
+//
+//*******************************************************************************************************************************************
+
+vector <ElementData>& populateElementDataVect(vector <ElementData>& elementDataVect, const EdiTokenizer& invoiceTokenizer) {
+
+	StageSpan span(STAGE_POPULATE_ELEMENTS);
+	ElementData tempObject;
+
+	elementDataVect.reserve(elementDataVect.size() + invoiceTokenizer.getNumElements());
+
+	for (size_t i = 0; i < invoiceTokenizer.getNumSegments(); i++) { //Iterate through each document line.
+
+		const SegmentSpan& segment = invoiceTokenizer.getSegment(i);
+		string tempSegmentID(invoiceTokenizer.getSegmentID(i));
+		uint8_t segmentCode = findSegmentCode(tempSegmentID); //Once per segment; each element's ID is then just this plus its position.
+
+		for (int j = 0; j < segment.numElements; j++) {
+
+			string_view token = invoiceTokenizer.getElementValue(segment.firstElement + j); //Empty elements come back as "NULL".
+
+			//Populate elements.
+
+			tempObject.setStrValue(string(token));
+			tempObject.setElementLength(token.length());
+			tempObject.setSegmentID(tempSegmentID);
+			tempObject.setElementID(makeElementCode(segmentCode, j), j); //No string is built for the ID anymore; getElementNum makes one if it's printed.
+
+			elementDataVect.push_back(tempObject);
+
+		}
+
+	}
+
+	span.addWork(0, invoiceTokenizer.getNumSegments(), invoiceTokenizer.getNumElements());
+
+	return elementDataVect;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function generateElementID does some string manipulation to make an element ID for each element in a given segment. The function
+//concatenates the alphanumeric segment ID + 0 (if the position is 0-9) + a numeric position, returning as a string. The parse doesn't call
+//this anymore (elements carry an ElementCode instead); it's here for anything that really does want the text.
+//
+//*******************************************************************************************************************************************
+
+string generateElementID(string segmentID, int elementSequenceNumber) {
+
+	return formatElementID(segmentID, elementSequenceNumber);
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function displayElementVectContents prints a few pieces of data from an EDI 810 file to the console in a tabular format.
+//
+//*******************************************************************************************************************************************
+
+void displayElementDataVectContents(vector <ElementData>& elementDataVect) {
+
+	cout << "#" << setw(20) << "Element ID" << setw(30) << "Value" << endl;
+	cout << "----------------------------------------------------------------------------" << endl;
+
+	for (int i = 0; i < elementDataVect.size(); i++) {
+
+		cout << i << setw(20); //0-9 being single digit makes the formatting quite not aligned, but that's not worth picking at.
+		elementDataVect[i].displayElemNum();
+		cout << setw(30);
+		elementDataVect[i].displayStrValue();
+		cout << endl;
+
+	}
+
+}
+
+void displayElementDataVectContents(const LazyInvoiceDocument& lazyDocument) { //Same table, building each ElementData just long enough to print it.
+
+	cout << "#" << setw(20) << "Element ID" << setw(30) << "Value" << endl;
+	cout << "----------------------------------------------------------------------------" << endl;
+
+	for (size_t i = 0; i < lazyDocument.getNumElements(); i++) {
+
+		ElementData element = lazyDocument.materializeElement(i);
+
+		cout << i << setw(20);
+		element.displayElemNum();
+		cout << setw(30);
+		element.displayStrValue();
+		cout << endl;
+
+	}
+
+}
+
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function lookupSequenceNumberForElement finds where an element (by its ElementCode, e.g. findElementCode("BIG02"), which the compiler works
+//out) sits in elementDataVect using the ElementIndex built at parse time, so it's one array read rather than a scan with a string compare on
+//every element. If the element occurs more than once, the last occurrence is used, same as always. Returns false (and leaves
+//sequenceNumberForElement alone) if the element isn't in the document.
+//
+//*******************************************************************************************************************************************
+
+bool lookupSequenceNumberForElement(const ElementIndex& elementIndex, ElementCode elementCode, size_t& sequenceNumberForElement) {
+
+	ElementOccurrences occurrences = elementIndex.find(elementCode);
+
+	if (!occurrences.found()) {
+		return false;
+	}
+
+	sequenceNumberForElement = occurrences.last();
+
+	return true;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function lookupElementStrValue is a small convenience wrapper for the renderers. It gives back a view of the element's value straight out
+//of the document store, or "NULL" if the element isn't in the document at all, instead of indexing with a bad sequence number.
+//
+//*******************************************************************************************************************************************
+
+string_view lookupElementStrValue(const InvoiceDocumentStore& documentStore, const ElementIndex& elementIndex, ElementCode elementCode) {
+
+	size_t sequenceNumberForElement = 0;
+
+	if (!lookupSequenceNumberForElement(elementIndex, elementCode, sequenceNumberForElement) || sequenceNumberForElement >= documentStore.getNumElements()) {
+		return "NULL";
+	}
+
+	return documentStore.getElementValue(sequenceNumberForElement);
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function lookupElementFixedPoint gets a numeric element's value already decoded to fixed-point (see EdiValueDecoder.h) by the document
+//store. Returns false if the element isn't there or didn't decode as a number.
+//
+//*******************************************************************************************************************************************
+
+bool lookupElementFixedPoint(const InvoiceDocumentStore& documentStore, const ElementIndex& elementIndex, ElementCode elementCode, int64_t& scaledValue) {
+
+	size_t sequenceNumberForElement = 0;
+
+	if (!lookupSequenceNumberForElement(elementIndex, elementCode, sequenceNumberForElement) || sequenceNumberForElement >= documentStore.getNumElements()) {
+		return false;
+	}
+
+	return documentStore.getElementFixedPoint(sequenceNumberForElement, scaledValue);
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function lookupElementAmountText formats a money element to two decimal places for display, exactly (no double in between). Anything that
+//isn't a usable number shows as "NULL", same as a missing element.
+//
+//*******************************************************************************************************************************************
+
+string lookupElementAmountText(const InvoiceDocumentStore& documentStore, const ElementIndex& elementIndex, ElementCode elementCode) {
+
+	int64_t scaledValue = 0;
+
+	if (!lookupElementFixedPoint(documentStore, elementIndex, elementCode, scaledValue)) {
+		return "NULL";
+	}
+
+	return "$" + formatFixedPoint(scaledValue, 2);
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function openBinaryOutputFile opens a file expected to receive output from another function.
+//
+//*******************************************************************************************************************************************
+
+fstream& openBinaryOutputFile(fstream& binaryOutputFile) {
+
+	binaryOutputFile.open("invoiceOutputFile.dat", ios::out | ios::binary | ios::trunc); //Truncates, so a file left over from an earlier run is replaced instead of skipped.
+
+	return binaryOutputFile;
+
+}
+
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function closeBinaryOutputFile closes a file passed in by reference from another function.
+//
+//*******************************************************************************************************************************************
+
+void closeBinaryOutputFile(fstream& binaryOutputFile) {
+
+	if (binaryOutputFile.fail()) {
+
+		//Do nothing.
+
+	}
+
+	else {
+
+		binaryOutputFile.close();
+
+	}
+
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function getSegmentElementValue gives back the element at a position within one segment, or "NULL" if the segment doesn't go that far.
+//The loop renderers use this since they already know which segment they're on and don't need the index.
+//
+//*******************************************************************************************************************************************
+
+string_view getSegmentElementValue(const InvoiceDocumentStore& documentStore, size_t segmentIndex, int position) {
+
+	if (position >= documentStore.getSegmentNumElements(segmentIndex)) {
+		return "NULL";
+	}
+
+	return documentStore.getElementValue(documentStore.getSegmentFirstElement(segmentIndex) + position);
+
+}
+
+string getSegmentElementAmountText(const InvoiceDocumentStore& documentStore, size_t segmentIndex, int position) {
+
+	int64_t scaledValue = 0;
+
+	if (position >= documentStore.getSegmentNumElements(segmentIndex) || !documentStore.getElementFixedPoint(documentStore.getSegmentFirstElement(segmentIndex) + position, scaledValue)) {
+		return "NULL";
+	}
+
+	return "$" + formatFixedPoint(scaledValue, 2);
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function describePartyQualifier spells out the N101 codes that show up on Kroger invoices. Anything else is shown as the code itself.
+//
+//*******************************************************************************************************************************************
+
+string describePartyQualifier(string_view qualifier) {
+
+	if (qualifier == "VN") {
+		return "Vendor";
+	}
+
+	if (qualifier == "ST") {
+		return "Ship To";
+	}
+
+	if (qualifier == "RE") {
+		return "Remit To";
+	}
+
+	if (qualifier == "BT") {
+		return "Bill To";
+	}
+
+	if (qualifier == "BY") {
+		return "Buying Party";
+	}
+
+	return string(qualifier);
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Functions renderPartyLoops, renderLineItemLoops, and renderSummaryAllowanceLoops walk the loops InvoiceLoopTree found. Each loop is a range
+//of segments, so this is a straight walk through them with no searching, however many line items there are.
+//
+//*******************************************************************************************************************************************
+
+void renderPartyLoops(const InvoiceDocumentStore& documentStore, const InvoiceLoopTree& loopTree, RenderBuffer& out) {
+
+	for (uint32_t loopIndex : loopTree.getPartyLoops()) {
+
+		uint32_t headerSegment = loopTree.getLoop(loopIndex).headerSegment;
+
+		out << describePartyQualifier(getSegmentElementValue(documentStore, headerSegment, 1)) << " ";
+		out << N102.elementName << ": " << getSegmentElementValue(documentStore, headerSegment, 2) << '\n'; //N102 = Party Name
+
+	}
+
+}
+
+void renderLineItemLoops(const InvoiceDocumentStore& documentStore, const InvoiceLoopTree& loopTree, RenderBuffer& out) {
+
+	const vector <uint32_t>& lineItemLoops = loopTree.getLineItemLoops();
+
+	if (lineItemLoops.empty()) {
+		out << "No line items.\n";
+	}
+
+	for (size_t i = 0; i < lineItemLoops.size(); i++) {
+
+		const LoopNode& lineItem = loopTree.getLoop(lineItemLoops[i]);
+		uint32_t it1Segment = lineItem.headerSegment;
+
+		out << "Line item " << i + 1 << " of " << lineItemLoops.size() << '\n';
+		out << IT107.elementName << ": " << getSegmentElementValue(documentStore, it1Segment, 7) << '\n'; //IT107 = Product/Svc ID
+		out << IT102.elementName << ": " << getSegmentElementValue(documentStore, it1Segment, 2) << '\n'; //IT102 = Qty
+		out << IT103.elementName << ": " << getSegmentElementValue(documentStore, it1Segment, 3) << '\n'; //IT103 = Unit of Measure
+		out << IT104.elementName << "**: " << getSegmentElementAmountText(documentStore, it1Segment, 4) << '\n'; //IT104 = Unit Price
+
+		for (uint32_t segmentIndex = it1Segment + 1; segmentIndex < lineItem.endSegment; segmentIndex++) {
+
+			uint8_t segmentCode = documentStore.getSegmentCode(segmentIndex);
+
+			if (segmentCode == SEGMENT_CODE_IT3) {
+				out << IT301.elementName << ": " << getSegmentElementValue(documentStore, segmentIndex, 1) << " " << getSegmentElementValue(documentStore, segmentIndex, 2) << '\n';
+			}
+
+			else if (segmentCode == SEGMENT_CODE_SAC) {
+				out << ((getSegmentElementValue(documentStore, segmentIndex, 1) == "C") ? "Charge " : "Allowance ") << getSegmentElementValue(documentStore, segmentIndex, 2);
+				out << " " << SAC08_detail.elementName << ": " << getSegmentElementAmountText(documentStore, segmentIndex, 8) << '\n';
+			}
+
+		}
+
+		out << '\n';
+
+	}
+
+}
+
+void renderSummaryAllowanceLoops(const InvoiceDocumentStore& documentStore, const InvoiceLoopTree& loopTree, RenderBuffer& out) {
+
+	for (uint32_t loopIndex : loopTree.getSummaryAllowanceLoops()) {
+
+		uint32_t sacSegment = loopTree.getLoop(loopIndex).headerSegment;
+
+		out << ((getSegmentElementValue(documentStore, sacSegment, 1) == "C") ? "Charge " : "Allowance ") << getSegmentElementValue(documentStore, sacSegment, 2);
+		out << " " << SAC05_summary.elementName << ": " << getSegmentElementAmountText(documentStore, sacSegment, 5) << '\n';
+
+	}
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function appendInvoiceForHumans takes key elements from the document store and marries with the 810 IC schema to provide a human-readable
+//view. It only formats into the buffer (nothing is flushed along the way); it appends rather than clearing, so several invoices can be
+//built up back to back. renderInvoiceForHumans is the usual way in: one invoice, one write to whichever sink is passed.
+//
+//*******************************************************************************************************************************************
+
+void appendInvoiceForHumans(const InvoiceDocumentStore& documentStore, const ElementIndex& elementIndex, const InvoiceLoopTree& loopTree, RenderBuffer& out) {
+
+	StageSpan span(STAGE_RENDER_HUMAN);
+	size_t startSize = out.getSize();
+
+	out << "Human-Readable Invoice\n";
+	out << "~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n\n";
+	//If an element isn't in the file, lookupElementStrValue hands back "NULL" the same way an empty element would be shown.
+
+	out << "TOP-LEVEL\n";
+	out << "_________________________________\n\n";
+	out << BIG02.elementName << ": " << lookupElementStrValue(documentStore, elementIndex, ELEMENT_CODE_BIG02) << '\n'; //BIG02 = Vendor Name
+	out << BIG01.elementName << ": " << lookupElementStrValue(documentStore, elementIndex, ELEMENT_CODE_BIG01) << '\n'; //BIG01 = Invoice Date
+	out << BIG04.elementName << " (" << BIG04.description << "): " << lookupElementStrValue(documentStore, elementIndex, ELEMENT_CODE_BIG04) << '\n'; //BIG04 = PO Ref Number
+
+	renderPartyLoops(documentStore, loopTree, out); //Every N1 loop, named by its N101 qualifier.
+	out << '\n';
+
+	out << "\nLINE ITEM DETAIL:\n";
+	out << "_________________________________\n\n";
+
+	renderLineItemLoops(documentStore, loopTree, out); //Every IT1 loop with its IT3 and SAC segments, in document order.
+
+	out << "\nSUMMARY:\n";
+	out << "_________________________________\n\n";
+	//TDS01 is an N2 (implied decimal) field, so "6770" is $67.70; the decoder takes care of that.
+
+	out << TDS01.elementName << "***: " << lookupElementAmountText(documentStore, elementIndex, ELEMENT_CODE_TDS01) << '\n'; //TDS01 = Total Invoice Amount
+
+	renderSummaryAllowanceLoops(documentStore, loopTree, out);
+
+
+	out << "\n\nNOTES:\n";
+	out << "_________________________________\n";
+	out << "\n**When more than two decimal places are used, they are rounded to the cent for display here even though they are still carried behind the scenes.";
+	out << "\n\n***" << TDS01.description << '\n';
+
+	span.addWork(out.getSize() - startSize, documentStore.getNumSegments(), 0);
+
+}
+
+
+
+void renderInvoiceForHumans(const InvoiceDocumentStore& documentStore, const ElementIndex& elementIndex, const InvoiceLoopTree& loopTree, RenderBuffer& buffer, OutputSink& sink) {
+
+	buffer.clear();
+	appendInvoiceForHumans(documentStore, elementIndex, loopTree, buffer);
+	sink.write(buffer);
+	sink.flush();
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function appendInvoiceForMachines is the same table option 3 shows (sequence number, element ID, value), but tab-separated with no heading
+//or padding so scripts can split it. Element IDs are built the same way generateElementID builds them: segment ID plus a two-digit position.
+//
+//*******************************************************************************************************************************************
+
+void appendInvoiceForMachines(const InvoiceDocumentStore& documentStore, RenderBuffer& out) {
+
+	StageSpan span(STAGE_RENDER_MACHINE);
+	size_t startSize = out.getSize();
+
+	for (size_t i = 0; i < documentStore.getNumElements(); i++) {
+
+		int position = documentStore.getElementPosition(i);
+
+		out << i << '\t' << documentStore.getSegmentID(documentStore.getElementSegment(i));
+		out << ((position < 10) ? "0" : "") << position << '\t' << documentStore.getElementValue(i) << '\n';
+
+	}
+
+	span.addWork(out.getSize() - startSize, 0, documentStore.getNumElements());
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function validateInvoiceEnvelope does the bare minimum check that a tokenized file is actually a transaction set: it has to start with an
+//ST segment, end with an SE segment, and the control numbers in ST02 and SE02 have to match. errorMessage says what was wrong if not.
+//
+//*******************************************************************************************************************************************
+
+bool validateInvoiceEnvelope(const EdiTokenizer& invoiceTokenizer, string& errorMessage) {
+
+	size_t numSegments = invoiceTokenizer.getNumSegments();
+
+	if (numSegments == 0) {
+		errorMessage = "No complete segments were found.";
+		return false;
+	}
+
+	if (invoiceTokenizer.getSegmentID(0) != "ST") {
+		errorMessage = "The first segment is not ST.";
+		return false;
+	}
+
+	if (invoiceTokenizer.getSegmentID(numSegments - 1) != "SE") {
+		errorMessage = "The last segment is not SE.";
+		return false;
+	}
+
+	const SegmentSpan& stSegment = invoiceTokenizer.getSegment(0);
+	const SegmentSpan& seSegment = invoiceTokenizer.getSegment(numSegments - 1);
+
+	if (stSegment.numElements < 3 || seSegment.numElements < 3 || invoiceTokenizer.getElementText(stSegment.firstElement + 2) != invoiceTokenizer.getElementText(seSegment.firstElement + 2)) {
+		errorMessage = "The ST02 and SE02 control numbers do not match.";
+		return false;
+	}
+
+	return true;
+
+}
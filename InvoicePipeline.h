@@ -0,0 +1,50 @@
+#ifndef INVOICEPIPELINE_H
+#define INVOICEPIPELINE_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "InvDocument.h"
+#include "ElementData.h"
+#include "EdiTokenizer.h"
+#include "EdiInputFile.h"
+#include "ElementIndex.h"
+#include "InvoiceDocumentStore.h"
+#include "InvoiceLoopTree.h"
+#include "LazyInvoiceDocument.h"
+#include "OutputSink.h"
+using namespace std;
+
+
+//These are the stages every invoice goes through: open/read/tokenize, populate the document structure and element data, look elements up,
+//and render. They used to live in source.cpp next to main, but the batch mode needs to run them too, so the prototypes are shared here and
+//the definitions are in InvoicePipeline.cpp.
+
+EdiInputFile& openInvoiceInputFile(EdiInputFile&, const string& = "krogerSampleInvoice810.dat");
+string_view readInvoiceInputFile(EdiInputFile&, EdiTokenizer&, int&, int&);
+void closeInvoiceInputFile(EdiInputFile&);
+InvDocument* populateInvoiceDocumentStructureArr(InvDocument*, const EdiTokenizer&, const int);
+vector <ElementData>& populateElementDataVect(vector <ElementData>&, const EdiTokenizer&);
+string generateElementID(string, int);
+void displayElementDataVectContents(vector <ElementData>&);
+void displayElementDataVectContents(const LazyInvoiceDocument&);
+bool lookupSequenceNumberForElement(const ElementIndex&, ElementCode, size_t&);
+string_view lookupElementStrValue(const InvoiceDocumentStore&, const ElementIndex&, ElementCode);
+bool lookupElementFixedPoint(const InvoiceDocumentStore&, const ElementIndex&, ElementCode, int64_t&);
+string lookupElementAmountText(const InvoiceDocumentStore&, const ElementIndex&, ElementCode);
+fstream& openBinaryOutputFile(fstream&);
+void closeBinaryOutputFile(fstream&);
+string_view getSegmentElementValue(const InvoiceDocumentStore&, size_t, int);
+string getSegmentElementAmountText(const InvoiceDocumentStore&, size_t, int);
+string describePartyQualifier(string_view);
+void renderPartyLoops(const InvoiceDocumentStore&, const InvoiceLoopTree&, RenderBuffer&);
+void renderLineItemLoops(const InvoiceDocumentStore&, const InvoiceLoopTree&, RenderBuffer&);
+void renderSummaryAllowanceLoops(const InvoiceDocumentStore&, const InvoiceLoopTree&, RenderBuffer&);
+void appendInvoiceForHumans(const InvoiceDocumentStore&, const ElementIndex&, const InvoiceLoopTree&, RenderBuffer&);
+void renderInvoiceForHumans(const InvoiceDocumentStore&, const ElementIndex&, const InvoiceLoopTree&, RenderBuffer&, OutputSink&);
+void appendInvoiceForMachines(const InvoiceDocumentStore&, RenderBuffer&);
+bool validateInvoiceEnvelope(const EdiTokenizer&, string&);
+
+#endif
@@ -0,0 +1,272 @@
+#include "InvoiceTotalReconciler.h"
+#include "EdiValueDecoder.h"
+#include "ElementCode.h"
+using namespace std;
+
+
+const int64_t CENT_SCALED = FIXED_POINT_SCALE / 100;
+
+
+InvoiceTotalReconciler::InvoiceTotalReconciler() {
+
+	maxMismatches = 1000;
+	current = TotalReconciliation{};
+
+	reset();
+
+}
+
+
+
+void InvoiceTotalReconciler::reset() {
+
+	mismatches.clear();
+	numTransactionSets = 0;
+	numMismatches = 0;
+	inTransactionSet = false;
+	inSummary = false;
+	lineQuantity = 0;
+
+}
+
+
+
+void InvoiceTotalReconciler::beginDocument(const EdiTokenizer&) {
+
+	reset();
+
+}
+
+
+
+static int64_t roundToCent(int64_t scaledValue) { //Half away from zero, the same way the renderers round.
+
+	uint64_t magnitude = (scaledValue < 0) ? 0 - static_cast<uint64_t>(scaledValue) : static_cast<uint64_t>(scaledValue);
+
+	magnitude = (magnitude + CENT_SCALED / 2) / CENT_SCALED * CENT_SCALED;
+
+	return (scaledValue < 0) ? -static_cast<int64_t>(magnitude) : static_cast<int64_t>(magnitude);
+
+}
+
+static bool decodeElement(const EdiTokenizer& invoiceTokenizer, const SegmentSpan& segment, int position, int impliedDecimals, int64_t& scaledValue) {
+
+	return position < segment.numElements && decodeFixedPoint(invoiceTokenizer.getElementText(segment.firstElement + position), impliedDecimals, scaledValue);
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function readAllowanceOrCharge works out what one SAC adds to the total: its SAC05 amount (N2), or for an item SAC without one, its SAC08
+//rate x the item's quantity. SAC01 sets the sign. Anything else in SAC01 ("N", no charge) or a SAC with no amount adds nothing. It returns
+//false only when rate x quantity is too big to work out.
+//
+//*******************************************************************************************************************************************
+
+bool InvoiceTotalReconciler::readAllowanceOrCharge(const EdiTokenizer& invoiceTokenizer, const SegmentSpan& segment, int64_t quantity, bool useRate, int64_t& amount) {
+
+	string_view indicator = (segment.numElements > 1) ? invoiceTokenizer.getElementText(segment.firstElement + 1) : string_view();
+	int64_t rate = 0;
+
+	amount = 0;
+
+	if (indicator != "A" && indicator != "C") {
+		return true;
+	}
+
+	if (!decodeElement(invoiceTokenizer, segment, 5, 2, amount)) {
+
+		amount = 0;
+
+		if (!useRate || !decodeElement(invoiceTokenizer, segment, 8, 0, rate)) {
+			return true;
+		}
+
+		if (!multiplyFixedPoint(quantity, rate, amount)) { //amount is still 0.
+			return false;
+		}
+
+	}
+
+	amount = (amount < 0) ? -amount : amount;
+	amount = (indicator == "A") ? -amount : amount;
+
+	return true;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function onSegment is called by the tokenizer as each segment is closed. Only ST, IT1, SAC, TDS and SE matter here, and the segment ID is
+//turned into its interned code so picking between them is one switch instead of a chain of string compares.
+//
+//*******************************************************************************************************************************************
+
+void InvoiceTotalReconciler::onSegment(const EdiTokenizer& invoiceTokenizer, size_t segmentIndex) {
+
+	const SegmentSpan& segment = invoiceTokenizer.getSegment(segmentIndex);
+	int64_t price = 0;
+	int64_t amount = 0;
+
+	switch (findSegmentCode(invoiceTokenizer.getSegmentID(segmentIndex))) {
+
+	case findSegmentCode("ST"): {
+
+		string_view controlNumber = (segment.numElements > 2) ? invoiceTokenizer.getElementText(segment.firstElement + 2) : string_view();
+		size_t controlLength = (controlNumber.length() < sizeof(current.controlNumber) - 1) ? controlNumber.length() : sizeof(current.controlNumber) - 1;
+
+		if (inTransactionSet) { //ST without an SE before it; settle the one that was open.
+			finishTransactionSet();
+		}
+
+		current = TotalReconciliation{};
+		current.segmentSequence = segmentIndex + 1;
+		controlNumber.copy(current.controlNumber, controlLength);
+		current.controlNumber[controlLength] = '\0';
+
+		inTransactionSet = true;
+		inSummary = false;
+		lineQuantity = 0;
+
+		break;
+
+	}
+
+	case findSegmentCode("IT1"):
+
+		current.numLineItems++;
+
+		if (!decodeElement(invoiceTokenizer, segment, 2, 0, lineQuantity) || !decodeElement(invoiceTokenizer, segment, 4, 0, price)) {
+			lineQuantity = 0;
+			current.numUnpricedLineItems++;
+		}
+
+		else if (!multiplyFixedPoint(lineQuantity, price, amount) || !addFixedPoint(current.expectedTotal, amount)) { //Too big to add up; the quantity still stands for an item SAC's rate.
+			current.numUnpricedLineItems++;
+		}
+
+		break;
+
+	case findSegmentCode("SAC"):
+
+		if (!readAllowanceOrCharge(invoiceTokenizer, segment, lineQuantity, !inSummary, amount) || !addFixedPoint(current.expectedTotal, amount)) {
+			current.numUncountedCharges++;
+		}
+
+		break;
+
+	case findSegmentCode("TDS"):
+
+		current.hasReportedTotal = decodeElement(invoiceTokenizer, segment, 1, 2, current.reportedTotal);
+		inSummary = true;
+
+		break;
+
+	case findSegmentCode("SE"):
+
+		if (inTransactionSet) {
+			finishTransactionSet();
+		}
+
+		break;
+
+	}
+
+}
+
+
+
+void InvoiceTotalReconciler::endDocument(const EdiTokenizer&) {
+
+	if (inTransactionSet) { //The buffer ran out before SE.
+		finishTransactionSet();
+	}
+
+}
+
+
+
+void InvoiceTotalReconciler::finishTransactionSet() {
+
+	current.matches = current.hasReportedTotal && roundToCent(current.expectedTotal) == roundToCent(current.reportedTotal);
+
+	numTransactionSets++;
+	inTransactionSet = false;
+
+	if (current.matches) {
+		return;
+	}
+
+	numMismatches++;
+
+	if (mismatches.size() < maxMismatches) {
+		mismatches.push_back(current);
+	}
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function describeResult turns a result into a sentence for people to read.
+//
+//*******************************************************************************************************************************************
+
+string InvoiceTotalReconciler::describeResult(const TotalReconciliation& result) {
+
+	string description = (result.matches ? "OK" : "MISMATCH");
+
+	description += " at segment " + to_string(result.segmentSequence) + " (ST02 " + result.controlNumber + "): ";
+	description += "line items add up to " + formatFixedPoint(result.expectedTotal, 2);
+
+	if (result.hasReportedTotal) {
+		description += ", TDS01 is " + formatFixedPoint(result.reportedTotal, 2) + ".";
+	}
+
+	else {
+		description += ", but there is no TDS01 amount.";
+	}
+
+	if (result.numUnpricedLineItems > 0) {
+		description += " " + to_string(result.numUnpricedLineItems) + " of " + to_string(result.numLineItems) + " line items had no usable quantity or price, or came to more than can be added up.";
+	}
+
+	if (result.numUncountedCharges > 0) {
+		description += " " + to_string(result.numUncountedCharges) + " allowance or charge amount(s) were too big to add in.";
+	}
+
+	return description;
+
+}
+
+
+
+void InvoiceTotalReconciler::displayResults(ostream& out) const {
+
+	if (numTransactionSets == 0) {
+		out << "No transaction sets to reconcile." << endl;
+		return;
+	}
+
+	for (const TotalReconciliation& mismatch : mismatches) {
+		out << describeResult(mismatch) << endl;
+	}
+
+	if (mismatches.size() < numMismatches) {
+		out << "(" << numMismatches - mismatches.size() << " more not shown.)" << endl;
+	}
+
+	if (numTransactionSets == 1 && numMismatches == 0) {
+		out << describeResult(current) << endl;
+	}
+
+	else {
+		out << numTransactionSets - numMismatches << " of " << numTransactionSets << " transaction sets reconcile with TDS01." << endl;
+	}
+
+}
@@ -0,0 +1,114 @@
+#ifndef INVOICETOTALRECONCILER_H
+#define INVOICETOTALRECONCILER_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "EdiTokenizer.h"
+using namespace std;
+
+
+//The InvoiceTotalReconciler class checks TDS01 against what the line items actually add up to, using the rule in its Schema.h note: item
+//quantity (IT102) x unit price (IT104), adjusted by any item SAC that follows the IT1, totaled for every item, then adjusted by the invoice
+//SAC in the summary. It's a SegmentObserver, so the expected total is added up while the tokenizer is still going and the answer is ready the
+//moment SE closes -- no second walk over the document. All the arithmetic is in EdiValueDecoder's fixed-point ten-thousandths, so there's
+//no floating-point drift in the comparison.
+//
+//An item SAC uses its SAC05 amount if it has one, or else its SAC08 rate x the IT1's quantity. SAC01 decides the sign ("A" takes it off,
+//"C" adds it), so it doesn't matter whether the partner also sent the allowance as a negative number. TDS01 is N2, so the two totals are
+//compared to the cent. Each ST..SE in the buffer gets its own result; only the ones that don't match are kept, plus the latest one. A line
+//item or SAC whose amount won't fit in 64 bits is left out of the expected total and counted instead of being allowed to wrap.
+
+struct TotalReconciliation {
+
+	size_t segmentSequence; //1-based sequence number of the ST segment.
+	char controlNumber[10]; //ST02.
+	int64_t expectedTotal; //Fixed-point ten-thousandths, before rounding to the cent.
+	int64_t reportedTotal; //TDS01, fixed-point ten-thousandths.
+	bool hasReportedTotal; //False if TDS was missing or TDS01 wasn't a number.
+	bool matches;
+	size_t numLineItems;
+	size_t numUnpricedLineItems; //IT1s whose IT102 or IT104 is missing or not a number, or whose amount is too big to add up; they add nothing to the expected total.
+	size_t numUncountedCharges; //SACs whose amount (or rate x quantity) is too big to add up; these add nothing either.
+
+};
+
+
+class InvoiceTotalReconciler : public SegmentObserver {
+
+	private:
+
+		vector <TotalReconciliation> mismatches;
+		size_t numTransactionSets;
+		size_t numMismatches;
+		size_t maxMismatches;
+		TotalReconciliation current; //The ST..SE being added up, then the last one finished.
+		bool inTransactionSet;
+		bool inSummary; //Past TDS, so any SAC from here on is the invoice-level one.
+		int64_t lineQuantity; //IT102 of the last IT1, for an item SAC that only sends a rate.
+
+		void finishTransactionSet();
+		static bool readAllowanceOrCharge(const EdiTokenizer& invoiceTokenizer, const SegmentSpan& segment, int64_t quantity, bool useRate, int64_t& amount);
+
+	public:
+
+		//Constructors and destructor
+
+		InvoiceTotalReconciler(); //See InvoiceTotalReconciler.cpp for definitions
+
+		~InvoiceTotalReconciler() {}
+
+
+		//SegmentObserver hooks, called by EdiTokenizer::tokenize.
+		void beginDocument(const EdiTokenizer&) override;
+		void onSegment(const EdiTokenizer& invoiceTokenizer, size_t segmentIndex) override;
+		void endDocument(const EdiTokenizer&) override;
+
+		void reset();
+
+		void displayResults(ostream& out) const;
+
+		static string describeResult(const TotalReconciliation& result);
+
+
+
+		//Mutators
+
+		void setMaxMismatches(size_t maxMis) //Stops keeping mismatches (but keeps counting) after this many.
+		{
+			maxMismatches = maxMis;
+		}
+
+
+		//Accessors
+
+		const vector <TotalReconciliation>& getMismatches() const
+		{
+			return mismatches;
+		}
+
+		const TotalReconciliation& getLastResult() const //Only meaningful once getNumTransactionSets() is above 0.
+		{
+			return current;
+		}
+
+		size_t getNumTransactionSets() const
+		{
+			return numTransactionSets;
+		}
+
+		size_t getNumMismatches() const
+		{
+			return numMismatches;
+		}
+
+		bool isReconciled() const
+		{
+			return numMismatches == 0;
+		}
+
+};
+
+#endif
@@ -0,0 +1,179 @@
+#include "LazyInvoiceDocument.h"
+#include "InvoicePipeline.h"
+#include "Schema.h"
+using namespace std;
+
+
+LazyInvoiceDocument::LazyInvoiceDocument() {
+
+	invoiceTokenizer = nullptr;
+
+}
+
+
+
+void LazyInvoiceDocument::attach(const EdiTokenizer& tokenizer) {
+
+	invoiceTokenizer = &tokenizer;
+	materializedSegments.clear();
+	materializedElements.clear();
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function getSegment fills in an InvDocument for one segment the same way populateInvoiceDocumentStructureArr does for all of them, the
+//first time it's asked for.
+//
+//*******************************************************************************************************************************************
+
+const InvDocument& LazyInvoiceDocument::getSegment(size_t segmentIndex) {
+
+	auto [entry, inserted] = materializedSegments.try_emplace(segmentIndex);
+
+	if (inserted) {
+
+		string_view lineView = invoiceTokenizer->getSegmentText(segmentIndex);
+		string_view segmentIDView = invoiceTokenizer->getSegmentID(segmentIndex);
+		InvDocument& segment = entry->second;
+
+		segment.setLineContents(string(lineView));
+		segment.setLineLength(static_cast<int>(lineView.length()));
+		segment.setSequence(static_cast<int>(segmentIndex + 1));
+		segment.setSegmentID(string(segmentIDView));
+		segment.setSegmentIDLen(static_cast<int>(segmentIDView.length()));
+		segment.setNumElements(invoiceTokenizer->getSegment(segmentIndex).numElements);
+
+	}
+
+	return entry->second;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function getElement hands back the kept ElementData for an element, building it with materializeElement the first time.
+//
+//*******************************************************************************************************************************************
+
+const ElementData& LazyInvoiceDocument::getElement(size_t elementIndex) {
+
+	auto entry = materializedElements.find(elementIndex);
+
+	if (entry == materializedElements.end()) {
+		entry = materializedElements.emplace(elementIndex, materializeElement(elementIndex)).first;
+	}
+
+	return entry->second;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function materializeElement builds the ElementData populateElementDataVect would have made for this element: the value ("NULL" when
+//empty), its length, the segment ID, and the interned element code for an ID like "BIG02".
+//
+//*******************************************************************************************************************************************
+
+ElementData LazyInvoiceDocument::materializeElement(size_t elementIndex) const {
+
+	size_t segmentIndex = findElementSegment(elementIndex);
+	string segmentID(invoiceTokenizer->getSegmentID(segmentIndex));
+	string_view token = invoiceTokenizer->getElementValue(elementIndex);
+	int position = static_cast<int>(elementIndex - invoiceTokenizer->getSegment(segmentIndex).firstElement);
+	ElementData element;
+
+	element.setStrValue(string(token));
+	element.setElementLength(static_cast<int>(token.length()));
+	element.setSegmentID(segmentID);
+	element.setElementID(makeElementCode(segmentID, position), position);
+
+	return element;
+
+}
+
+
+
+const ElementData* LazyInvoiceDocument::findElement(const ElementIndex& elementIndex, ElementCode elementCode) {
+
+	size_t sequenceNumberForElement = 0;
+
+	if (!lookupSequenceNumberForElement(elementIndex, elementCode, sequenceNumberForElement) || sequenceNumberForElement >= getNumElements()) {
+		return nullptr;
+	}
+
+	return &getElement(sequenceNumberForElement);
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function getElementTypedValue looks the element's ref up in Schema.h and decodes it the same way InvoiceDocumentStore::build does, but
+//only for this one element. Nothing is kept, since decoding one element is cheaper than finding it again in a cache.
+//
+//*******************************************************************************************************************************************
+
+EdiDataType LazyInvoiceDocument::getElementTypedValue(size_t elementIndex, int64_t& decodedValue) const {
+
+	size_t segmentIndex = findElementSegment(elementIndex);
+	string_view segmentID = invoiceTokenizer->getSegmentID(segmentIndex);
+	size_t position = elementIndex - invoiceTokenizer->getSegment(segmentIndex).firstElement;
+	char elementRef[8] = {};
+	size_t idLength = (segmentID.length() < 5) ? segmentID.length() : 5;
+
+	if (position == 0 || position >= 100) {
+		return TYPE_UNKNOWN;
+	}
+
+	segmentID.copy(elementRef, idLength);
+	elementRef[idLength] = static_cast<char>('0' + position / 10);
+	elementRef[idLength + 1] = static_cast<char>('0' + position % 10);
+
+	const Segment* elementSchema = findElementSchema(string_view(elementRef, idLength + 2));
+
+	if (elementSchema == nullptr) {
+		return TYPE_UNKNOWN;
+	}
+
+	EdiDataType type = getEdiDataType(elementSchema->type);
+
+	if (type != TYPE_R && type != TYPE_N0 && type != TYPE_N2 && type != TYPE_DT) {
+		return TYPE_UNKNOWN;
+	}
+
+	return decodeTypedValue(invoiceTokenizer->getElementText(elementIndex), type, decodedValue) ? type : TYPE_UNKNOWN;
+
+}
+
+
+
+size_t LazyInvoiceDocument::findElementSegment(size_t elementIndex) const {
+
+	size_t low = 0;
+	size_t high = invoiceTokenizer->getNumSegments();
+
+	while (high - low > 1) { //Last segment whose firstElement is at or before elementIndex.
+
+		size_t middle = low + (high - low) / 2;
+
+		if (invoiceTokenizer->getSegment(middle).firstElement <= elementIndex) {
+			low = middle;
+		}
+
+		else {
+			high = middle;
+		}
+
+	}
+
+	return low;
+
+}
@@ -0,0 +1,80 @@
+#ifndef LAZYINVOICEDOCUMENT_H
+#define LAZYINVOICEDOCUMENT_H
+
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include "InvDocument.h"
+#include "ElementData.h"
+#include "EdiTokenizer.h"
+#include "EdiValueDecoder.h"
+#include "ElementIndex.h"
+using namespace std;
+
+
+//The LazyInvoiceDocument class is the on-demand version of invDocumentStructureArr and elementDataVect. Attaching it to a tokenizer costs
+//nothing: the tokenizer's segment and element spans are the only thing kept. An InvDocument or ElementData (with its copied strings and
+//generated element ID) is only built the first time that segment or element is asked for, and then kept so asking again hands back the
+//same object. Typed values are decoded from the buffer each time they're asked for. A job that reads a dozen elements out of a huge file
+//builds a dozen objects instead of one per element.
+//
+//The tokenizer (and the buffer it was run on) has to outlive the lazy document, and references handed out stay good until the next attach.
+
+class LazyInvoiceDocument {
+
+	private:
+
+		const EdiTokenizer* invoiceTokenizer;
+		unordered_map <size_t, InvDocument> materializedSegments;
+		unordered_map <size_t, ElementData> materializedElements;
+
+	public:
+
+		//Constructors and destructor
+
+		LazyInvoiceDocument(); //See LazyInvoiceDocument.cpp for definitions
+
+		~LazyInvoiceDocument() {}
+
+
+		void attach(const EdiTokenizer& tokenizer); //Forgets anything built for the previous document.
+
+		const InvDocument& getSegment(size_t segmentIndex); //Built on first access; same contents as populateInvoiceDocumentStructureArr gives.
+
+		const ElementData& getElement(size_t elementIndex); //Built on first access; same contents as populateElementDataVect gives.
+
+		ElementData materializeElement(size_t elementIndex) const; //Builds a copy without keeping it, for walking every element once.
+
+		const ElementData* findElement(const ElementIndex& elementIndex, ElementCode elementCode); //Last occurrence, like lookupSequenceNumberForElement. nullptr if it isn't there.
+
+		EdiDataType getElementTypedValue(size_t elementIndex, int64_t& decodedValue) const; //TYPE_UNKNOWN unless the schema types it R/N0/N2/DT and it decodes.
+
+		size_t findElementSegment(size_t elementIndex) const; //Binary search on the segments' firstElement, so nothing per element is stored for it.
+
+
+
+		//Accessors
+
+		size_t getNumSegments() const
+		{
+			return (invoiceTokenizer == nullptr) ? 0 : invoiceTokenizer->getNumSegments();
+		}
+
+		size_t getNumElements() const
+		{
+			return (invoiceTokenizer == nullptr) ? 0 : invoiceTokenizer->getNumElements();
+		}
+
+		size_t getNumMaterializedSegments() const
+		{
+			return materializedSegments.size();
+		}
+
+		size_t getNumMaterializedElements() const
+		{
+			return materializedElements.size();
+		}
+
+};
+
+#endif
@@ -0,0 +1,367 @@
+#include "MemoryStats.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#define PSAPI_VERSION 2 //K32GetProcessMemoryInfo lives in kernel32, so there's no psapi.lib to link.
+#include <windows.h>
+#include <psapi.h>
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#include <sys/resource.h>
+#else
+#include <malloc.h>
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+
+const size_t BLOCK_HEADER_BYTES = __STDCPP_DEFAULT_NEW_ALIGNMENT__; //Ahead of every block; as big as new's alignment so the block keeps it.
+const size_t CACHE_LINE_BYTES = 64;
+
+static_assert(BLOCK_HEADER_BYTES >= sizeof(uint64_t), "The block header has to hold a tracked size.");
+
+
+alignas(CACHE_LINE_BYTES) bool allocationTrackingEnabled = false; //Its own cache line, so every new and delete reads a line nothing writes to.
+
+struct alignas(CACHE_LINE_BYTES) TrackedTotals { //Only written while tracking, and kept off the flag's line.
+
+	atomic <uint64_t> allocations{ 0 };
+	atomic <uint64_t> bytes{ 0 };
+	atomic <int64_t> liveBytes{ 0 };
+	atomic <int64_t> peakLiveBytes{ 0 };
+
+};
+
+static TrackedTotals trackedTotals;
+static thread_local AllocationScope* currentAllocationScope = nullptr;
+
+static mutex invoiceSummaryMutex;
+static InvoiceAllocationSummary invoiceSummary{ 0, 0, 0, 0, 0, "" };
+
+
+static size_t getBlockSize(void* block) { //What the allocator really set aside, which is also what free gives back.
+
+#ifdef _WIN32
+	return _msize(block);
+#elif defined(__APPLE__)
+	return malloc_size(block);
+#else
+	return malloc_usable_size(block);
+#endif
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Functions trackAllocation and trackDeallocation do the bookkeeping for allocation tracking. They must not allocate anything themselves,
+//since they're called from inside operator new and delete. Each open scope on this thread is updated, innermost first. trackAllocation
+//hands back the size it counted, which goes into the block's header; trackDeallocation takes it back from there, so a block that was
+//allocated before tracking started (its header says 0) is never taken off totals it was never added to.
+//
+//*******************************************************************************************************************************************
+
+uint64_t trackAllocation(void* block) {
+
+	int64_t blockSize = static_cast<int64_t>(getBlockSize(block));
+	int64_t liveBytes = trackedTotals.liveBytes.fetch_add(blockSize, memory_order_relaxed) + blockSize;
+	int64_t peakLiveBytes = trackedTotals.peakLiveBytes.load(memory_order_relaxed);
+
+	trackedTotals.allocations.fetch_add(1, memory_order_relaxed);
+	trackedTotals.bytes.fetch_add(blockSize, memory_order_relaxed);
+
+	while (liveBytes > peakLiveBytes && !trackedTotals.peakLiveBytes.compare_exchange_weak(peakLiveBytes, liveBytes, memory_order_relaxed)) {
+		//compare_exchange_weak reloaded peakLiveBytes; try again only while this is still the peak.
+	}
+
+	for (AllocationScope* scope = currentAllocationScope; scope != nullptr; scope = scope->parent) {
+
+		scope->allocations++;
+		scope->bytesAllocated += blockSize;
+		scope->liveBytes += blockSize;
+
+		if (scope->liveBytes > scope->peakLiveBytes) {
+			scope->peakLiveBytes = scope->liveBytes;
+		}
+
+	}
+
+	return static_cast<uint64_t>(blockSize);
+
+}
+
+void trackDeallocation(uint64_t trackedSize) {
+
+	int64_t blockSize = static_cast<int64_t>(trackedSize);
+
+	trackedTotals.liveBytes.fetch_sub(blockSize, memory_order_relaxed);
+
+	for (AllocationScope* scope = currentAllocationScope; scope != nullptr; scope = scope->parent) {
+		scope->liveBytes -= blockSize;
+	}
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Functions countedAllocate and countedFree put a small header ahead of every block, tracked or not, so delete can tell which blocks were
+//counted. Without tracking that's one store into memory the caller is about to use anyway; nothing shared is written.
+//
+//*******************************************************************************************************************************************
+
+static void* countedAllocate(size_t bytes) {
+
+	if (bytes > SIZE_MAX - BLOCK_HEADER_BYTES) {
+		throw bad_alloc();
+	}
+
+	void* block = malloc(BLOCK_HEADER_BYTES + bytes);
+
+	if (block == nullptr) {
+		throw bad_alloc();
+	}
+
+	*static_cast<uint64_t*>(block) = allocationTrackingEnabled ? trackAllocation(block) : 0;
+
+	return static_cast<char*>(block) + BLOCK_HEADER_BYTES;
+
+}
+
+static void countedFree(void* userBlock) {
+
+	if (userBlock == nullptr) {
+		return;
+	}
+
+	void* block = static_cast<char*>(userBlock) - BLOCK_HEADER_BYTES;
+	uint64_t trackedSize = *static_cast<uint64_t*>(block);
+
+	if (trackedSize != 0) {
+		trackDeallocation(trackedSize);
+	}
+
+	free(block);
+
+}
+
+
+
+//Replacements for the global operators. The aligned (C++17 align_val_t) forms aren't replaced; nothing in this program over-aligns.
+
+void* operator new(size_t bytes) {
+	return countedAllocate(bytes);
+}
+
+void* operator new[](size_t bytes) {
+	return countedAllocate(bytes);
+}
+
+void* operator new(size_t bytes, const nothrow_t&) noexcept {
+
+	try {
+		return countedAllocate(bytes);
+	}
+
+	catch (...) {
+		return nullptr;
+	}
+
+}
+
+void* operator new[](size_t bytes, const nothrow_t&) noexcept {
+
+	try {
+		return countedAllocate(bytes);
+	}
+
+	catch (...) {
+		return nullptr;
+	}
+
+}
+
+void operator delete(void* block) noexcept {
+	countedFree(block);
+}
+
+void operator delete[](void* block) noexcept {
+	countedFree(block);
+}
+
+void operator delete(void* block, size_t) noexcept {
+	countedFree(block);
+}
+
+void operator delete[](void* block, size_t) noexcept {
+	countedFree(block);
+}
+
+void operator delete(void* block, const nothrow_t&) noexcept {
+	countedFree(block);
+}
+
+void operator delete[](void* block, const nothrow_t&) noexcept {
+	countedFree(block);
+}
+
+
+
+AllocationSnapshot getAllocationSnapshot() {
+
+	return AllocationSnapshot{ trackedTotals.allocations.load(memory_order_relaxed), trackedTotals.bytes.load(memory_order_relaxed) };
+
+}
+
+AllocationSnapshot getAllocationsSince(const AllocationSnapshot& startSnapshot) {
+
+	AllocationSnapshot now = getAllocationSnapshot();
+
+	return AllocationSnapshot{ now.allocations - startSnapshot.allocations, now.bytesAllocated - startSnapshot.bytesAllocated };
+
+}
+
+
+
+void enableAllocationTracking() {
+
+	allocationTrackingEnabled = true;
+
+}
+
+
+
+AllocationTotals getAllocationTotals() {
+
+	return AllocationTotals{ trackedTotals.allocations.load(memory_order_relaxed), trackedTotals.bytes.load(memory_order_relaxed), trackedTotals.liveBytes.load(memory_order_relaxed), trackedTotals.peakLiveBytes.load(memory_order_relaxed) };
+
+}
+
+
+
+InvoiceAllocationSummary getInvoiceAllocationSummary() {
+
+	lock_guard <mutex> lock(invoiceSummaryMutex);
+
+	return invoiceSummary;
+
+}
+
+
+
+AllocationScope::AllocationScope() {
+
+	parent = nullptr;
+	active = allocationTrackingEnabled;
+	allocations = 0;
+	bytesAllocated = 0;
+	liveBytes = 0;
+	peakLiveBytes = 0;
+
+	if (active) {
+		parent = currentAllocationScope;
+		currentAllocationScope = this;
+	}
+
+}
+
+AllocationScope::~AllocationScope() {
+
+	close();
+
+}
+
+void AllocationScope::close() {
+
+	if (active) {
+		currentAllocationScope = parent;
+		active = false;
+	}
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function close (InvoiceAllocationScope) closes the scope first, so building the invoice's name below isn't counted against it, and then adds
+//it to the per-invoice summary. The lock is only taken once per invoice.
+//
+//*******************************************************************************************************************************************
+
+void InvoiceAllocationScope::close() {
+
+	if (!scope.isActive()) {
+		return;
+	}
+
+	scope.close();
+
+	lock_guard <mutex> lock(invoiceSummaryMutex);
+
+	invoiceSummary.numInvoices++;
+	invoiceSummary.totalAllocations += scope.getAllocations();
+	invoiceSummary.totalBytesAllocated += scope.getBytesAllocated();
+	invoiceSummary.totalPeakLiveBytes += scope.getPeakLiveBytes();
+
+	if (invoiceSummary.numInvoices == 1 || scope.getPeakLiveBytes() > invoiceSummary.maxPeakLiveBytes) {
+
+		invoiceSummary.maxPeakLiveBytes = scope.getPeakLiveBytes();
+		invoiceSummary.maxPeakInvoice.assign(invoiceName);
+
+		if (invoiceSequence > 0) {
+			invoiceSummary.maxPeakInvoice += " " + to_string(invoiceSequence);
+		}
+
+	}
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function getPeakResidentBytes asks the OS for the most physical memory the process has used at once. Linux reports ru_maxrss in KB and
+//macOS in bytes.
+//
+//*******************************************************************************************************************************************
+
+size_t getPeakResidentBytes() {
+
+#ifdef _WIN32
+
+	PROCESS_MEMORY_COUNTERS memoryCounters;
+
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &memoryCounters, sizeof(memoryCounters))) {
+		return memoryCounters.PeakWorkingSetSize;
+	}
+
+	return 0;
+
+#else
+
+	struct rusage usage;
+
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return 0;
+	}
+
+#ifdef __APPLE__
+	return static_cast<size_t>(usage.ru_maxrss);
+#else
+	return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+
+#endif
+
+}
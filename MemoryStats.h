@@ -0,0 +1,149 @@
+#ifndef MEMORYSTATS_H
+#define MEMORYSTATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+using namespace std;
+
+
+//MemoryStats replaces the global operator new and delete for the whole program (MemoryStats.cpp) and reads the process's peak resident set
+//size from the OS.
+//
+//Allocation tracking (the --memstats option, and the benchmark) counts every allocation with the real size of its block, watches operator
+//delete, and keeps live and peak live bytes for the whole process and for every AllocationScope open on the thread doing the allocating.
+//Scopes nest (an invoice scope around a stage scope), and an allocation counts toward every scope it happens inside. Live bytes in a scope
+//can go below zero if it frees memory that was allocated before it opened. Blocks allocated before tracking was turned on aren't counted
+//when they're freed either. Take a snapshot before and after something to see how many allocations it made. Tracking is off unless it's
+//turned on, and then new and delete pay for a single check of a flag and a small header on each block.
+
+struct AllocationSnapshot {
+
+	uint64_t allocations;
+	uint64_t bytesAllocated;
+
+};
+
+struct AllocationTotals {
+
+	uint64_t allocations;
+	uint64_t bytesAllocated; //Usable block sizes, so a little more than what was asked for.
+	int64_t liveBytes; //Net since tracking started.
+	int64_t peakLiveBytes;
+
+};
+
+struct InvoiceAllocationSummary {
+
+	uint64_t numInvoices;
+	uint64_t totalAllocations;
+	uint64_t totalBytesAllocated;
+	int64_t totalPeakLiveBytes; //Summed, for working out the average.
+	int64_t maxPeakLiveBytes;
+	string maxPeakInvoice; //Which invoice needed the most memory at once.
+
+};
+
+
+extern bool allocationTrackingEnabled; //Only set before any worker threads start.
+
+
+AllocationSnapshot getAllocationSnapshot(); //All zeros unless tracking is on.
+
+AllocationSnapshot getAllocationsSince(const AllocationSnapshot& startSnapshot);
+
+size_t getPeakResidentBytes(); //0 if the OS won't say.
+
+void enableAllocationTracking();
+
+AllocationTotals getAllocationTotals(); //Whole process, since tracking was turned on. All zeros if it never was.
+
+InvoiceAllocationSummary getInvoiceAllocationSummary();
+
+
+
+class AllocationScope {
+
+	private:
+
+		AllocationScope* parent;
+		bool active;
+		uint64_t allocations;
+		uint64_t bytesAllocated;
+		int64_t liveBytes;
+		int64_t peakLiveBytes;
+
+		friend uint64_t trackAllocation(void* block);
+		friend void trackDeallocation(uint64_t trackedSize);
+
+	public:
+
+		//Constructors and destructor
+
+		AllocationScope(); //See MemoryStats.cpp for definitions. Does nothing unless tracking is on.
+
+		~AllocationScope();
+
+		AllocationScope(const AllocationScope&) = delete;
+		AllocationScope& operator=(const AllocationScope&) = delete;
+
+
+		void close(); //Stops counting early. Scopes have to close in the reverse of the order they opened; the destructor does it otherwise.
+
+
+
+		//Accessors
+
+		bool isActive() const
+		{
+			return active;
+		}
+
+		uint64_t getAllocations() const
+		{
+			return allocations;
+		}
+
+		uint64_t getBytesAllocated() const
+		{
+			return bytesAllocated;
+		}
+
+		int64_t getPeakLiveBytes() const
+		{
+			return peakLiveBytes;
+		}
+
+};
+
+
+
+//An AllocationScope for one invoice (a file, or one transaction set out of an interchange). When it closes, its numbers go into the
+//per-invoice summary. The name has to stay valid until then.
+
+class InvoiceAllocationScope {
+
+	private:
+
+		AllocationScope scope;
+		string_view invoiceName;
+		size_t invoiceSequence; //Added to the name when it isn't 0, so a stream of transaction sets doesn't have to build a string each.
+
+	public:
+
+		//Constructors and destructor
+
+		InvoiceAllocationScope(string_view name, size_t sequence = 0) : invoiceName(name), invoiceSequence(sequence) {}
+
+		~InvoiceAllocationScope()
+		{
+			close();
+		}
+
+
+		void close(); //Records the invoice and stops counting. Safe to call more than once.
+
+};
+
+#endif
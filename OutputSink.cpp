@@ -0,0 +1,225 @@
+#include "OutputSink.h"
+#include <cerrno>
+#include <climits>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+
+#if !defined(_WIN32) && !defined(IOV_MAX)
+const int IOV_MAX = 1024;
+#endif
+
+
+void OutputSink::write(string_view text) {
+
+	if (text.empty()) {
+		return;
+	}
+
+	writeBytes(text.data(), text.size());
+	numWrites++;
+	bytesWritten += text.size();
+
+}
+
+
+
+void OutputSink::writeBatch(const vector <string_view>& pieces) {
+
+	size_t batchBytes = 0;
+
+	for (string_view piece : pieces) {
+		batchBytes += piece.size();
+	}
+
+	if (batchBytes == 0) {
+		return;
+	}
+
+	writePieces(pieces);
+	numWrites++;
+	bytesWritten += batchBytes;
+
+}
+
+
+
+void OutputSink::writePieces(const vector <string_view>& pieces) {
+
+	for (string_view piece : pieces) {
+
+		if (!piece.empty()) {
+			writeBytes(piece.data(), piece.size());
+		}
+
+	}
+
+}
+
+
+
+void StreamOutputSink::writeBytes(const char* data, size_t length) {
+
+	if (!out.write(data, static_cast<streamsize>(length))) {
+		throw string("ERROR. Could not write the rendered output.\n");
+	}
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function FdOutputSink::writeBytes keeps calling write() until everything is out. A pipe or a full disk can take less than asked for, and a
+//signal can interrupt it partway; both just mean going around again.
+//
+//*******************************************************************************************************************************************
+
+void FdOutputSink::writeBytes(const char* data, size_t length) {
+
+	while (length > 0) {
+
+#ifdef _WIN32
+		int written = _write(fileDescriptor, data, static_cast<unsigned>((length > INT_MAX) ? INT_MAX : length));
+#else
+		ssize_t written = ::write(fileDescriptor, data, length);
+#endif
+
+		if (written < 0 && errno == EINTR) {
+			continue;
+		}
+
+		if (written <= 0) {
+			throw string("ERROR. Could not write the rendered output.\n");
+		}
+
+		data += written;
+		length -= static_cast<size_t>(written);
+
+	}
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function FdOutputSink::writePieces sends a batch with writev(), IOV_MAX pieces at a time. After a short write it skips whatever went out
+//and carries on from the middle of the piece it stopped in.
+//
+//*******************************************************************************************************************************************
+
+void FdOutputSink::writePieces(const vector <string_view>& pieces) {
+
+#ifdef _WIN32
+
+	OutputSink::writePieces(pieces); //No writev; each piece is one _write.
+
+#else
+
+	vector <struct iovec> ioVectors;
+	size_t nextPiece = 0;
+
+	ioVectors.reserve((pieces.size() < static_cast<size_t>(IOV_MAX)) ? pieces.size() : static_cast<size_t>(IOV_MAX));
+
+	while (nextPiece < pieces.size()) {
+
+		ioVectors.clear();
+
+		for (; nextPiece < pieces.size() && ioVectors.size() < static_cast<size_t>(IOV_MAX); nextPiece++) {
+
+			if (!pieces[nextPiece].empty()) {
+				ioVectors.push_back(iovec{ const_cast<char*>(pieces[nextPiece].data()), pieces[nextPiece].size() });
+			}
+
+		}
+
+		size_t firstVector = 0;
+
+		while (firstVector < ioVectors.size()) {
+
+			ssize_t written = writev(fileDescriptor, ioVectors.data() + firstVector, static_cast<int>(ioVectors.size() - firstVector));
+
+			if (written < 0 && errno == EINTR) {
+				continue;
+			}
+
+			if (written <= 0) {
+				throw string("ERROR. Could not write the rendered output.\n");
+			}
+
+			size_t remaining = static_cast<size_t>(written);
+
+			while (firstVector < ioVectors.size() && remaining >= ioVectors[firstVector].iov_len) {
+				remaining -= ioVectors[firstVector].iov_len;
+				firstVector++;
+			}
+
+			if (remaining > 0) {
+				ioVectors[firstVector].iov_base = static_cast<char*>(ioVectors[firstVector].iov_base) + remaining;
+				ioVectors[firstVector].iov_len -= remaining;
+			}
+
+		}
+
+	}
+
+#endif
+
+}
+
+
+
+FileOutputSink::~FileOutputSink() {
+
+	close();
+
+}
+
+
+
+void FileOutputSink::open(const string& filePath, bool append) {
+
+	close();
+
+#ifdef _WIN32
+	fileDescriptor = _open(filePath.c_str(), _O_WRONLY | _O_CREAT | _O_BINARY | (append ? _O_APPEND : _O_TRUNC), _S_IREAD | _S_IWRITE);
+#else
+	fileDescriptor = ::open(filePath.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (append ? O_APPEND : O_TRUNC), 0644);
+#endif
+
+	if (fileDescriptor < 0) {
+		throw string("ERROR. Cannot open " + filePath + " for output.\n");
+	}
+
+	path = filePath;
+
+}
+
+
+
+void FileOutputSink::close() {
+
+	if (fileDescriptor >= 0) {
+
+#ifdef _WIN32
+		_close(fileDescriptor);
+#else
+		::close(fileDescriptor);
+#endif
+
+	}
+
+	fileDescriptor = -1;
+
+}
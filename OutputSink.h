@@ -0,0 +1,306 @@
+#ifndef OUTPUTSINK_H
+#define OUTPUTSINK_H
+
+#include <charconv>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+using namespace std;
+
+
+//Rendering is split in two: the renderers format a whole invoice into a RenderBuffer (plain appends into memory that's reserved once and
+//reused, no flushing), and then an OutputSink sends it wherever it's going in one write. A batch of invoices can go out in a single
+//writeBatch call, which is one writev() on a file descriptor.
+//
+//Sinks:
+//	ConsoleOutputSink - cout
+//	StreamOutputSink  - any ostream the caller already has open (an fstream, an ostringstream)
+//	FdOutputSink      - a file descriptor someone else opened (1 for stdout, a pipe, a socket)
+//	FileOutputSink    - a file it opens itself; an FdOutputSink underneath
+//	MemoryOutputSink  - a string, for callers that want the text back
+
+const size_t DEFAULT_RENDER_BUFFER_BYTES = 16384; //Comfortably more than one rendered sample invoice, so one reserve covers it.
+
+
+class RenderBuffer {
+
+	private:
+
+		string text;
+
+	public:
+
+		//Constructors and destructor
+
+		RenderBuffer(size_t initialCapacity = DEFAULT_RENDER_BUFFER_BYTES)
+		{
+			text.reserve(initialCapacity);
+		}
+
+		~RenderBuffer() {}
+
+
+		void clear() //Keeps the capacity for the next invoice.
+		{
+			text.clear();
+		}
+
+		void reserve(size_t capacity)
+		{
+			text.reserve(capacity);
+		}
+
+		string release() //Hands the text over without copying; the buffer starts over empty.
+		{
+			string released;
+			released.swap(text);
+			return released;
+		}
+
+
+		RenderBuffer& operator<<(string_view value)
+		{
+			text.append(value.data(), value.size());
+			return *this;
+		}
+
+		RenderBuffer& operator<<(const char* value)
+		{
+			text.append(value);
+			return *this;
+		}
+
+		RenderBuffer& operator<<(const string& value)
+		{
+			text.append(value);
+			return *this;
+		}
+
+		RenderBuffer& operator<<(char value)
+		{
+			text.push_back(value);
+			return *this;
+		}
+
+		template <typename Integer, typename = enable_if_t<is_integral_v<Integer>>>
+		RenderBuffer& operator<<(Integer value)
+		{
+			char digits[24];
+			to_chars_result converted = to_chars(digits, digits + sizeof(digits), value);
+			text.append(digits, converted.ptr - digits);
+			return *this;
+		}
+
+
+
+		//Accessors
+
+		string_view getView() const
+		{
+			return text;
+		}
+
+		const string& getText() const
+		{
+			return text;
+		}
+
+		size_t getSize() const
+		{
+			return text.size();
+		}
+
+		bool isEmpty() const
+		{
+			return text.empty();
+		}
+
+};
+
+
+class OutputSink {
+
+	protected:
+
+		uint64_t numWrites;
+		uint64_t bytesWritten;
+
+		virtual void writeBytes(const char* data, size_t length) = 0;
+
+		virtual void writePieces(const vector <string_view>& pieces); //Default is one writeBytes per piece; FdOutputSink overrides it with writev.
+
+	public:
+
+		//Constructors and destructor
+
+		OutputSink()
+		{
+			numWrites = 0;
+			bytesWritten = 0;
+		}
+
+		virtual ~OutputSink() {}
+
+		OutputSink(const OutputSink&) = delete;
+		OutputSink& operator=(const OutputSink&) = delete;
+
+
+		void write(string_view text); //Throws a string if the destination won't take it.
+
+		void write(const RenderBuffer& buffer)
+		{
+			write(buffer.getView());
+		}
+
+		void writeBatch(const vector <string_view>& pieces); //Every piece, in order, as one write where the destination allows it.
+
+		virtual void flush() {}
+
+
+
+		//Accessors
+
+		uint64_t getNumWrites() const
+		{
+			return numWrites;
+		}
+
+		uint64_t getBytesWritten() const
+		{
+			return bytesWritten;
+		}
+
+};
+
+
+class StreamOutputSink : public OutputSink {
+
+	private:
+
+		ostream& out;
+
+	protected:
+
+		void writeBytes(const char* data, size_t length) override;
+
+	public:
+
+		StreamOutputSink(ostream& destination) : out(destination) {}
+
+		void flush() override
+		{
+			out.flush();
+		}
+
+};
+
+
+class ConsoleOutputSink : public StreamOutputSink {
+
+	public:
+
+		ConsoleOutputSink() : StreamOutputSink(cout) {}
+
+};
+
+
+class FdOutputSink : public OutputSink {
+
+	protected:
+
+		int fileDescriptor;
+
+		void writeBytes(const char* data, size_t length) override;
+
+		void writePieces(const vector <string_view>& pieces) override;
+
+	public:
+
+		FdOutputSink(int descriptor = -1)
+		{
+			fileDescriptor = descriptor;
+		}
+
+		int getFileDescriptor() const
+		{
+			return fileDescriptor;
+		}
+
+};
+
+
+class FileOutputSink : public FdOutputSink {
+
+	private:
+
+		string path;
+
+	public:
+
+		//Constructors and destructor
+
+		FileOutputSink() {}
+
+		FileOutputSink(const string& filePath, bool append = false) //Throws a string if the file can't be opened.
+		{
+			open(filePath, append);
+		}
+
+		~FileOutputSink();
+
+
+		void open(const string& filePath, bool append = false); //Throws a string if the file can't be opened.
+
+		void close();
+
+
+
+		//Accessors
+
+		bool isOpen() const
+		{
+			return fileDescriptor >= 0;
+		}
+
+		const string& getPath() const
+		{
+			return path;
+		}
+
+};
+
+
+class MemoryOutputSink : public OutputSink {
+
+	private:
+
+		string contents;
+
+	protected:
+
+		void writeBytes(const char* data, size_t length) override
+		{
+			contents.append(data, length);
+		}
+
+	public:
+
+		MemoryOutputSink() {}
+
+
+		void clear()
+		{
+			contents.clear();
+		}
+
+		const string& getContents() const
+		{
+			return contents;
+		}
+
+};
+
+#endif
@@ -0,0 +1,226 @@
+#include "ParallelTokenizer.h"
+#include <algorithm>
+#include <cstring>
+using namespace std;
+
+
+ParallelTokenizer::ParallelTokenizer() {
+
+	minChunkBytes = 1024 * 1024;
+	chunksPerThread = 4;
+	numChunksUsed = 0;
+
+}
+
+ParallelTokenizer::ParallelTokenizer(unsigned threadCount) : pool(threadCount) {
+
+	minChunkBytes = 1024 * 1024;
+	chunksPerThread = 4;
+	numChunksUsed = 0;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function findSplitPoints aims for evenly sized chunks, then slides each cut forward to the next segment terminator with memchr, which only
+//ever touches the few bytes between the aim point and the end of that segment. The cut goes after the terminator and any CR/LF wrapping it,
+//the same bytes EdiTokenizer skips between segments. A cut that would leave a chunk starting on a space, a tab, a byte-order mark, or an
+//empty segment is slid along to the next terminator instead, since the tokenizer would trim those off the front of a buffer but not off the
+//front of a segment.
+//
+//*******************************************************************************************************************************************
+
+void ParallelTokenizer::findSplitPoints(string_view contents, const EdiDelimiters& delimiters, size_t numChunks, vector <size_t>& splitPoints) {
+
+	splitPoints.clear();
+	splitPoints.push_back(0);
+
+	for (size_t i = 1; i < numChunks; i++) {
+
+		size_t searchFrom = contents.size() / numChunks * i;
+
+		if (searchFrom < splitPoints.back()) {
+			searchFrom = splitPoints.back();
+		}
+
+		size_t splitPoint = contents.size();
+
+		while (searchFrom < contents.size()) {
+
+			const void* terminator = memchr(contents.data() + searchFrom, delimiters.segment, contents.size() - searchFrom);
+
+			if (terminator == nullptr) {
+				break;
+			}
+
+			size_t candidate = static_cast<const char*>(terminator) - contents.data() + 1;
+
+			while (candidate < contents.size() && (contents[candidate] == '\r' || contents[candidate] == '\n') && contents[candidate] != delimiters.element && contents[candidate] != delimiters.segment) {
+				candidate++;
+			}
+
+			char next = (candidate < contents.size()) ? contents[candidate] : '\0';
+
+			if (next == ' ' || next == '\t' || next == '\r' || next == '\n' || next == '\xEF' || next == delimiters.segment) {
+				searchFrom = candidate + (candidate < contents.size() && next == delimiters.segment); //Step over an empty segment's terminator so memchr doesn't stop on it again.
+				continue;
+			}
+
+			splitPoint = candidate;
+			break;
+
+		}
+
+		if (splitPoint >= contents.size()) { //Nothing left to cut; the last chunk runs to the end.
+			return;
+		}
+
+		splitPoints.push_back(splitPoint);
+
+	}
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function tokenize settles on the separators the way EdiTokenizer::tokenize would, cuts the buffer, and tokenizes the chunks on the pool.
+//Anything too small to be worth splitting just goes straight to invoiceTokenizer.tokenize. Chunks are handed out largest-first so a
+//chunk that ran long because of where its terminator fell starts early.
+//
+//*******************************************************************************************************************************************
+
+void ParallelTokenizer::tokenize(string_view contents, EdiTokenizer& invoiceTokenizer) {
+
+	size_t numChunks = static_cast<size_t>(pool.getNumThreads()) * chunksPerThread;
+
+	if (contents.size() / minChunkBytes < numChunks) {
+		numChunks = contents.size() / minChunkBytes;
+	}
+
+	if (pool.getNumThreads() <= 1 || numChunks <= 1) {
+
+		invoiceTokenizer.tokenize(contents);
+		numChunksUsed = 1;
+		return;
+
+	}
+
+	EdiDelimiters chunkDelimiters = invoiceTokenizer.configuredDelimiters;
+
+	if (invoiceTokenizer.autoDetectDelimiters) {
+		detectDelimiters(contents, chunkDelimiters);
+	}
+
+	findSplitPoints(contents, chunkDelimiters, numChunks, chunkStarts);
+	numChunksUsed = chunkStarts.size();
+
+	if (numChunksUsed <= 1) {
+
+		invoiceTokenizer.tokenize(contents);
+		return;
+
+	}
+
+	while (chunkTokenizers.size() < numChunksUsed) {
+		chunkTokenizers.push_back(make_unique<EdiTokenizer>());
+	}
+
+	vector <size_t> taskOrder(numChunksUsed);
+
+	for (size_t i = 0; i < numChunksUsed; i++) {
+
+		chunkTokenizers[i]->setScanPath(invoiceTokenizer.getScanner().getScanPath());
+		chunkTokenizers[i]->setAutoDetectDelimiters(false); //A chunk from the middle of the file has no header, and the one at the front already had its say.
+		chunkTokenizers[i]->setDelimiters(chunkDelimiters);
+		taskOrder[i] = i;
+
+	}
+
+	chunkStarts.push_back(contents.size()); //So chunk i always runs from chunkStarts[i] to chunkStarts[i + 1].
+
+	stable_sort(taskOrder.begin(), taskOrder.end(), [this](size_t left, size_t right) {
+		return chunkStarts[left + 1] - chunkStarts[left] > chunkStarts[right + 1] - chunkStarts[right];
+	});
+
+	pool.run(taskOrder, [this, contents](size_t chunk) {
+		chunkTokenizers[chunk]->tokenize(contents.substr(chunkStarts[chunk], chunkStarts[chunk + 1] - chunkStarts[chunk]));
+	});
+
+	mergeChunks(contents, chunkDelimiters, invoiceTokenizer);
+
+	chunkStarts.pop_back();
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function mergeChunks works out where each chunk's segments and elements land in the combined tables from running totals, then has every
+//chunk copy its own tables into place in parallel. Segment and element offsets move up by the chunk's start in the buffer, and each
+//segment's firstElement moves up by the number of elements in the chunks before it. Observers are run last, in order, on the calling thread.
+//
+//*******************************************************************************************************************************************
+
+void ParallelTokenizer::mergeChunks(string_view contents, const EdiDelimiters& chunkDelimiters, EdiTokenizer& invoiceTokenizer) {
+
+	vector <size_t> segmentBase(numChunksUsed + 1, 0);
+	vector <size_t> elementBase(numChunksUsed + 1, 0);
+	vector <size_t> taskOrder(numChunksUsed);
+
+	for (size_t i = 0; i < numChunksUsed; i++) {
+
+		segmentBase[i + 1] = segmentBase[i] + chunkTokenizers[i]->getNumSegments();
+		elementBase[i + 1] = elementBase[i] + chunkTokenizers[i]->getNumElements();
+		taskOrder[i] = i;
+
+	}
+
+	invoiceTokenizer.useDelimiters(chunkDelimiters);
+	invoiceTokenizer.buffer = contents;
+	invoiceTokenizer.delimiterPositions.clear();
+	invoiceTokenizer.segments.resize(segmentBase[numChunksUsed]);
+	invoiceTokenizer.elements.resize(elementBase[numChunksUsed]);
+
+	pool.run(taskOrder, [&](size_t chunk) {
+
+		const EdiTokenizer& chunkTokenizer = *chunkTokenizers[chunk];
+		size_t offsetShift = chunkStarts[chunk];
+
+		for (size_t i = 0; i < chunkTokenizer.getNumSegments(); i++) {
+
+			SegmentSpan segment = chunkTokenizer.getSegment(i);
+
+			segment.offset += offsetShift;
+			segment.firstElement += elementBase[chunk];
+			invoiceTokenizer.segments[segmentBase[chunk] + i] = segment;
+
+		}
+
+		for (size_t i = 0; i < chunkTokenizer.getNumElements(); i++) {
+
+			const ElementSpan& element = chunkTokenizer.getElement(i);
+
+			invoiceTokenizer.elements[elementBase[chunk] + i] = { element.offset + offsetShift, element.length };
+
+		}
+
+	});
+
+	for (SegmentObserver* observer : invoiceTokenizer.observers) {
+
+		observer->beginDocument(invoiceTokenizer);
+
+		for (size_t i = 0; i < invoiceTokenizer.segments.size(); i++) {
+			observer->onSegment(invoiceTokenizer, i);
+		}
+
+		observer->endDocument(invoiceTokenizer);
+
+	}
+
+}
@@ -0,0 +1,80 @@
+#ifndef PARALLELTOKENIZER_H
+#define PARALLELTOKENIZER_H
+
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "EdiTokenizer.h"
+#include "WorkStealingPool.h"
+using namespace std;
+
+
+//The ParallelTokenizer class tokenizes one big interchange on every core. The buffer is cut into chunks at segment terminators (so no
+//segment is ever split between two chunks), each chunk is tokenized by its own EdiTokenizer on the WorkStealingPool, and the per-chunk
+//segment and element tables are then copied into the caller's EdiTokenizer with their offsets and element numbers shifted to where the chunk
+//starts. The result is exactly what a single EdiTokenizer::tokenize call on the whole buffer would have given, so everything downstream
+//(the document store, element index, populate functions) can't tell the difference.
+//
+//The separators are read once from the header at the front of the buffer and handed to every chunk. SegmentObservers on the caller's
+//tokenizer still hear about every segment in document order; they're run over the merged tables once the chunks are done.
+
+class ParallelTokenizer {
+
+	private:
+
+		WorkStealingPool pool;
+		size_t minChunkBytes; //Buffers smaller than two of these aren't split at all.
+		unsigned chunksPerThread; //More chunks than threads lets a thread that finishes early steal the slack.
+		vector <unique_ptr<EdiTokenizer>> chunkTokenizers; //Kept between calls so their tables don't have to grow from nothing every time.
+		vector <size_t> chunkStarts;
+		size_t numChunksUsed;
+
+		void mergeChunks(string_view contents, const EdiDelimiters& chunkDelimiters, EdiTokenizer& invoiceTokenizer);
+
+	public:
+
+		//Constructors and destructor
+
+		ParallelTokenizer(); //See ParallelTokenizer.cpp for definitions. Uses one thread per core.
+
+		ParallelTokenizer(unsigned threadCount);
+
+		~ParallelTokenizer() {}
+
+
+		void tokenize(string_view contents, EdiTokenizer& invoiceTokenizer); //Leaves invoiceTokenizer as if invoiceTokenizer.tokenize(contents) had been called.
+
+		//Fills splitPoints with the start offset of each chunk (the first is always 0). Every split lands just past a segment terminator and
+		//any line breaks wrapping it, so each chunk starts on a segment ID. Fewer than numChunks come back if there aren't enough terminators.
+		static void findSplitPoints(string_view contents, const EdiDelimiters& delimiters, size_t numChunks, vector <size_t>& splitPoints);
+
+
+
+		//Mutators
+
+		void setMinChunkBytes(size_t bytes)
+		{
+			minChunkBytes = (bytes == 0) ? 1 : bytes;
+		}
+
+		void setChunksPerThread(unsigned chunks)
+		{
+			chunksPerThread = (chunks == 0) ? 1 : chunks;
+		}
+
+
+		//Accessors
+
+		unsigned getNumThreads() const
+		{
+			return pool.getNumThreads();
+		}
+
+		size_t getNumChunksUsed() const //How many chunks the last tokenize call split the buffer into (1 means it ran serially).
+		{
+			return numChunksUsed;
+		}
+
+};
+
+#endif
@@ -0,0 +1,271 @@
+#include "PipelineStats.h"
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+using namespace std;
+
+
+bool pipelineStatsEnabled = false;
+
+
+//One cache line per stage, so workers finishing different stages at the same moment don't fight over the same line.
+
+struct alignas(64) StageTotals {
+
+	atomic <uint64_t> calls;
+	atomic <uint64_t> nanoseconds;
+	atomic <uint64_t> maxNanoseconds; //Longest single span, for spotting one slow invoice in a batch of fast ones.
+	atomic <uint64_t> bytes;
+	atomic <uint64_t> segments;
+	atomic <uint64_t> elements;
+	atomic <uint64_t> allocations; //The rest only move with allocation tracking on.
+	atomic <uint64_t> bytesAllocated;
+	atomic <int64_t> peakLiveBytes; //Most a single span had live at once.
+
+};
+
+static StageTotals stageTotals[NUM_PIPELINE_STAGES];
+static atomic <uint64_t> elementLookups{ 0 };
+static chrono::steady_clock::time_point statsStartTime;
+
+
+void enablePipelineStats() {
+
+	resetPipelineStats();
+	pipelineStatsEnabled = true;
+
+}
+
+
+
+void resetPipelineStats() {
+
+	for (StageTotals& totals : stageTotals) {
+		totals.calls = 0;
+		totals.nanoseconds = 0;
+		totals.maxNanoseconds = 0;
+		totals.bytes = 0;
+		totals.segments = 0;
+		totals.elements = 0;
+		totals.allocations = 0;
+		totals.bytesAllocated = 0;
+		totals.peakLiveBytes = 0;
+	}
+
+	elementLookups = 0;
+	statsStartTime = chrono::steady_clock::now();
+
+}
+
+
+
+void recordStageSpan(PipelineStage stage, uint64_t nanoseconds, uint64_t bytes, uint64_t segments, uint64_t elements) {
+
+	StageTotals& totals = stageTotals[stage];
+	uint64_t longest = totals.maxNanoseconds.load(memory_order_relaxed);
+
+	totals.calls.fetch_add(1, memory_order_relaxed);
+	totals.nanoseconds.fetch_add(nanoseconds, memory_order_relaxed);
+	totals.bytes.fetch_add(bytes, memory_order_relaxed);
+	totals.segments.fetch_add(segments, memory_order_relaxed);
+	totals.elements.fetch_add(elements, memory_order_relaxed);
+
+	while (nanoseconds > longest && !totals.maxNanoseconds.compare_exchange_weak(longest, nanoseconds, memory_order_relaxed)) {
+		//compare_exchange_weak reloaded longest; try again only while this span is still the longest.
+	}
+
+}
+
+
+
+void recordStageAllocations(PipelineStage stage, const AllocationScope& scope) {
+
+	StageTotals& totals = stageTotals[stage];
+	int64_t peakLiveBytes = scope.getPeakLiveBytes();
+	int64_t largest = totals.peakLiveBytes.load(memory_order_relaxed);
+
+	totals.allocations.fetch_add(scope.getAllocations(), memory_order_relaxed);
+	totals.bytesAllocated.fetch_add(scope.getBytesAllocated(), memory_order_relaxed);
+
+	while (peakLiveBytes > largest && !totals.peakLiveBytes.compare_exchange_weak(largest, peakLiveBytes, memory_order_relaxed)) {
+		//Same as maxNanoseconds above.
+	}
+
+}
+
+
+
+void recordElementLookup() {
+
+	elementLookups.fetch_add(1, memory_order_relaxed);
+
+}
+
+
+
+const char* getPipelineStageName(PipelineStage stage) {
+
+	switch (stage) {
+
+	case STAGE_READ_INPUT:
+		return "read_input";
+
+	case STAGE_TOKENIZE:
+		return "tokenize";
+
+	case STAGE_POPULATE_SEGMENTS:
+		return "populate_segments";
+
+	case STAGE_POPULATE_ELEMENTS:
+		return "populate_elements";
+
+	case STAGE_BUILD_DOCUMENT_STORE:
+		return "build_document_store";
+
+	case STAGE_BUILD_ELEMENT_INDEX:
+		return "build_element_index";
+
+	case STAGE_BUILD_LOOP_TREE:
+		return "build_loop_tree";
+
+	case STAGE_RENDER_HUMAN:
+		return "render_human";
+
+	case STAGE_RENDER_MACHINE:
+		return "render_machine";
+
+	case STAGE_WRITE_X12:
+		return "write_x12";
+
+	default:
+		return "unknown";
+
+	}
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function writePipelineStatsReport writes every stage's totals, in pipeline order, whether or not the stage ran, so the columns and keys are
+//the same from one run to the next. The JSON is one object with the wall-clock time since stats were turned on, the lookup count, and a
+//"stages" array. The CSV has one row per stage under a header, then a "wall" row (with the whole process's allocation numbers) and an
+//"element_lookups" row (count in the calls column). Allocation numbers are 0 unless allocation tracking was on.
+//
+//*******************************************************************************************************************************************
+
+void writePipelineStatsReport(ostream& out, PipelineStatsFormat format) {
+
+	double wallSeconds = chrono::duration<double>(chrono::steady_clock::now() - statsStartTime).count();
+	uint64_t numLookups = elementLookups.load(memory_order_relaxed);
+	AllocationTotals processTotals = getAllocationTotals();
+
+	out << fixed << setprecision(6);
+
+	if (format == STATS_CSV) {
+		out << "stage,calls,seconds,max_span_seconds,bytes,segments,elements,allocations,bytes_allocated,peak_live_bytes\n";
+	}
+
+	else {
+		out << "{\n  \"wallSeconds\": " << wallSeconds << ",\n  \"elementLookups\": " << numLookups << ",\n";
+		out << "  \"allocations\": " << processTotals.allocations << ",\n  \"bytesAllocated\": " << processTotals.bytesAllocated << ",\n  \"peakLiveBytes\": " << processTotals.peakLiveBytes << ",\n  \"stages\": [\n";
+	}
+
+	for (size_t i = 0; i < NUM_PIPELINE_STAGES; i++) {
+
+		const StageTotals& totals = stageTotals[i];
+		const char* name = getPipelineStageName(static_cast<PipelineStage>(i));
+		double seconds = totals.nanoseconds.load(memory_order_relaxed) / 1e9;
+		double maxSpanSeconds = totals.maxNanoseconds.load(memory_order_relaxed) / 1e9;
+
+		if (format == STATS_CSV) {
+			out << name << ',' << totals.calls.load() << ',' << seconds << ',' << maxSpanSeconds << ',' << totals.bytes.load() << ',' << totals.segments.load() << ',' << totals.elements.load();
+			out << ',' << totals.allocations.load() << ',' << totals.bytesAllocated.load() << ',' << totals.peakLiveBytes.load() << '\n';
+		}
+
+		else {
+			out << "    { \"stage\": \"" << name << "\", \"calls\": " << totals.calls.load() << ", \"seconds\": " << seconds << ", \"maxSpanSeconds\": " << maxSpanSeconds;
+			out << ", \"bytes\": " << totals.bytes.load() << ", \"segments\": " << totals.segments.load() << ", \"elements\": " << totals.elements.load();
+			out << ", \"allocations\": " << totals.allocations.load() << ", \"bytesAllocated\": " << totals.bytesAllocated.load() << ", \"peakLiveBytes\": " << totals.peakLiveBytes.load() << " }";
+			out << ((i + 1 < NUM_PIPELINE_STAGES) ? ",\n" : "\n");
+		}
+
+	}
+
+	if (format == STATS_CSV) {
+		out << "wall,1," << wallSeconds << ',' << wallSeconds << ",0,0,0," << processTotals.allocations << ',' << processTotals.bytesAllocated << ',' << processTotals.peakLiveBytes << '\n';
+		out << "element_lookups," << numLookups << ",0,0,0,0,0,0,0,0\n";
+	}
+
+	else {
+		out << "  ]\n}\n";
+	}
+
+}
+
+
+
+bool writePipelineStatsReport(const string& path) {
+
+	bool csv = path.length() >= 4 && path.compare(path.length() - 4, 4, ".csv") == 0;
+	ofstream reportFile(path, ios::out | ios::trunc);
+
+	if (!reportFile) {
+		return false;
+	}
+
+	writePipelineStatsReport(reportFile, csv ? STATS_CSV : STATS_JSON);
+	reportFile.flush();
+
+	return static_cast<bool>(reportFile);
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function displayMemorySummary prints what allocation tracking found: a line per stage that allocated anything, the per-invoice averages
+//and the single worst invoice, and for the process as a whole the peak live heap, the net bytes still allocated when this ran (anything
+//leaked shows up here, along with static objects), and the peak resident set from the OS. Only blocks allocated after tracking started
+//are in the net figure, whenever they're freed.
+//
+//*******************************************************************************************************************************************
+
+void displayMemorySummary(ostream& out) {
+
+	const double MB = 1024.0 * 1024.0;
+	AllocationTotals processTotals = getAllocationTotals();
+	InvoiceAllocationSummary invoices = getInvoiceAllocationSummary();
+
+	out << "Memory accounting (heap blocks through operator new/delete):" << endl;
+	out << left << setw(24) << "Stage" << right << setw(16) << "Allocations" << setw(16) << "Allocated MB" << setw(16) << "Peak live MB" << endl;
+
+	for (size_t i = 0; i < NUM_PIPELINE_STAGES; i++) {
+
+		const StageTotals& totals = stageTotals[i];
+
+		if (totals.allocations.load() == 0 && totals.peakLiveBytes.load() == 0) {
+			continue;
+		}
+
+		out << left << setw(24) << getPipelineStageName(static_cast<PipelineStage>(i)) << right << setw(16) << totals.allocations.load();
+		out << fixed << setprecision(3) << setw(16) << totals.bytesAllocated.load() / MB << setw(16) << totals.peakLiveBytes.load() / MB << endl;
+
+	}
+
+	if (invoices.numInvoices > 0) {
+
+		out << fixed << setprecision(3);
+		out << "Invoices: " << invoices.numInvoices << ", on average " << invoices.totalAllocations / invoices.numInvoices << " allocations, ";
+		out << invoices.totalBytesAllocated / MB / invoices.numInvoices << " MB allocated and " << invoices.totalPeakLiveBytes / MB / invoices.numInvoices << " MB peak live each." << endl;
+		out << "Largest invoice: " << invoices.maxPeakInvoice << " at " << invoices.maxPeakLiveBytes / MB << " MB peak live." << endl;
+
+	}
+
+	out << fixed << setprecision(3);
+	out << "Process: " << processTotals.allocations << " allocations, " << processTotals.bytesAllocated / MB << " MB allocated, " << processTotals.peakLiveBytes / MB << " MB peak live, ";
+	out << processTotals.liveBytes / MB << " MB net still allocated, " << getPeakResidentBytes() / MB << " MB peak resident." << endl;
+
+}
@@ -0,0 +1,122 @@
+#ifndef PIPELINESTATS_H
+#define PIPELINESTATS_H
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include "MemoryStats.h"
+using namespace std;
+
+
+//PipelineStats is the instrumentation compiled into every stage an invoice goes through. Each stage opens a StageSpan, which reads the
+//monotonic clock on the way in and out and adds the time, plus however many bytes, segments and elements it got through, to that stage's
+//totals. Element lookups are counted on their own, since timing each one would cost more than the lookup does.
+//
+//It's all off unless enablePipelineStats is called (the --stats option), and while it's off a span is a check of two bools and nothing else:
+//no clock reads and no shared counters touched. When it's on, the totals are relaxed atomics, so batch and parallel workers can all add to
+//them at once. Time from several threads is summed, so a stage that ran on eight cores can show more seconds than the run took. The report
+//is JSON or CSV so it can go straight into a dashboard.
+//
+//Each span is also an AllocationScope, so with allocation tracking on (--memstats) every stage gets its allocations, bytes and peak live
+//bytes as well. Those show up in the report and in displayMemorySummary.
+
+enum PipelineStage {
+
+	STAGE_READ_INPUT,				//EdiInputFile::open, or EnvelopeStreamParser handing back a transaction set.
+	STAGE_TOKENIZE,					//EdiTokenizer::tokenize, including any SegmentObservers (schema validation, TDS01 reconciliation).
+	STAGE_POPULATE_SEGMENTS,		//populateInvoiceDocumentStructureArr
+	STAGE_POPULATE_ELEMENTS,		//populateElementDataVect
+	STAGE_BUILD_DOCUMENT_STORE,		//InvoiceDocumentStore::build
+	STAGE_BUILD_ELEMENT_INDEX,		//ElementIndex::build
+	STAGE_BUILD_LOOP_TREE,			//InvoiceLoopTree::build
+	STAGE_RENDER_HUMAN,				//appendInvoiceForHumans; bytes are what it wrote.
+	STAGE_RENDER_MACHINE,			//appendInvoiceForMachines; bytes are what it wrote.
+	STAGE_WRITE_X12,				//EdiWriter::write; bytes are what it wrote, elements only count when they were copied one at a time.
+	NUM_PIPELINE_STAGES
+
+};
+
+enum PipelineStatsFormat { STATS_JSON, STATS_CSV };
+
+
+extern bool pipelineStatsEnabled; //Only set before any worker threads start.
+
+
+void enablePipelineStats();
+
+void resetPipelineStats();
+
+void recordStageSpan(PipelineStage stage, uint64_t nanoseconds, uint64_t bytes, uint64_t segments, uint64_t elements);
+
+void recordElementLookup();
+
+void recordStageAllocations(PipelineStage stage, const AllocationScope& scope);
+
+const char* getPipelineStageName(PipelineStage stage); //"tokenize", "render_human", and so on; the names used in the report.
+
+void writePipelineStatsReport(ostream& out, PipelineStatsFormat format);
+
+bool writePipelineStatsReport(const string& path); //CSV if the path ends in ".csv", JSON otherwise. False if the file can't be written.
+
+void displayMemorySummary(ostream& out); //Per stage, per invoice, and for the whole process. Only has numbers if allocation tracking was on.
+
+
+inline void countElementLookup() {
+
+	if (pipelineStatsEnabled) {
+		recordElementLookup();
+	}
+
+}
+
+
+
+class StageSpan {
+
+	private:
+
+		PipelineStage stage;
+		bool active;
+		chrono::steady_clock::time_point startTime;
+		uint64_t bytes;
+		uint64_t segments;
+		uint64_t elements;
+		AllocationScope allocationScope;
+
+	public:
+
+		//Constructors and destructor
+
+		explicit StageSpan(PipelineStage spanStage) : stage(spanStage), active(pipelineStatsEnabled), bytes(0), segments(0), elements(0)
+		{
+			if (active) {
+				startTime = chrono::steady_clock::now();
+			}
+		}
+
+		~StageSpan()
+		{
+			if (active) {
+				recordStageSpan(stage, static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - startTime).count()), bytes, segments, elements);
+			}
+
+			if (allocationScope.isActive()) {
+				recordStageAllocations(stage, allocationScope);
+			}
+		}
+
+		StageSpan(const StageSpan&) = delete;
+		StageSpan& operator=(const StageSpan&) = delete;
+
+
+		void addWork(uint64_t numBytes, uint64_t numSegments, uint64_t numElements) //Plain adds, so it's fine to call whether or not stats are on.
+		{
+			bytes += numBytes;
+			segments += numSegments;
+			elements += numElements;
+		}
+
+};
+
+#endif
@@ -1,7 +1,9 @@
 #ifndef SCHEMA_H
 #define SCHEMA_H
 
-#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
 using namespace std;
 
 /*
@@ -18,16 +20,19 @@ https://edi.kroger.com/EDIPortal/documents/Maps/kroger-modernized-systems/Kroger
 enum DocLocation{ HEADING, DETAIL, SUMMARY };
 enum Required{ MANDATORY, OPTIONAL, CONDITIONAL };
 
+//Everything in here is constexpr with string_view text, so all of the schema is baked into the program at compile time -- nothing has to
+//be constructed at startup, and the lookup tables at the bottom of the file can be built by the compiler too.
+
 struct Invoice {
 
 	DocLocation placement;
-	string id;
+	string_view id;
 	int pos;
-	string name;
+	string_view name;
 	Required reqIndicator;
 	int maxUse;
 	int repeatLimit;
-	string loopID;
+	string_view loopID;
 
 };
 
@@ -36,27 +41,27 @@ struct Invoice {
 
 //Heading Invoices:
 
-Invoice seg_ST_heading{ HEADING, "ST", 0000, "Transaction Set Header", MANDATORY, 1, 1, "None" }; //ST segment is not defined in Kroger's IC, but it is convention... It is metadata about the transaction marking the beginning of the file, just as SE segment is not defined and is the trailer for the file. Think of it as an envelope for contents.
-Invoice seg_BIG_heading{ HEADING, "BIG", 0200, "Beginning Segment for Invoice", MANDATORY, 1, 0, "None" };
-Invoice seg_CUR_heading{ HEADING, "CUR", 0400, "Currency", OPTIONAL, 1, 0 };
-Invoice seg_N1_heading_loop1{ HEADING, "N1", 0700, "Party Identification", OPTIONAL, 1, 200, "N1" };
-Invoice seg_N1_heading_loop2{ HEADING, "N1", 0700, "Party Identification", OPTIONAL, 1, 200, "N1" };
-Invoice seg_ITD_heading{ HEADING, "ITD", 1300, "Terms of Sale/Deferred Terms of Sale", OPTIONAL, 999, 0, "None" };
+constexpr Invoice seg_ST_heading{ HEADING, "ST", 0, "Transaction Set Header", MANDATORY, 1, 1, "None" }; //ST segment is not defined in Kroger's IC, but it is convention... It is metadata about the transaction marking the beginning of the file, just as SE segment is not defined and is the trailer for the file. Think of it as an envelope for contents.
+constexpr Invoice seg_BIG_heading{ HEADING, "BIG", 200, "Beginning Segment for Invoice", MANDATORY, 1, 0, "None" };
+constexpr Invoice seg_CUR_heading{ HEADING, "CUR", 400, "Currency", OPTIONAL, 1, 0, "None" };
+constexpr Invoice seg_N1_heading_loop1{ HEADING, "N1", 700, "Party Identification", OPTIONAL, 1, 200, "N1" };
+constexpr Invoice seg_N1_heading_loop2{ HEADING, "N1", 700, "Party Identification", OPTIONAL, 1, 200, "N1" };
+constexpr Invoice seg_ITD_heading{ HEADING, "ITD", 1300, "Terms of Sale/Deferred Terms of Sale", OPTIONAL, 999, 0, "None" };
 
 
 //Detail Invoices:
 
-Invoice seg_IT1_detail{ DETAIL, "IT1", 0100, "Baseline Item Data (Invoice)", OPTIONAL, 1, 0, "IT1" };
-Invoice seg_IT3_detail{ DETAIL, "IT3", 0300, "Additional Item Data", OPTIONAL, 5, 0, "IT1" };
-Invoice seg_SAC_detail{ DETAIL, "SAC", 1800, "Service, Promotion, Allowance, or Charge Information", OPTIONAL, 1, 0, "SAC" };
+constexpr Invoice seg_IT1_detail{ DETAIL, "IT1", 100, "Baseline Item Data (Invoice)", OPTIONAL, 1, 0, "IT1" };
+constexpr Invoice seg_IT3_detail{ DETAIL, "IT3", 300, "Additional Item Data", OPTIONAL, 5, 0, "IT1" };
+constexpr Invoice seg_SAC_detail{ DETAIL, "SAC", 1800, "Service, Promotion, Allowance, or Charge Information", OPTIONAL, 1, 0, "SAC" };
 
 
 
 //Summary Invoices:
 
-Invoice seg_TDS_summary{ SUMMARY, "TDS", 0100, "Total Monetary Value Summary", MANDATORY, 1, 0, "None" };
-Invoice seg_SAC_summary{ SUMMARY, "SAC", 0400, "Service, Promotion, Allowance, or Charge Information", OPTIONAL, 1, 0, "SAC" };
-Invoice seg_SE_summary{ SUMMARY, "SE", 0000, "Ending Segment", MANDATORY, 1, 1, "None" }; //See comment above at ST segment.
+constexpr Invoice seg_TDS_summary{ SUMMARY, "TDS", 100, "Total Monetary Value Summary", MANDATORY, 1, 0, "None" };
+constexpr Invoice seg_SAC_summary{ SUMMARY, "SAC", 400, "Service, Promotion, Allowance, or Charge Information", OPTIONAL, 1, 0, "SAC" };
+constexpr Invoice seg_SE_summary{ SUMMARY, "SE", 0, "Ending Segment", MANDATORY, 1, 1, "None" }; //See comment above at ST segment.
 
 
 
@@ -66,16 +71,16 @@ Invoice seg_SE_summary{ SUMMARY, "SE", 0000, "Ending Segment", MANDATORY, 1, 1,
 
 struct Segment {
 
-	string segmentId;
-	string ref;
+	string_view segmentId;
+	string_view ref;
 	int id;
-	string elementName;
+	string_view elementName;
 	Required reqIndicator;
-	string type;
+	string_view type;
 	int minUse;
 	int maxUse;
 	bool mustUse;
-	string description;
+	string_view description;
 
 };
 
@@ -90,48 +95,48 @@ struct Segment {
 
 //BIG = Beginning Segment for Invoice
 
-Segment BIG01{ "BIG", "BIG01", 373, "Invoice Issue Date", MANDATORY, "DT", 8, 8, 1, "Date expressed as CCYYMMDD where CC represents the first two digits of the calendar year. Note: Invoice issue date cannot be in the future." };
+constexpr Segment BIG01{ "BIG", "BIG01", 373, "Invoice Issue Date", MANDATORY, "DT", 8, 8, 1, "Date expressed as CCYYMMDD where CC represents the first two digits of the calendar year. Note: Invoice issue date cannot be in the future." };
 
-Segment BIG02{ "BIG", "BIG02", 76, "Invoice Number", MANDATORY, "AN", 1, 22, 1, "Identifying number assigned by issuer." };
+constexpr Segment BIG02{ "BIG", "BIG02", 76, "Invoice Number", MANDATORY, "AN", 1, 22, 1, "Identifying number assigned by issuer." };
 
-Segment BIG03{ "BIG", "BIG03", 373, "PO Issue Date", OPTIONAL, "DT", 8, 8, 0, "Date expressed as CCYYMMDD where CC represents the first two digits of the calendar year." };
+constexpr Segment BIG03{ "BIG", "BIG03", 373, "PO Issue Date", OPTIONAL, "DT", 8, 8, 0, "Date expressed as CCYYMMDD where CC represents the first two digits of the calendar year." };
 
-Segment BIG04{ "BIG", "BIG04", 324, "Purchase Order Number", OPTIONAL, "AN", 1, 22, 0, "Identifying number for Purchase Order assigned by the orderer/purchaser." };
+constexpr Segment BIG04{ "BIG", "BIG04", 324, "Purchase Order Number", OPTIONAL, "AN", 1, 22, 0, "Identifying number for Purchase Order assigned by the orderer/purchaser." };
 
 
 
 //CUR = Currency
 
-Segment CUR01{ "CUR", "CUR01", 98, "Entity Identifier Code", MANDATORY, "ID", 2, 3, 1, "Code identifying an organizational entity, a physical location, property or an individual." };
+constexpr Segment CUR01{ "CUR", "CUR01", 98, "Entity Identifier Code", MANDATORY, "ID", 2, 3, 1, "Code identifying an organizational entity, a physical location, property or an individual." };
 
-Segment CUR02{ "CUR", "CUR02", 100, "Currency Code", MANDATORY, "ID", 3, 3, 0, "Code (Standard ISO) for country in whose currency the charges are specified. Only required if not US Dollars." };
+constexpr Segment CUR02{ "CUR", "CUR02", 100, "Currency Code", MANDATORY, "ID", 3, 3, 0, "Code (Standard ISO) for country in whose currency the charges are specified. Only required if not US Dollars." };
 
 
 
 //N101 = Party Identification. Note the Kroger IC has two loops, but I consolidated them here because they're basically the same, but for code/enumeration values/qualifiers.
 
-Segment N101{ "N1", "N101", 98, "Entity Identifier Code", MANDATORY, "ID", 2, 3, 1, "Code identifying an organizational entity, a physical location, property, or an individual." }
+constexpr Segment N101{ "N1", "N101", 98, "Entity Identifier Code", MANDATORY, "ID", 2, 3, 1, "Code identifying an organizational entity, a physical location, property, or an individual." }
 ;
 
-Segment N102{ "N1", "N102", 93, "Name", OPTIONAL, "AN", 1, 60, 0, "Free-form name." };
+constexpr Segment N102{ "N1", "N102", 93, "Name", OPTIONAL, "AN", 1, 60, 0, "Free-form name." };
 
-Segment N103{ "N1", "N103", 66, "Identification Code Qualifier", CONDITIONAL, "ID", 1, 2, 0, "Code designating the system/method of code structure used for Identification Code (67)." };
+constexpr Segment N103{ "N1", "N103", 66, "Identification Code Qualifier", CONDITIONAL, "ID", 1, 2, 0, "Code designating the system/method of code structure used for Identification Code (67)." };
 
-Segment N104{ "N1", "N104", 67, "Identification Code", CONDITIONAL, "AN", 2, 80, 0, "Differing infromation for Ship To vs Supplier ID for this field. See the implementation convention." };
+constexpr Segment N104{ "N1", "N104", 67, "Identification Code", CONDITIONAL, "AN", 2, 80, 0, "Differing infromation for Ship To vs Supplier ID for this field. See the implementation convention." };
 
 
 
 //ITD = Terms of Sale/Deferred Terms of Sale
 
-Segment ITD03{ "ITD", "ITD03", 338, "Terms Discount Percent" , OPTIONAL, "R", 1, 6, 0, "Terms discount percentage, expressed as a percent, available to the purchaser if an invoice is paid on or before the Terms Discount Due Date. "};
+constexpr Segment ITD03{ "ITD", "ITD03", 338, "Terms Discount Percent" , OPTIONAL, "R", 1, 6, 0, "Terms discount percentage, expressed as a percent, available to the purchaser if an invoice is paid on or before the Terms Discount Due Date. "};
 
-Segment ITD05{ "ITD", "ITD05", 351, "Terms Discount Days Due", CONDITIONAL, "N0", 1, 3, 0, "Number of days in the terms discount period by which payment discount is earned." };
+constexpr Segment ITD05{ "ITD", "ITD05", 351, "Terms Discount Days Due", CONDITIONAL, "N0", 1, 3, 0, "Number of days in the terms discount period by which payment discount is earned." };
 
-Segment ITD06 { "ITD", "ITD06", 446, "Terms Net Due Date", OPTIONAL, "DT", 8, 8, 0, "Date when total invoice amount becomes due expressed in CCYYMMDD where CC represents the first two digits of the calendar year." };
+constexpr Segment ITD06 { "ITD", "ITD06", 446, "Terms Net Due Date", OPTIONAL, "DT", 8, 8, 0, "Date when total invoice amount becomes due expressed in CCYYMMDD where CC represents the first two digits of the calendar year." };
 
-Segment ITD07 { "ITD", "ITD07", 386, "Terms Net Days", OPTIONAL, "N0", 1, 3, 0, "Number of days until total invoice amount is due (discount not applicable)." };
+constexpr Segment ITD07 { "ITD", "ITD07", 386, "Terms Net Days", OPTIONAL, "N0", 1, 3, 0, "Number of days until total invoice amount is due (discount not applicable)." };
 
-Segment ITD08{ "ITD", "ITD08", 362, "Terms Discount Amount", OPTIONAL, "N2", 1, 10, 0, "Total amount of terms discount." };
+constexpr Segment ITD08{ "ITD", "ITD08", 362, "Terms Discount Amount", OPTIONAL, "N2", 1, 10, 0, "Total amount of terms discount." };
 
 
 
@@ -141,37 +146,37 @@ Segment ITD08{ "ITD", "ITD08", 362, "Terms Discount Amount", OPTIONAL, "N2", 1,
 
 //IT1 = Baseline Item Data (Invoice)
 
-Segment IT102{ "IT1", "IT102", 358, "Quantity Invoiced", CONDITIONAL, "R", 1, 15, 0, "Number of units invoiced (supplier units)." };
+constexpr Segment IT102{ "IT1", "IT102", 358, "Quantity Invoiced", CONDITIONAL, "R", 1, 15, 0, "Number of units invoiced (supplier units)." };
 
-Segment IT103 { "IT1", "IT103", 355, "Unit or Basis for Measurement Code", CONDITIONAL, "ID", 2, 2, 0, "Code specifying the units in which a value is being expressed, or manner in which a measurement has been taken." };
+constexpr Segment IT103 { "IT1", "IT103", 355, "Unit or Basis for Measurement Code", CONDITIONAL, "ID", 2, 2, 0, "Code specifying the units in which a value is being expressed, or manner in which a measurement has been taken." };
 
-Segment IT104 { "IT1", "IT104", 212, "Unit Price", CONDITIONAL, "R", 1, 17, 0, "Price per unit of product, service, commodity, etc." };
+constexpr Segment IT104 { "IT1", "IT104", 212, "Unit Price", CONDITIONAL, "R", 1, 17, 0, "Price per unit of product, service, commodity, etc." };
 
-Segment IT106 { "IT1", "IT106", 235, "Product/Service ID Qualifier", CONDITIONAL, "ID", 2, 2, 0, "Code identifying the type/source of the descriptive number used in Product/Service ID (234). Note: must send at least 1 of the item formats from the purchase order." };
+constexpr Segment IT106 { "IT1", "IT106", 235, "Product/Service ID Qualifier", CONDITIONAL, "ID", 2, 2, 0, "Code identifying the type/source of the descriptive number used in Product/Service ID (234). Note: must send at least 1 of the item formats from the purchase order." };
 
-Segment IT107 { "IT1", "IT107", 234, "Product/Service ID", CONDITIONAL, "AN", 2, 2, 0, "Identifying number for a product or service." };
+constexpr Segment IT107 { "IT1", "IT107", 234, "Product/Service ID", CONDITIONAL, "AN", 1, 48, 0, "Identifying number for a product or service." };
 
-Segment IT108 { "IT1", "IT108", 235, "Product/Service ID Qualifier", CONDITIONAL, "ID", 2, 2, 0, "Code identifying the type/source of the descriptive number used in product/service ID (234). Note: only send 1 reference item format (UK/UP)." };
+constexpr Segment IT108 { "IT1", "IT108", 235, "Product/Service ID Qualifier", CONDITIONAL, "ID", 2, 2, 0, "Code identifying the type/source of the descriptive number used in product/service ID (234). Note: only send 1 reference item format (UK/UP)." };
 
-Segment IT109{ "IT1", "IT109", 234, "Product/Service ID", CONDITIONAL, "AN", 1, 48, 0, "Identifying number for a product or service." };
+constexpr Segment IT109{ "IT1", "IT109", 234, "Product/Service ID", CONDITIONAL, "AN", 1, 48, 0, "Identifying number for a product or service." };
 
 
 
 //IT3 = Additional Item Data
 
-Segment IT301 { "IT3", "IT301", 382, "Number of Units Shipped", CONDITIONAL, "R", 1, 10, 0, "Numeric value of units shipped in manufacturer's shipping units for a line item or transaction set. Note: send if unit of measure code differs from IT103 as in Random Weight Items (LB)." };
+constexpr Segment IT301 { "IT3", "IT301", 382, "Number of Units Shipped", CONDITIONAL, "R", 1, 10, 0, "Numeric value of units shipped in manufacturer's shipping units for a line item or transaction set. Note: send if unit of measure code differs from IT103 as in Random Weight Items (LB)." };
 
-Segment IT302 { "IT3", "IT302", 355, "Unit or Basis for Measurement Code", CONDITIONAL, "ID", 2, 2, 0, "Code specifying the units in which a value is being expressed, or manner in which a measurement has been taken. Note: CA = CASE. IT301 should contain number of cases & IT302 = CA. There's more in implementation convention to read..." };
+constexpr Segment IT302 { "IT3", "IT302", 355, "Unit or Basis for Measurement Code", CONDITIONAL, "ID", 2, 2, 0, "Code specifying the units in which a value is being expressed, or manner in which a measurement has been taken. Note: CA = CASE. IT301 should contain number of cases & IT302 = CA. There's more in implementation convention to read..." };
 
 
 
 //SAC = Service, Promotion, Allowance, or Charge Information
 
-Segment SAC01_detail { "SAC", "SAC01", 248, "Allowance or Charge Indicator", MANDATORY, "ID", 1, 1, 1, "Code which indicates an allowance or charge for the service specified." };
+constexpr Segment SAC01_detail { "SAC", "SAC01", 248, "Allowance or Charge Indicator", MANDATORY, "ID", 1, 1, 1, "Code which indicates an allowance or charge for the service specified." };
 
-Segment SAC02_detail { "SAC", "SAC02", 1300, "Service, Promotion, Allowance, or Charge Code", CONDITIONAL, "ID", 4, 4, 0, "Code identifying the service, promotion, allowance, or charge. Please refer to https://edi.kroger.com/EDIPortal/EDIGuideAndReq_OcadoGroup.html for a list of valid allowance/charge codes at the invoice and item level." };
+constexpr Segment SAC02_detail { "SAC", "SAC02", 1300, "Service, Promotion, Allowance, or Charge Code", CONDITIONAL, "ID", 4, 4, 0, "Code identifying the service, promotion, allowance, or charge. Please refer to https://edi.kroger.com/EDIPortal/EDIGuideAndReq_OcadoGroup.html for a list of valid allowance/charge codes at the invoice and item level." };
 
-Segment SAC08_detail { "SAC", "SAC08", 118, "Rate", OPTIONAL, "R", 1, 9, 0, "Rate expressed in the standard monetary denomination for the currency specified. Note: The rate is based on the same UOM (IT103) as the previous item/ IT1 segment. You must provide the decimal on the rate. Allowance rates must be negative; charge rates must be positive."};
+constexpr Segment SAC08_detail { "SAC", "SAC08", 118, "Rate", OPTIONAL, "R", 1, 9, 0, "Rate expressed in the standard monetary denomination for the currency specified. Note: The rate is based on the same UOM (IT103) as the previous item/ IT1 segment. You must provide the decimal on the rate. Allowance rates must be negative; charge rates must be positive."};
 
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -180,16 +185,235 @@ Segment SAC08_detail { "SAC", "SAC08", 118, "Rate", OPTIONAL, "R", 1, 9, 0, "Rat
 
 //TDS = Total Monetary Value Summary
 
-Segment TDS01 {"TDS", "TDS01", 610, "Amount", MANDATORY, "N2", 1, 15, 1, "Monetary amount. Note: the total invoice amount (item quantities times cost, adjusted with any item allowance/charge; totaled for all items; adjusted with any invoice allowance/charge." };
+constexpr Segment TDS01 {"TDS", "TDS01", 610, "Amount", MANDATORY, "N2", 1, 15, 1, "Monetary amount. Note: the total invoice amount (item quantities times cost, adjusted with any item allowance/charge; totaled for all items; adjusted with any invoice allowance/charge." };
 
 
 
 //SAC = Service, Promotion, Allowance, or Charge Information
 
-Segment SAC01_summary{ "SAC", "SAC01", 248, "Allowance or Charge Indicator", MANDATORY, "ID", 1, 1, 1, "Code which indicates an allowance or charge for the service specified." };
+constexpr Segment SAC01_summary{ "SAC", "SAC01", 248, "Allowance or Charge Indicator", MANDATORY, "ID", 1, 1, 1, "Code which indicates an allowance or charge for the service specified." };
+
+constexpr Segment SAC02_summary{ "SAC", "SAC02", 1300, "Service, Promotion, Allowance, or Charge Code", CONDITIONAL, "ID", 4, 4, 0, "Code identifying the service, promotion, allowance, or charge. Please refer to https://edi.kroger.com/EDIPortal/EDIGuideAndReq_OcadoGroup.html for a list of valid allowance/charge codes at the invoice and item level." };
+
+constexpr Segment SAC05_summary{ "SAC", "SAC05", 610, "Amount", OPTIONAL, "N2", 1, 15, 0, "Monetary amount, 2 decimals are implied on the amount. Allowance amounts must be negative; charge amounts must be positive. Note: this SAC segment is for invoice level allowance/charge. Must combine if more than 1." };
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//Lookup Tables
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+//Every definition above, gathered into arrays so a parsed segment ID ("BIG") or element ref ("BIG02") can be taken straight to its schema
+//entry. The detail and summary SAC elements share refs; lookups return the first (detail) one since the two are defined identically.
+
+constexpr Invoice segmentSchemaTable[] = {
+
+	seg_ST_heading, seg_BIG_heading, seg_CUR_heading, seg_N1_heading_loop1, seg_N1_heading_loop2, seg_ITD_heading,
+	seg_IT1_detail, seg_IT3_detail, seg_SAC_detail,
+	seg_TDS_summary, seg_SAC_summary, seg_SE_summary
+
+};
+
+constexpr Segment elementSchemaTable[] = {
+
+	BIG01, BIG02, BIG03, BIG04,
+	CUR01, CUR02,
+	N101, N102, N103, N104,
+	ITD03, ITD05, ITD06, ITD07, ITD08,
+	IT102, IT103, IT104, IT106, IT107, IT108, IT109,
+	IT301, IT302,
+	SAC01_detail, SAC02_detail, SAC08_detail,
+	TDS01,
+	SAC01_summary, SAC02_summary, SAC05_summary
+
+};
+
+constexpr size_t NUM_SEGMENT_SCHEMAS = sizeof(segmentSchemaTable) / sizeof(segmentSchemaTable[0]);
+constexpr size_t NUM_ELEMENT_SCHEMAS = sizeof(elementSchemaTable) / sizeof(elementSchemaTable[0]);
+
+
+
+//The perfect hash: IDs are packed into a 64-bit number (one byte per character, up to eight characters) and multiplied by a constant, and
+//the top bits pick a slot. The compiler tries multipliers until it finds one where no two different IDs share a slot, so a lookup at runtime
+//is one multiply, one shift, and one compare against the key stored in that slot -- no probing and no string compares.
+
+constexpr uint64_t packSchemaKey(string_view id) {
+
+	uint64_t key = 0;
+
+	for (size_t i = 0; i < id.length() && i < 8; i++) {
+		key = (key << 8) | static_cast<unsigned char>(id[i]);
+	}
+
+	return (id.empty() || id.length() > 8) ? 0 : key;
+
+}
+
+template <int TABLE_BITS>
+struct SchemaHashTable {
+
+	uint64_t multiplier;
+	uint64_t slotKeys[1 << TABLE_BITS]; //0 marks an empty slot.
+	int16_t slotEntries[1 << TABLE_BITS]; //Index into the schema array, or -1.
+
+	constexpr size_t slotFor(uint64_t key) const
+	{
+		return static_cast<size_t>((key * multiplier) >> (64 - TABLE_BITS));
+	}
+
+	constexpr int find(uint64_t key) const
+	{
+		size_t slot = slotFor(key);
+		return (key != 0 && slotKeys[slot] == key) ? slotEntries[slot] : -1;
+	}
+
+};
+
+template <int TABLE_BITS, size_t N>
+constexpr SchemaHashTable<TABLE_BITS> buildSchemaHashTable(const uint64_t (&keys)[N]) {
+
+	SchemaHashTable<TABLE_BITS> table{};
+
+	for (uint64_t attempt = 1; attempt < 100000; attempt++) {
+
+		table.multiplier = (attempt * 0x9E3779B97F4A7C15ull) | 1;
+		bool collision = false;
+
+		for (size_t slot = 0; slot < (1 << TABLE_BITS); slot++) {
+			table.slotKeys[slot] = 0;
+			table.slotEntries[slot] = -1;
+		}
+
+		for (size_t i = 0; i < N && !collision; i++) {
+
+			size_t slot = table.slotFor(keys[i]);
+
+			if (table.slotKeys[slot] == 0) {
+				table.slotKeys[slot] = keys[i];
+				table.slotEntries[slot] = static_cast<int16_t>(i);
+			}
+
+			else if (table.slotKeys[slot] != keys[i]) { //Same key again (N1 loops, SAC detail/summary) just keeps the first entry.
+				collision = true;
+			}
+
+		}
+
+		if (!collision) {
+			return table;
+		}
+
+	}
+
+	return table; //Unreachable for tables this small; the static_asserts below would catch it.
+
+}
+
+template <size_t N>
+constexpr auto packSegmentSchemaKeys(const Invoice (&schemas)[N]) {
+
+	struct KeyArray { uint64_t keys[N]; } keyArray{};
+
+	for (size_t i = 0; i < N; i++) {
+		keyArray.keys[i] = packSchemaKey(schemas[i].id);
+	}
+
+	return keyArray;
+
+}
+
+template <size_t N>
+constexpr auto packElementSchemaKeys(const Segment (&schemas)[N]) {
+
+	struct KeyArray { uint64_t keys[N]; } keyArray{};
+
+	for (size_t i = 0; i < N; i++) {
+		keyArray.keys[i] = packSchemaKey(schemas[i].ref);
+	}
+
+	return keyArray;
+
+}
+
+constexpr auto segmentSchemaKeys = packSegmentSchemaKeys(segmentSchemaTable);
+constexpr auto elementSchemaKeys = packElementSchemaKeys(elementSchemaTable);
+constexpr SchemaHashTable<5> segmentSchemaHash = buildSchemaHashTable<5>(segmentSchemaKeys.keys);
+constexpr SchemaHashTable<8> elementSchemaHash = buildSchemaHashTable<8>(elementSchemaKeys.keys);
+
+
+
+//Lookups. Both return nullptr for anything not in the IC.
+
+constexpr const Invoice* findSegmentSchema(string_view segmentID) {
+
+	int entry = segmentSchemaHash.find(packSchemaKey(segmentID));
+	return (entry < 0) ? nullptr : &segmentSchemaTable[entry];
+
+}
+
+constexpr const Segment* findElementSchema(string_view elementRef) {
+
+	int entry = elementSchemaHash.find(packSchemaKey(elementRef));
+	return (entry < 0) ? nullptr : &elementSchemaTable[entry];
+
+}
+
+
+//findSegmentSchemaInArea is for walking a document in order. Some IDs (SAC) are defined in more than one area; the hash always gives back
+//the first definition, so once the document has moved past that area the later definition is used instead.
+
+constexpr const Invoice* findSegmentSchemaInArea(string_view segmentID, DocLocation currentArea) {
+
+	const Invoice* segmentSchema = findSegmentSchema(segmentID);
+
+	if (segmentSchema == nullptr || segmentSchema->placement >= currentArea) {
+		return segmentSchema;
+	}
+
+	for (size_t i = static_cast<size_t>(segmentSchema - segmentSchemaTable) + 1; i < NUM_SEGMENT_SCHEMAS; i++) {
+
+		if (segmentSchemaTable[i].id == segmentID && segmentSchemaTable[i].placement == currentArea) {
+			return &segmentSchemaTable[i];
+		}
+
+	}
+
+	return segmentSchema;
+
+}
+
+
+//Checked by the compiler, so a bad edit to the tables above won't build.
+
+constexpr bool allSchemasResolve() {
+
+	for (size_t i = 0; i < NUM_SEGMENT_SCHEMAS; i++) {
+
+		if (findSegmentSchema(segmentSchemaTable[i].id) == nullptr || findSegmentSchema(segmentSchemaTable[i].id)->id != segmentSchemaTable[i].id) {
+			return false;
+		}
+
+	}
+
+	for (size_t i = 0; i < NUM_ELEMENT_SCHEMAS; i++) {
+
+		if (findElementSchema(elementSchemaTable[i].ref) == nullptr || findElementSchema(elementSchemaTable[i].ref)->ref != elementSchemaTable[i].ref) {
+			return false;
+		}
+
+	}
+
+	return true;
+
+}
+
+static_assert(allSchemasResolve(), "Every schema entry must be reachable through the perfect hash.");
 
-Segment SAC02_summary{ "SAC", "SAC02", 1300, "Service, Promotion, Allowance, or Charge Code", CONDITIONAL, "ID", 4, 4, 0, "Code identifying the service, promotion, allowance, or charge. Please refer to https://edi.kroger.com/EDIPortal/EDIGuideAndReq_OcadoGroup.html for a list of valid allowance/charge codes at the invoice and item level." };
+static_assert(findSegmentSchema("BIG") != nullptr && findSegmentSchema("BIG")->name == "Beginning Segment for Invoice", "BIG must resolve to its schema entry.");
+static_assert(findSegmentSchema("SE") != nullptr && findSegmentSchema("SE")->placement == SUMMARY, "SE must resolve to its schema entry.");
+static_assert(findSegmentSchemaInArea("SAC", DETAIL)->placement == DETAIL && findSegmentSchemaInArea("SAC", SUMMARY)->placement == SUMMARY, "SAC must resolve by area.");
+static_assert(findSegmentSchema("ZZZ") == nullptr, "Unknown segment IDs must not resolve.");
+static_assert(findElementSchema("BIG02") != nullptr && findElementSchema("BIG02")->elementName == "Invoice Number", "BIG02 must resolve to its schema entry.");
+static_assert(findElementSchema("TDS01") != nullptr && findElementSchema("TDS01")->type == "N2", "TDS01 must resolve to its schema entry.");
+static_assert(findElementSchema("SAC05") != nullptr && findElementSchema("IT109") != nullptr && findElementSchema("BIG05") == nullptr, "Element lookups must be exact.");
 
-Segment SAC05_summary{ "SAC", "SAC05", 610, "Amount", OPTIONAL, "N2", 1, 15, 0, "Monetary amount, 2 decimals are implied on the amount. Allowance amounts must be negative; charge amounts must be positive. Note: this SAC segment is for invoice level allowance/charge. Must combine if more than 1." };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,448 @@
+#include "SchemaValidator.h"
+#include <iostream>
+using namespace std;
+
+
+const size_t NO_SCHEMA = static_cast<size_t>(-1);
+
+
+SchemaValidator::SchemaValidator() {
+
+	maxErrors = 1000;
+
+	for (size_t i = 0; i < NUM_SEGMENT_SCHEMAS; i++) {
+		mandatoryPositions[i][0] = 0;
+		mandatoryPositions[i][1] = 0;
+	}
+
+	//Work out once which element positions are mandatory for each segment, so onSegment can spot missing ones without searching.
+
+	for (size_t i = 0; i < NUM_ELEMENT_SCHEMAS; i++) {
+
+		const Segment& elementSchema = elementSchemaTable[i];
+		string_view ref = elementSchema.ref;
+		int position = (ref[ref.length() - 2] - '0') * 10 + (ref[ref.length() - 1] - '0');
+
+		if (elementSchema.reqIndicator != MANDATORY) {
+			continue;
+		}
+
+		for (size_t j = 0; j < NUM_SEGMENT_SCHEMAS; j++) {
+
+			if (segmentSchemaTable[j].id == elementSchema.segmentId) {
+				mandatoryPositions[j][position / 64] |= (1ull << (position % 64));
+			}
+
+		}
+
+	}
+
+	reset();
+
+}
+
+
+
+void SchemaValidator::reset() {
+
+	errors.clear();
+	numErrors = 0;
+	numNotKept = 0;
+	currentArea = HEADING;
+
+	for (size_t i = 0; i < NUM_SEGMENT_SCHEMAS; i++) {
+		segmentUses[i] = 0;
+		loopIterations[i] = 0;
+		segmentSeen[i] = false;
+	}
+
+}
+
+
+
+void SchemaValidator::beginDocument(const EdiTokenizer&) {
+
+	reset();
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function recordError stores an error (or warning) with its location. Only VALIDATION_ERROR entries count against isValid().
+//
+//*******************************************************************************************************************************************
+
+void SchemaValidator::recordError(ValidationErrorCode code, size_t segmentSequence, int elementPosition, size_t byteOffset, string_view ref) {
+
+	ValidationSeverity severity = (code == UNKNOWN_SEGMENT || code == IMPLIED_DECIMAL_HAS_POINT) ? VALIDATION_WARNING : VALIDATION_ERROR;
+
+	if (severity == VALIDATION_ERROR) {
+		numErrors++;
+	}
+
+	if (errors.size() >= maxErrors) {
+		numNotKept++;
+		return;
+	}
+
+	ValidationError error{ code, severity, segmentSequence, elementPosition, byteOffset, {} };
+	size_t refLength = (ref.length() < sizeof(error.ref) - 1) ? ref.length() : sizeof(error.ref) - 1;
+
+	ref.copy(error.ref, refLength);
+	error.ref[refLength] = '\0';
+
+	errors.push_back(error);
+
+}
+
+
+
+size_t SchemaValidator::resolveSegmentSchema(string_view segmentID) const {
+
+	const Invoice* segmentSchema = findSegmentSchemaInArea(segmentID, currentArea);
+
+	return (segmentSchema == nullptr) ? NO_SCHEMA : static_cast<size_t>(segmentSchema - segmentSchemaTable);
+
+}
+
+
+
+//Data type helpers. X12 doesn't count a minus sign or decimal point toward the length of a numeric element, so these hand back the digit
+//count for the length checks.
+
+static bool isNumericValue(string_view value, bool allowDecimalPoint, size_t& digitCount, bool& hasDecimalPoint) {
+
+	size_t start = (!value.empty() && value[0] == '-') ? 1 : 0;
+
+	digitCount = 0;
+	hasDecimalPoint = false;
+
+	for (size_t i = start; i < value.length(); i++) {
+
+		if (value[i] >= '0' && value[i] <= '9') {
+			digitCount++;
+		}
+
+		else if (value[i] == '.' && !hasDecimalPoint && allowDecimalPoint) {
+			hasDecimalPoint = true;
+		}
+
+		else {
+			return false;
+		}
+
+	}
+
+	return digitCount > 0;
+
+}
+
+static bool isValidDate(string_view value) {
+
+	if (value.length() != 8) {
+		return false;
+	}
+
+	for (char dateChar : value) {
+
+		if (dateChar < '0' || dateChar > '9') {
+			return false;
+		}
+
+	}
+
+	int year = (value[0] - '0') * 1000 + (value[1] - '0') * 100 + (value[2] - '0') * 10 + (value[3] - '0');
+	int month = (value[4] - '0') * 10 + (value[5] - '0');
+	int day = (value[6] - '0') * 10 + (value[7] - '0');
+	const int daysInMonth[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+	if (month < 1 || month > 12 || day < 1) {
+		return false;
+	}
+
+	bool leapYear = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+
+	return day <= daysInMonth[month - 1] + ((month == 2 && leapYear) ? 1 : 0);
+
+}
+
+static bool isValidText(string_view value) {
+
+	bool hasNonSpace = false;
+
+	for (char textChar : value) {
+
+		if (static_cast<unsigned char>(textChar) < 0x20 || textChar == 0x7F) {
+			return false;
+		}
+
+		hasNonSpace = hasNonSpace || textChar != ' ';
+
+	}
+
+	return hasNonSpace;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function validateElement checks one element's value against its schema entry: presence if it's mandatory, then data type, then length.
+//
+//*******************************************************************************************************************************************
+
+void SchemaValidator::validateElement(const Segment& elementSchema, string_view value, size_t segmentSequence, int elementPosition, size_t byteOffset) {
+
+	if (value.empty()) {
+
+		if (elementSchema.reqIndicator == MANDATORY) {
+			recordError(MISSING_MANDATORY_ELEMENT, segmentSequence, elementPosition, byteOffset, elementSchema.ref);
+		}
+
+		return;
+
+	}
+
+	string_view type = elementSchema.type;
+	size_t length = value.length();
+	size_t digitCount = 0;
+	bool hasDecimalPoint = false;
+	bool validType = true;
+
+	if (type == "DT") {
+		validType = isValidDate(value);
+	}
+
+	else if (type == "R") {
+		validType = isNumericValue(value, true, digitCount, hasDecimalPoint);
+		length = digitCount;
+	}
+
+	else if (type == "N0" || type == "N2") {
+
+		validType = isNumericValue(value, true, digitCount, hasDecimalPoint);
+		length = digitCount;
+
+		if (validType && hasDecimalPoint) { //Plenty of partners send "67.70" where "6770" is expected. It still decodes, so it's only a warning.
+			recordError(IMPLIED_DECIMAL_HAS_POINT, segmentSequence, elementPosition, byteOffset, elementSchema.ref);
+		}
+
+	}
+
+	else {
+		validType = isValidText(value);
+	}
+
+	if (!validType) {
+		recordError(INVALID_DATA_TYPE, segmentSequence, elementPosition, byteOffset, elementSchema.ref);
+		return;
+	}
+
+	if (length < static_cast<size_t>(elementSchema.minUse)) {
+		recordError(ELEMENT_TOO_SHORT, segmentSequence, elementPosition, byteOffset, elementSchema.ref);
+	}
+
+	else if (length > static_cast<size_t>(elementSchema.maxUse)) {
+		recordError(ELEMENT_TOO_LONG, segmentSequence, elementPosition, byteOffset, elementSchema.ref);
+	}
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function onSegment is called by the tokenizer as each segment is closed. It checks where the segment falls (heading/detail/summary), its
+//loop and repeat counts, and then every element the schema knows about. The element ref ("IT104") is built in a stack buffer, so nothing
+//here allocates unless there's an error to record.
+//
+//*******************************************************************************************************************************************
+
+void SchemaValidator::onSegment(const EdiTokenizer& invoiceTokenizer, size_t segmentIndex) {
+
+	const SegmentSpan& segment = invoiceTokenizer.getSegment(segmentIndex);
+	string_view segmentID = invoiceTokenizer.getSegmentID(segmentIndex);
+	size_t segmentSequence = segmentIndex + 1;
+	size_t schemaIndex = resolveSegmentSchema(segmentID);
+
+	if (schemaIndex == NO_SCHEMA) {
+		recordError(UNKNOWN_SEGMENT, segmentSequence, 0, segment.offset, segmentID);
+		return;
+	}
+
+	const Invoice& segmentSchema = segmentSchemaTable[schemaIndex];
+
+	if (segmentSchema.placement < currentArea) {
+		recordError(SEGMENT_OUT_OF_ORDER, segmentSequence, 0, segment.offset, segmentID);
+	}
+
+	else {
+		currentArea = segmentSchema.placement;
+	}
+
+	//A loop's header segment starts a new iteration, which resets the use counts of every segment in that loop.
+
+	if (segmentSchema.loopID == segmentSchema.id) {
+
+		loopIterations[schemaIndex]++;
+
+		if (segmentSchema.repeatLimit > 0 && loopIterations[schemaIndex] > static_cast<size_t>(segmentSchema.repeatLimit)) {
+			recordError(LOOP_REPEAT_EXCEEDED, segmentSequence, 0, segment.offset, segmentID);
+		}
+
+		for (size_t i = 0; i < NUM_SEGMENT_SCHEMAS; i++) {
+
+			if (segmentSchemaTable[i].loopID == segmentSchema.loopID && segmentSchemaTable[i].placement == segmentSchema.placement) {
+				segmentUses[i] = 0;
+			}
+
+		}
+
+	}
+
+	segmentUses[schemaIndex]++;
+	segmentSeen[schemaIndex] = true;
+
+	if (segmentSchema.maxUse > 0 && segmentUses[schemaIndex] > static_cast<size_t>(segmentSchema.maxUse)) {
+		recordError(SEGMENT_REPEAT_EXCEEDED, segmentSequence, 0, segment.offset, segmentID);
+	}
+
+	//Element checks.
+
+	char elementRef[8] = {};
+	size_t idLength = (segmentID.length() < 5) ? segmentID.length() : 5;
+
+	segmentID.copy(elementRef, idLength);
+
+	for (int position = 1; position < segment.numElements && position < 100; position++) {
+
+		elementRef[idLength] = static_cast<char>('0' + position / 10);
+		elementRef[idLength + 1] = static_cast<char>('0' + position % 10);
+
+		const Segment* elementSchema = findElementSchema(string_view(elementRef, idLength + 2));
+
+		if (elementSchema != nullptr) {
+
+			const ElementSpan& element = invoiceTokenizer.getElement(segment.firstElement + position);
+			validateElement(*elementSchema, invoiceTokenizer.getElementText(segment.firstElement + position), segmentSequence, position, element.offset);
+
+		}
+
+	}
+
+	//Mandatory elements that weren't sent at all (the segment ended before reaching them).
+
+	for (int position = segment.numElements; position < 128; position++) {
+
+		if (mandatoryPositions[schemaIndex][position / 64] & (1ull << (position % 64))) {
+
+			elementRef[idLength] = static_cast<char>('0' + position / 10);
+			elementRef[idLength + 1] = static_cast<char>('0' + position % 10);
+			recordError(MISSING_MANDATORY_ELEMENT, segmentSequence, position, segment.offset + segment.length, string_view(elementRef, idLength + 2));
+
+		}
+
+	}
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function endDocument checks for mandatory segments that never showed up.
+//
+//*******************************************************************************************************************************************
+
+void SchemaValidator::endDocument(const EdiTokenizer& invoiceTokenizer) {
+
+	for (size_t i = 0; i < NUM_SEGMENT_SCHEMAS; i++) {
+
+		if (segmentSchemaTable[i].reqIndicator == MANDATORY && !segmentSeen[i]) {
+			recordError(MISSING_MANDATORY_SEGMENT, 0, 0, invoiceTokenizer.getBuffer().size(), segmentSchemaTable[i].id);
+		}
+
+	}
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function describeError turns a recorded error into a sentence for people to read.
+//
+//*******************************************************************************************************************************************
+
+string SchemaValidator::describeError(const ValidationError& error) {
+
+	string description = (error.severity == VALIDATION_ERROR) ? "ERROR" : "WARNING";
+	string ref = error.ref;
+
+	if (error.segmentSequence > 0) {
+		description += " at segment " + to_string(error.segmentSequence) + " (" + ref + "), offset " + to_string(error.byteOffset) + ": ";
+	}
+
+	else {
+		description += ": ";
+	}
+
+	switch (error.code) {
+
+	case ELEMENT_TOO_SHORT:
+		return description + "value is shorter than the minimum length.";
+
+	case ELEMENT_TOO_LONG:
+		return description + "value is longer than the maximum length.";
+
+	case INVALID_DATA_TYPE:
+		return description + "value is not a valid " + string(findElementSchema(ref) != nullptr ? findElementSchema(ref)->type : "value") + ".";
+
+	case IMPLIED_DECIMAL_HAS_POINT:
+		return description + "implied-decimal amount was sent with a decimal point.";
+
+	case MISSING_MANDATORY_ELEMENT:
+		return description + "mandatory element is missing.";
+
+	case MISSING_MANDATORY_SEGMENT:
+		return description + "mandatory segment " + ref + " is missing.";
+
+	case SEGMENT_REPEAT_EXCEEDED:
+		return description + "segment repeats more times than allowed.";
+
+	case LOOP_REPEAT_EXCEEDED:
+		return description + "loop repeats more times than allowed.";
+
+	case SEGMENT_OUT_OF_ORDER:
+		return description + "segment is out of heading/detail/summary order.";
+
+	case UNKNOWN_SEGMENT:
+		return description + "segment is not defined in the implementation convention.";
+
+	}
+
+	return description;
+
+}
+
+
+
+void SchemaValidator::displayErrors(ostream& out) const {
+
+	if (errors.empty()) {
+		out << "No schema errors found." << endl;
+		return;
+	}
+
+	for (const ValidationError& error : errors) {
+		out << describeError(error) << endl;
+	}
+
+	if (numNotKept > 0) {
+		out << "(" << numNotKept << " more not shown.)" << endl;
+	}
+
+}
@@ -0,0 +1,114 @@
+#ifndef SCHEMAVALIDATOR_H
+#define SCHEMAVALIDATOR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "EdiTokenizer.h"
+#include "Schema.h"
+using namespace std;
+
+
+//The SchemaValidator class enforces what Schema.h says about the Kroger 810: element lengths (minUse/maxUse), data types (AN, ID, DT, R,
+//N0, N2), mandatory elements and segments, how many times a segment can repeat, and how many times a loop can repeat. It's a
+//SegmentObserver, so it checks each segment as the tokenizer finishes it rather than making a second pass. Errors are recorded as codes plus
+//a location (segment number, element position, byte offset); the text for them is only built if someone asks for it.
+
+enum ValidationErrorCode {
+
+	ELEMENT_TOO_SHORT,
+	ELEMENT_TOO_LONG,
+	INVALID_DATA_TYPE,
+	IMPLIED_DECIMAL_HAS_POINT,
+	MISSING_MANDATORY_ELEMENT,
+	MISSING_MANDATORY_SEGMENT,
+	SEGMENT_REPEAT_EXCEEDED,
+	LOOP_REPEAT_EXCEEDED,
+	SEGMENT_OUT_OF_ORDER,
+	UNKNOWN_SEGMENT
+
+};
+
+enum ValidationSeverity { VALIDATION_ERROR, VALIDATION_WARNING };
+
+
+struct ValidationError {
+
+	ValidationErrorCode code;
+	ValidationSeverity severity;
+	size_t segmentSequence; //1-based, same numbering as InvDocument::sequence. 0 for whole-document problems.
+	int elementPosition; //0 when the problem is with the segment as a whole.
+	size_t byteOffset; //Where in the buffer the element (or segment) starts.
+	char ref[8]; //"BIG02", or just the segment ID.
+
+};
+
+
+class SchemaValidator : public SegmentObserver {
+
+	private:
+
+		vector <ValidationError> errors;
+		size_t numErrors; //VALIDATION_ERROR entries only; warnings don't count.
+		size_t numNotKept; //Errors and warnings past maxErrors, counted here instead of stored.
+		size_t maxErrors;
+		DocLocation currentArea;
+		size_t segmentUses[NUM_SEGMENT_SCHEMAS]; //Uses within the current loop iteration (or the whole document, outside of loops).
+		size_t loopIterations[NUM_SEGMENT_SCHEMAS]; //Indexed by the loop's header segment.
+		bool segmentSeen[NUM_SEGMENT_SCHEMAS];
+		uint64_t mandatoryPositions[NUM_SEGMENT_SCHEMAS][2]; //Bit n set means element n of that segment is mandatory (positions 0-127).
+
+		void recordError(ValidationErrorCode code, size_t segmentSequence, int elementPosition, size_t byteOffset, string_view ref);
+		size_t resolveSegmentSchema(string_view segmentID) const;
+		void validateElement(const Segment& elementSchema, string_view value, size_t segmentSequence, int elementPosition, size_t byteOffset);
+
+	public:
+
+		//Constructors and destructor
+
+		SchemaValidator(); //See SchemaValidator.cpp for definitions
+
+		~SchemaValidator() {}
+
+
+		//SegmentObserver hooks, called by EdiTokenizer::tokenize.
+		void beginDocument(const EdiTokenizer&) override;
+		void onSegment(const EdiTokenizer& invoiceTokenizer, size_t segmentIndex) override;
+		void endDocument(const EdiTokenizer& invoiceTokenizer) override;
+
+		void reset();
+
+		void displayErrors(ostream& out) const;
+
+		static string describeError(const ValidationError& error);
+
+
+
+		//Mutators
+
+		void setMaxErrors(size_t maxErrs) //Stops recording (but keeps counting) after this many, so a garbage file can't run away with memory.
+		{
+			maxErrors = maxErrs;
+		}
+
+
+		//Accessors
+
+		const vector <ValidationError>& getErrors() const
+		{
+			return errors;
+		}
+
+		size_t getNumErrors() const
+		{
+			return numErrors;
+		}
+
+		bool isValid() const
+		{
+			return numErrors == 0;
+		}
+
+};
+
+#endif
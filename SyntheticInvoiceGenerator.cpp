@@ -0,0 +1,239 @@
+#include "SyntheticInvoiceGenerator.h"
+#include <cstdio>
+#include "EdiValueDecoder.h"
+using namespace std;
+
+
+const size_t GENERATOR_FLUSH_BYTES = 1 << 20;
+
+const char* const PARTY_QUALIFIERS[] = { "ST", "VN", "RE", "BT" };
+const char* const PARTY_NAMES[] = { "OLSON FOOD SUPPLY", "KROGER OCADO - MONROE", "GREAT LAKES PRODUCE CO", "MIDWEST DAIRY COOPERATIVE", "RIVERSIDE BAKERY", "NORTHERN MEAT PACKERS" };
+const char* const UNITS_OF_MEASURE[] = { "CA", "EA", "LB", "BX" };
+
+
+SyntheticInvoiceGenerator::SyntheticInvoiceGenerator() {
+
+	setSeed(1202);
+	targetBytes = 1 << 20;
+	maxParties = 3;
+	maxLineItems = 40;
+	transactionSetsPerGroup = 500;
+	lineBreaks = false;
+
+}
+
+SyntheticInvoiceGenerator::SyntheticInvoiceGenerator(uint64_t seed) : SyntheticInvoiceGenerator() {
+
+	setSeed(seed);
+
+}
+
+
+
+void SyntheticInvoiceGenerator::setSeed(uint64_t seed) {
+
+	randomState = seed;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function nextRandom is splitmix64: tiny, fast, and it gives the same sequence everywhere. randomBetween uses plain modulo; the slight bias
+//doesn't matter for test data.
+//
+//*******************************************************************************************************************************************
+
+uint64_t SyntheticInvoiceGenerator::nextRandom() {
+
+	uint64_t mixed = (randomState += 0x9E3779B97F4A7C15ull);
+
+	mixed = (mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9ull;
+	mixed = (mixed ^ (mixed >> 27)) * 0x94D049BB133111EBull;
+
+	return mixed ^ (mixed >> 31);
+
+}
+
+int SyntheticInvoiceGenerator::randomBetween(int low, int high) {
+
+	return low + static_cast<int>(nextRandom() % static_cast<uint64_t>(high - low + 1));
+
+}
+
+bool SyntheticInvoiceGenerator::randomChance(int percent) {
+
+	return randomBetween(1, 100) <= percent;
+
+}
+
+
+
+void SyntheticInvoiceGenerator::appendSegment(string& out, const string& segment, size_t& segmentCount) {
+
+	out += segment;
+	out += '~';
+
+	if (lineBreaks) {
+		out += '\n';
+	}
+
+	segmentCount++;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function appendTransactionSet writes one ST..SE invoice. Prices and rates are built as fixed-point ten-thousandths (same scale as
+//EdiValueDecoder) so the TDS total can be worked out exactly: each line is quantity x (price -/+ its SAC rate), the summary SAC amount is
+//added or taken off, and the result is rounded to the cent and written with its decimal implied, the way N2 is supposed to be sent.
+//
+//*******************************************************************************************************************************************
+
+void SyntheticInvoiceGenerator::appendTransactionSet(string& out, size_t controlNumber) {
+
+	char controlText[16];
+	size_t segmentCount = 0;
+	int64_t totalScaled = 0;
+
+	snprintf(controlText, sizeof(controlText), "%04zu", controlNumber);
+
+	appendSegment(out, "ST*810*" + string(controlText), segmentCount);
+
+	string invoiceDate = to_string(randomBetween(2024, 2025) * 10000 + randomBetween(1, 12) * 100 + randomBetween(1, 28));
+	string purchaseOrder = randomChance(80) ? "PO" + to_string(randomBetween(100000, 999999)) : "";
+
+	appendSegment(out, "BIG*" + invoiceDate + "*" + to_string(randomBetween(1000000, 9999999)) + "**" + purchaseOrder, segmentCount);
+
+	if (randomChance(10)) {
+		appendSegment(out, "CUR*BY*CAD", segmentCount);
+	}
+
+	int numParties = randomBetween(1, maxParties);
+
+	for (int i = 0; i < numParties; i++) {
+
+		string party = "N1*" + string(PARTY_QUALIFIERS[i % 4]) + "*" + PARTY_NAMES[randomBetween(0, 5)];
+
+		if (randomChance(90)) {
+			party += "*92*" + to_string(randomBetween(100000, 9999999));
+		}
+
+		appendSegment(out, party, segmentCount);
+
+	}
+
+	if (randomChance(50)) {
+		appendSegment(out, "ITD*01*3*2**10*" + invoiceDate + "*30", segmentCount);
+	}
+
+	int numLineItems = randomBetween(1, maxLineItems);
+
+	for (int i = 0; i < numLineItems; i++) {
+
+		int64_t quantity = randomBetween(1, 500);
+		int64_t priceScaled = randomBetween(5000, 999999); //$0.5000 to $99.9999
+		string unitOfMeasure = UNITS_OF_MEASURE[randomBetween(0, 3)];
+		string productID = "1012" + to_string(randomBetween(100000000, 999999999)) + to_string(randomBetween(0, 9));
+
+		appendSegment(out, "IT1**" + to_string(quantity) + "*" + unitOfMeasure + "*" + formatFixedPoint(priceScaled, 4) + "**UK*" + productID, segmentCount);
+		totalScaled += quantity * priceScaled;
+
+		int numItemDetails = randomChance(30) ? randomBetween(1, 2) : 0;
+
+		for (int j = 0; j < numItemDetails; j++) {
+			appendSegment(out, "IT3*" + to_string(randomBetween(1, 50)) + "*" + unitOfMeasure, segmentCount);
+		}
+
+		if (randomChance(20)) {
+
+			bool allowance = randomChance(70);
+			int64_t rateScaled = randomBetween(100, static_cast<int>(priceScaled / 10)); //Up to a tenth of the price, so a line never goes negative.
+
+			appendSegment(out, string("SAC*") + (allowance ? "A*C310" : "C*D240") + "******" + formatFixedPoint(rateScaled, 4), segmentCount);
+			totalScaled += (allowance ? -quantity : quantity) * rateScaled;
+
+		}
+
+	}
+
+	//The summary SAC goes after TDS, but it's part of the total, so work it out first.
+
+	bool summaryCharge = randomChance(25);
+	int64_t summaryCents = summaryCharge ? randomBetween(100, 50000) : 0;
+
+	totalScaled += summaryCents * 100;
+
+	int64_t totalCents = (totalScaled + 50) / 100; //Always positive here, so this rounds half up.
+
+	appendSegment(out, "TDS*" + to_string(totalCents), segmentCount);
+
+	if (summaryCharge) {
+		appendSegment(out, "SAC*C*D240***" + to_string(summaryCents), segmentCount);
+	}
+
+	appendSegment(out, "SE*" + to_string(segmentCount + 1) + "*" + controlText, segmentCount);
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function generate writes one interchange: an ISA (exactly 106 bytes, so delimiters sit where X12 says they do), GS groups of
+//transactionSetsPerGroup invoices each, and the matching GE/IEA trailers. The text is built in a buffer and written out a megabyte at a time.
+//
+//*******************************************************************************************************************************************
+
+uint64_t SyntheticInvoiceGenerator::generate(ostream& out) {
+
+	string buffer;
+	uint64_t bytesWritten = 0;
+	size_t segmentCount = 0;
+	size_t controlNumber = 0;
+	int numGroups = 0;
+	int setsInGroup = 0;
+
+	buffer.reserve(GENERATOR_FLUSH_BYTES * 2);
+
+	appendSegment(buffer, "ISA*00*          *00*          *ZZ*SENDER         *ZZ*KROGER         *250101*1200*U*00401*000000001*0*P*>", segmentCount);
+
+	while (true) {
+
+		if (setsInGroup == 0) {
+			numGroups++;
+			appendSegment(buffer, "GS*IN*SENDER*KROGER*20250101*1200*" + to_string(numGroups) + "*X*004010", segmentCount);
+		}
+
+		appendTransactionSet(buffer, ++controlNumber);
+		setsInGroup++;
+
+		bool done = bytesWritten + buffer.size() >= targetBytes;
+
+		if (setsInGroup == transactionSetsPerGroup || done) {
+			appendSegment(buffer, "GE*" + to_string(setsInGroup) + "*" + to_string(numGroups), segmentCount);
+			setsInGroup = 0;
+		}
+
+		if (done) {
+			appendSegment(buffer, "IEA*" + to_string(numGroups) + "*000000001", segmentCount);
+		}
+
+		if (buffer.size() >= GENERATOR_FLUSH_BYTES || done) {
+			out.write(buffer.data(), buffer.size());
+			bytesWritten += buffer.size();
+			buffer.clear();
+		}
+
+		if (done) {
+			break;
+		}
+
+	}
+
+	return bytesWritten;
+
+}
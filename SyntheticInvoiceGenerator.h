@@ -0,0 +1,89 @@
+#ifndef SYNTHETICINVOICEGENERATOR_H
+#define SYNTHETICINVOICEGENERATOR_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+using namespace std;
+
+
+//The SyntheticInvoiceGenerator class writes made-up Kroger 810s for benchmarking, since the three sample files are only a few hundred bytes
+//each. Every invoice follows Schema.h: ST, BIG, an optional CUR, one or more N1 loops, an optional ITD, IT1 loops with optional IT3s and
+//SAC allowances/charges, a TDS that really is the total of everything above it, an optional summary SAC, and an SE with the right segment
+//count. Invoices are wrapped in ISA/GS envelopes until the output reaches the size asked for, so anything from a few KB to many GB can be
+//produced. The random numbers come from a small generator written out here (not <random>), so the same seed gives byte-for-byte the same
+//file on every compiler.
+
+class SyntheticInvoiceGenerator {
+
+	private:
+
+		uint64_t randomState;
+		uint64_t targetBytes;
+		int maxParties;
+		int maxLineItems;
+		int transactionSetsPerGroup;
+		bool lineBreaks;
+
+		uint64_t nextRandom();
+		int randomBetween(int low, int high); //Inclusive on both ends.
+		bool randomChance(int percent);
+
+		void appendSegment(string& out, const string& segment, size_t& segmentCount);
+		void appendTransactionSet(string& out, size_t controlNumber);
+
+	public:
+
+		//Constructors and destructor
+
+		SyntheticInvoiceGenerator(); //See SyntheticInvoiceGenerator.cpp for definitions
+
+		SyntheticInvoiceGenerator(uint64_t seed);
+
+		~SyntheticInvoiceGenerator() {}
+
+
+		uint64_t generate(ostream& out); //Returns the number of bytes written.
+
+
+
+		//Mutators
+
+		void setSeed(uint64_t seed);
+
+		void setTargetBytes(uint64_t bytes) //Generation stops at the first interchange boundary at or past this size.
+		{
+			targetBytes = bytes;
+		}
+
+		void setMaxParties(int parties)
+		{
+			maxParties = (parties < 1) ? 1 : parties;
+		}
+
+		void setMaxLineItems(int lineItems)
+		{
+			maxLineItems = (lineItems < 1) ? 1 : lineItems;
+		}
+
+		void setTransactionSetsPerGroup(int transactionSets)
+		{
+			transactionSetsPerGroup = (transactionSets < 1) ? 1 : transactionSets;
+		}
+
+		void setLineBreaks(bool breaks) //Puts a newline after each segment terminator, the way a lot of partners send files.
+		{
+			lineBreaks = breaks;
+		}
+
+
+		//Accessors
+
+		uint64_t getTargetBytes() const
+		{
+			return targetBytes;
+		}
+
+};
+
+#endif
@@ -0,0 +1,227 @@
+#include "WatchFolderIngestor.h"
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+using namespace std;
+
+
+const int WATCH_WAIT_TIMEOUT_MS = 200;
+
+
+WatchFolderIngestor::WatchFolderIngestor() {
+
+	numFilesProcessed = 0;
+	numFailures = 0;
+	numBatches = 0;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function open checks both directories (making the output one if needed), loads the state file, and starts watching. The output directory
+//can't be the watched one, or every rendered invoice would land back in the drop folder as a new "invoice."
+//
+//*******************************************************************************************************************************************
+
+void WatchFolderIngestor::open(const string& watchDirectory, const string& outputDir, bool forcePolling) {
+
+	error_code directoryError;
+
+	filesystem::create_directories(outputDir, directoryError);
+
+	if (!filesystem::is_directory(outputDir, directoryError)) {
+		throw string("ERROR. Cannot create output directory " + outputDir + ".\n");
+	}
+
+	if (filesystem::equivalent(watchDirectory, outputDir, directoryError)) {
+		throw string("ERROR. The output directory has to be different from the watched directory.\n");
+	}
+
+	outputDirectory = outputDir;
+	stateFilePath = (filesystem::path(outputDirectory) / INGEST_STATE_FILE_NAME).string();
+
+	loadState();
+
+	stateFile.open(stateFilePath, ios::out | ios::app);
+
+	if (!stateFile) {
+		throw string("ERROR. Cannot open state file " + stateFilePath + ".\n");
+	}
+
+	folderWatcher.open(watchDirectory, forcePolling);
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function loadState reads ingestState.dat. Later lines win, so a file that was replaced and re-rendered just has a second line. Anything
+//that doesn't parse (say, a line cut short by a power cut) is skipped; the worst that does is render that one file again.
+//
+//*******************************************************************************************************************************************
+
+void WatchFolderIngestor::loadState() {
+
+	ifstream existingState(stateFilePath);
+	string stateLine;
+
+	processedFiles.clear();
+
+	while (getline(existingState, stateLine)) {
+
+		size_t firstTab = stateLine.find('\t');
+		size_t secondTab = (firstTab == string::npos) ? string::npos : stateLine.find('\t', firstTab + 1);
+
+		if (secondTab == string::npos || secondTab + 1 >= stateLine.length()) {
+			continue;
+		}
+
+		try {
+
+			FileStamp stamp;
+
+			stamp.size = stoull(stateLine.substr(0, firstTab));
+			stamp.modifiedTime = stoll(stateLine.substr(firstTab + 1, secondTab - firstTab - 1));
+			processedFiles[stateLine.substr(secondTab + 1)] = stamp;
+
+		}
+
+		catch (...) { //stoull/stoll throw on garbage.
+			continue;
+		}
+
+	}
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function run catches up on whatever is already in the folder, then waits for more. Each wakeup is one batch: the files that landed close
+//together are rendered in parallel and written out before the next wait.
+//
+//*******************************************************************************************************************************************
+
+void WatchFolderIngestor::run(const volatile sig_atomic_t& stopRequested, ostream& log) {
+
+	vector <string> readyFiles = folderWatcher.scanDirectory();
+
+	log << "Watching \"" << folderWatcher.getDirectory() << "\" (" << (folderWatcher.isUsingNotifications() ? "inotify" : "polling") << "), writing to \"" << outputDirectory << "\". Press Ctrl+C to stop." << endl;
+
+	if (!readyFiles.empty()) {
+		processBatch(readyFiles, log);
+	}
+
+	while (!stopRequested) {
+
+		if (folderWatcher.waitForFiles(readyFiles, WATCH_WAIT_TIMEOUT_MS)) {
+			processBatch(readyFiles, log);
+		}
+
+	}
+
+	log << "Stopped after " << numBatches << " batch(es): " << numFilesProcessed << " file(s) rendered, " << numFailures << " failed." << endl;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function processBatch drops anything the state file says is already done, renders the rest, and records the ones that rendered. The stamp
+//is taken before rendering, so a file that's rewritten while it's being rendered won't match next time and gets picked up again.
+//
+//*******************************************************************************************************************************************
+
+void WatchFolderIngestor::processBatch(const vector <string>& candidatePaths, ostream& log) {
+
+	chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+	vector <FileStamp> batchStamps;
+
+	batchProcessor.clearInputFiles();
+
+	for (const string& path : candidatePaths) {
+
+		FileStamp stamp;
+		string fileName = filesystem::path(path).filename().string();
+		unordered_map <string, FileStamp>::const_iterator processed = processedFiles.find(fileName);
+
+		if (!FolderWatcher::getFileStamp(path, stamp) || (processed != processedFiles.end() && processed->second == stamp)) {
+			continue;
+		}
+
+		try {
+			batchProcessor.addInputPath(path);
+		}
+
+		catch (string exceptionMsg) { //Deleted since it was stamped.
+			continue;
+		}
+
+		batchStamps.push_back(stamp);
+
+	}
+
+	if (batchStamps.empty()) {
+		return;
+	}
+
+	batchProcessor.run();
+
+	const vector <BatchInvoiceResult>& results = batchProcessor.getResults();
+	size_t batchFailures = 0;
+
+	for (size_t i = 0; i < results.size(); i++) {
+
+		const BatchInvoiceResult& result = results[i];
+		string fileName = filesystem::path(result.fileName).filename().string();
+		vector <string_view> pieces;
+
+		if (result.outcome == INVOICE_CANNOT_OPEN) {
+			pieces.insert(pieces.end(), { "FAILED: ", result.errorMessage, "\n" });
+		}
+
+		else {
+			pieces.push_back(result.renderedInvoice); //Schema reports and any transaction sets that failed are in here too.
+		}
+
+		batchFailures += !result.succeeded;
+
+		try {
+
+			FileOutputSink renderedFile((filesystem::path(outputDirectory) / (fileName + (result.succeeded ? ".txt" : ".failed.txt"))).string());
+			renderedFile.writeBatch(pieces);
+
+		}
+
+		catch (string exceptionMsg) { //Left out of the state file, so it's tried again after a restart.
+
+			log << exceptionMsg;
+			continue;
+
+		}
+
+		processedFiles[fileName] = batchStamps[i];
+
+		if (result.succeeded) { //A failed file is only skipped until a restart, so it gets another try then (or sooner, if it's rewritten).
+			stateFile << batchStamps[i].size << '\t' << batchStamps[i].modifiedTime << '\t' << fileName << '\n';
+		}
+
+	}
+
+	stateFile.flush(); //Once per batch: a crash before this only means the batch is rendered again.
+
+	numBatches++;
+	numFilesProcessed += results.size() - batchFailures;
+	numFailures += batchFailures;
+
+	double milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - startTime).count();
+
+	log << "Batch " << numBatches << ": " << results.size() << " file(s), " << batchFailures << " failed, " << batchProcessor.getNumSchemaInvalid() << " transaction set(s) with schema errors, ";
+	log << fixed << setprecision(2) << milliseconds << " ms" << endl;
+
+}
@@ -0,0 +1,88 @@
+#ifndef WATCHFOLDERINGESTOR_H
+#define WATCHFOLDERINGESTOR_H
+
+#include <csignal>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "BatchProcessor.h"
+#include "FolderWatcher.h"
+#include "OutputSink.h"
+using namespace std;
+
+
+//The WatchFolderIngestor class is the long-running side of batch mode. It sits on a drop folder (through a FolderWatcher), and whenever
+//invoices land it hands them to a BatchProcessor as one batch and writes each rendered invoice to <outputDirectory>/<fileName>.txt (or
+//<fileName>.failed.txt if it couldn't be read or any transaction set in it failed). An interchange is split into its transaction sets the
+//same way batch mode does it.
+//
+//Every file it renders is appended to a small state file in the output directory (ingestState.dat: size, modification time, and name, one
+//file per line). On start-up anything already in the folder that isn't in the state file is caught up first, so a restart neither skips
+//files that arrived while it was down nor redoes ones it already rendered. Failed files are left out of it, so they're tried again after a
+//restart. A file that comes back with a different size or timestamp is treated as new.
+
+const char INGEST_STATE_FILE_NAME[] = "ingestState.dat";
+
+
+class WatchFolderIngestor {
+
+	private:
+
+		string outputDirectory;
+		string stateFilePath;
+		FolderWatcher folderWatcher;
+		BatchProcessor batchProcessor;
+		unordered_map <string, FileStamp> processedFiles; //Keyed by file name (not the full path), from the state file.
+		ofstream stateFile;
+		size_t numFilesProcessed;
+		size_t numFailures;
+		size_t numBatches;
+
+		void loadState();
+		void processBatch(const vector <string>& candidatePaths, ostream& log);
+
+	public:
+
+		//Constructors and destructor
+
+		WatchFolderIngestor(); //See WatchFolderIngestor.cpp for definitions
+
+		~WatchFolderIngestor() {}
+
+		WatchFolderIngestor(const WatchFolderIngestor&) = delete;
+		WatchFolderIngestor& operator=(const WatchFolderIngestor&) = delete;
+
+
+		void open(const string& watchDirectory, const string& outputDir, bool forcePolling = false); //Throws a string if either directory can't be used.
+
+		void run(const volatile sig_atomic_t& stopRequested, ostream& log); //Returns once stopRequested goes nonzero (checked at least every 200 ms).
+
+
+
+		//Accessors
+
+		bool isUsingNotifications() const
+		{
+			return folderWatcher.isUsingNotifications();
+		}
+
+		size_t getNumFilesProcessed() const
+		{
+			return numFilesProcessed;
+		}
+
+		size_t getNumFailures() const
+		{
+			return numFailures;
+		}
+
+		size_t getNumBatches() const
+		{
+			return numBatches;
+		}
+
+};
+
+#endif
@@ -0,0 +1,140 @@
+#include "WorkStealingPool.h"
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+using namespace std;
+
+
+WorkStealingPool::WorkStealingPool() {
+
+	numThreads = thread::hardware_concurrency();
+
+	if (numThreads == 0) { //hardware_concurrency is allowed to say "I don't know."
+		numThreads = 1;
+	}
+
+}
+
+WorkStealingPool::WorkStealingPool(unsigned threadCount) {
+
+	numThreads = (threadCount == 0) ? 1 : threadCount;
+
+}
+
+
+
+//*******************************************************************************************************************************************
+//
+//Function run deals the tasks round-robin into one deque per worker and starts the workers. No new tasks ever show up during a run, so a
+//worker that finds its own queue and every other queue empty can simply quit. Each deque has its own mutex; the owner and a thief only
+//ever contend when they're after the same queue at the same moment.
+//
+//*******************************************************************************************************************************************
+
+void WorkStealingPool::run(const vector <size_t>& taskOrder, const function <void(size_t)>& task) const {
+
+	struct WorkerQueue {
+
+		mutex queueLock;
+		deque <size_t> tasks;
+
+	};
+
+	unsigned workerCount = numThreads;
+
+	if (taskOrder.size() < workerCount) {
+		workerCount = static_cast<unsigned>(taskOrder.size());
+	}
+
+	if (workerCount <= 1) { //Not worth starting a thread for.
+
+		for (size_t taskID : taskOrder) {
+			task(taskID);
+		}
+
+		return;
+
+	}
+
+	vector <unique_ptr<WorkerQueue>> queues;
+
+	for (unsigned i = 0; i < workerCount; i++) {
+		queues.push_back(make_unique<WorkerQueue>());
+	}
+
+	for (size_t i = 0; i < taskOrder.size(); i++) {
+		queues[i % workerCount]->tasks.push_back(taskOrder[i]);
+	}
+
+	mutex errorLock;
+	exception_ptr firstError = nullptr;
+
+	auto worker = [&](unsigned self) {
+
+		while (true) {
+
+			size_t taskID = 0;
+			bool haveTask = false;
+
+			{
+				lock_guard <mutex> guard(queues[self]->queueLock);
+
+				if (!queues[self]->tasks.empty()) {
+					taskID = queues[self]->tasks.front();
+					queues[self]->tasks.pop_front();
+					haveTask = true;
+				}
+			}
+
+			for (unsigned offset = 1; !haveTask && offset < workerCount; offset++) { //Own queue is empty, so go steal.
+
+				WorkerQueue& victim = *queues[(self + offset) % workerCount];
+				lock_guard <mutex> guard(victim.queueLock);
+
+				if (!victim.tasks.empty()) {
+					taskID = victim.tasks.back();
+					victim.tasks.pop_back();
+					haveTask = true;
+				}
+
+			}
+
+			if (!haveTask) {
+				return;
+			}
+
+			try {
+				task(taskID);
+			}
+
+			catch (...) {
+				lock_guard <mutex> guard(errorLock);
+
+				if (firstError == nullptr) {
+					firstError = current_exception();
+				}
+			}
+
+		}
+
+	};
+
+	vector <thread> workers;
+
+	for (unsigned i = 1; i < workerCount; i++) {
+		workers.emplace_back(worker, i);
+	}
+
+	worker(0); //The calling thread pulls its weight too.
+
+	for (thread& workerThread : workers) {
+		workerThread.join();
+	}
+
+	if (firstError != nullptr) {
+		rethrow_exception(firstError);
+	}
+
+}
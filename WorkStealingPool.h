@@ -0,0 +1,46 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+using namespace std;
+
+
+//The WorkStealingPool class runs a fixed list of tasks across all cores. Tasks are dealt out to one queue per worker up front; each worker
+//takes from the front of its own queue, and once that runs dry it steals from the back of somebody else's. If the tasks are dealt
+//largest-first, the big ones start early and the small ones at the tail fill in the gaps, so one huge file can't leave the other cores idle.
+
+class WorkStealingPool {
+
+	private:
+
+		unsigned numThreads;
+
+	public:
+
+		//Constructors and destructor
+
+		WorkStealingPool(); //See WorkStealingPool.cpp for definitions. Uses one thread per core.
+
+		WorkStealingPool(unsigned threadCount);
+
+		~WorkStealingPool() {}
+
+
+		//Runs task(taskOrder[0]), task(taskOrder[1]), ... and returns once every one has finished. The first exception a task throws is
+		//rethrown here after all the workers have stopped.
+		void run(const vector <size_t>& taskOrder, const function <void(size_t)>& task) const;
+
+
+
+		//Accessors
+
+		unsigned getNumThreads() const
+		{
+			return numThreads;
+		}
+
+};
+
+#endif
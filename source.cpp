@@ -44,63 +44,189 @@ See the README in the GitHub repository for how to use the program and test data
 
 
 #include <iostream>
-#include <iomanip>
 #include <fstream>
-#include <sstream>
 #include <cctype>
+#include <chrono>
+#include <csignal>
+#include <iomanip>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
-#include <cmath>
-#include "Schema.h"
-#include "InvDocument.h"
-#include "ElementData.h"
+#include "InvoicePipeline.h"
+#include "BatchProcessor.h"
+#include "EnvelopeStreamParser.h"
+#include "SchemaValidator.h"
+#include "InvoiceTotalReconciler.h"
+#include "SyntheticInvoiceGenerator.h"
+#include "InvoiceBenchmark.h"
+#include "InvoiceCacheFile.h"
+#include "WatchFolderIngestor.h"
+#include "HeadlessRunner.h"
+#include "ParallelTokenizer.h"
+#include "InvoiceAnalytics.h"
+#include "PipelineStats.h"
+#include "EdiWriter.h"
 //#include "TestFunctions.h"
 using namespace std;
 
 
-fstream openInvoiceInputFile();
-string readInvoiceInputFile(fstream&, int&, int&);
-void closeInvoiceInputFile(fstream&);
-InvDocument* populateInvoiceDocumentStructureArr(InvDocument*, string, const int, const int);
-vector <ElementData>& populateElementDataVect(vector <ElementData>&, InvDocument*, const int, const int);
-string generateElementID(string, int);
-void displayElementDataVectContents(vector <ElementData>&);
-int lookupSequenceNumberForElement(vector <ElementData>&, string);
-double convertStringtoDoubleCustom(string);
-fstream& openBinaryOutputFile(fstream&);
-void closeBinaryOutputFile(fstream&);
-void renderInvoiceForHumans(vector <ElementData>&);
-fstream& renderInvoiceForHumans(vector <ElementData>&, fstream&); //Overloaded function.
-
-int displayMenu(int VIEW_HUMAN_INVOICE_ON_CONSOLE, int OUTPUT_HUMAN_INVOICE_TO_FILE, int VIEW_MACHINE_INVOICE, int QUIT);
+int displayMenu(int VIEW_HUMAN_INVOICE_ON_CONSOLE, int OUTPUT_HUMAN_INVOICE_TO_FILE, int VIEW_MACHINE_INVOICE, int VALIDATE_INVOICE, int QUIT);
 bool getYNResponseAsBool();
+int runBatchMode(int argc, char* argv[]);
+int runStreamMode(int argc, char* argv[]);
+int runParallelMode(int argc, char* argv[]);
+bool appendTransactionSet(const EdiTokenizer& invoiceTokenizer, const SchemaValidator& schemaValidator, const InvoiceTotalReconciler& totalReconciler, InvoiceDocumentStore& documentStore, ElementIndex& elementIndex, InvoiceLoopTree& loopTree, RenderBuffer& renderBuffer, size_t& numSchemaInvalid, size_t& numTotalMismatched);
+int runAnalyzeMode(int argc, char* argv[]);
+int runGenerateMode(int argc, char* argv[]);
+int runBenchMode(int argc, char* argv[]);
+int runWriteCacheMode(int argc, char* argv[]);
+int runReadCacheMode(int argc, char* argv[]);
+int runWriteX12Mode(int argc, char* argv[]);
+int runWatchMode(int argc, char* argv[]);
+int runHeadlessMode(int argc, char* argv[]);
+void requestWatchStop(int);
+void writePipelineStatsAtExit();
+void displayMemorySummaryAtExit();
+
 
+volatile sig_atomic_t watchStopRequested = 0; //Set by the Ctrl+C handler in watch mode; nothing else in the program touches it.
+string pipelineStatsPath; //Where --stats writes its report when the program ends. Empty when stats are off.
 
-int main() {
+
+int main(int argc, char* argv[]) {
 
 	const int VIEW_HUMAN_INVOICE_ON_CONSOLE = 1; //I could have made these global, but they only get passed to menuSelection, so easy enough to manage this way.
 	const int OUTPUT_HUMAN_INVOICE_TO_FILE = 2;
 	const int VIEW_MACHINE_INVOICE = 3;
-	const int QUIT = 4;
+	const int VALIDATE_INVOICE = 4;
+	const int QUIT = 5;
 
 	bool again = true;
 	int menuSelection;
-	fstream invoiceInputFile;
+	EdiInputFile invoiceInputFile;
 	fstream invoiceBinaryOutputFile;
-	string invoiceInputFileContentsStr;
+	string_view invoiceInputFileContentsStr;
 	int totalElementDelimiterCounter = 0;
 	int totalLineDelimiterCounter = 0;
+	EdiTokenizer invoiceTokenizer;
+	ElementIndex elementIndex;
+	InvoiceDocumentStore documentStore;
+	InvoiceLoopTree loopTree;
+	LazyInvoiceDocument lazyDocument;
+	SchemaValidator schemaValidator;
+	InvoiceTotalReconciler totalReconciler;
+	RenderBuffer renderBuffer; //Reused for every render from the menu.
+	ConsoleOutputSink consoleSink;
+	StreamOutputSink invoiceFileSink(invoiceBinaryOutputFile);
+
+
+	//Any mode, or the menu, can be run with per-stage timings and counters written out at the end: program --stats <file.json | file.csv> ...
+	//and/or with allocation tracking and a memory summary on stderr at the end: program --memstats ...
+	//Both are reported from atexit handlers so every way out of the program (a mode returning, QUIT, exit) produces them.
+
+	while (argc > 1 && (string(argv[1]) == "--stats" || string(argv[1]) == "--memstats")) {
+
+		int numOptionArgs = 1;
+
+		if (string(argv[1]) == "--memstats") {
+			enableAllocationTracking();
+			atexit(displayMemorySummaryAtExit);
+		}
+
+		else if (argc < 3) {
+			cout << "Usage: " << argv[0] << " [--stats <file.json | file.csv>] [--memstats] [mode and its arguments]" << endl;
+			return EXIT_FAILURE;
+		}
+
+		else {
+			pipelineStatsPath = argv[2];
+			enablePipelineStats();
+			atexit(writePipelineStatsAtExit);
+			numOptionArgs = 2;
+		}
+
+		argv[numOptionArgs] = argv[0]; //Drop the option so the mode sees the arguments it always has.
+		argv += numOptionArgs;
+		argc -= numOptionArgs;
+
+	}
+
+	//Headless mode is for schedulers and scripts: no menu, no prompts, no shell, and an exit code per outcome. See HeadlessRunner.h.
+
+	if (argc > 1 && string(argv[1]) == "--headless") {
+		return runHeadlessMode(argc, argv);
+	}
+
+	//Batch mode skips the menu entirely: program --batch <directory | file | @listFile> ...
+
+	if (argc > 1 && string(argv[1]) == "--batch") {
+		return runBatchMode(argc, argv);
+	}
+
+	//Stream mode reads one (possibly huge) interchange a chunk at a time: program --stream <file>
+
+	if (argc > 1 && string(argv[1]) == "--stream") {
+		return runStreamMode(argc, argv);
+	}
+
+	//Parallel mode tokenizes one big interchange on every core instead of reading it a chunk at a time: program --parallel <file> [threads]
+
+	if (argc > 1 && string(argv[1]) == "--parallel") {
+		return runParallelMode(argc, argv);
+	}
+
+	//Spend totals across a pile of invoices: program --analyze [--top <n>] <directory | file | @listFile> ...
+
+	if (argc > 1 && string(argv[1]) == "--analyze") {
+		return runAnalyzeMode(argc, argv);
+	}
+
+	//Synthetic test data and benchmarks: program --generate <file> [megabytes] [seed], program --bench [megabytes] [seed]
+
+	if (argc > 1 && string(argv[1]) == "--generate") {
+		return runGenerateMode(argc, argv);
+	}
+
+	if (argc > 1 && string(argv[1]) == "--bench") {
+		return runBenchMode(argc, argv);
+	}
+
+	//Binary cache of a parsed invoice: program --write-cache <invoiceFile> <cacheFile>, program --read-cache <cacheFile>
+
+	if (argc > 1 && string(argv[1]) == "--write-cache") {
+		return runWriteCacheMode(argc, argv);
+	}
+
+	if (argc > 1 && string(argv[1]) == "--read-cache") {
+		return runReadCacheMode(argc, argv);
+	}
+
+	//Writing X12 back out: program --write-x12 <invoiceFile> <outputFile> [--delimiters <chars>] [--renumber [firstISA13]]
+
+	if (argc > 1 && string(argv[1]) == "--write-x12") {
+		return runWriteX12Mode(argc, argv);
+	}
+
+	//Watch mode renders invoices as they're dropped into a folder until Ctrl+C: program --watch <directory> [outputDirectory] [--poll]
+
+	if (argc > 1 && string(argv[1]) == "--watch") {
+		return runWatchMode(argc, argv);
+	}
 
 
 	//*******************************************************************************************************************************************************************************
 	//This is all preprocessing activity before getting to the menu/first user prompt.
 
 
-	//Open, read, close inputFile to pre-process/get set up. Also get the number of rows/columns (even though each row has a variable number of contents) while reading it.
-	
+	//Open and read inputFile to pre-process/get set up. Also get the number of rows/columns (even though each row has a variable number of contents) while reading it.
+	//The file stays mapped until the program ends because the tokenizer only holds views into it.
+
+	InvoiceAllocationScope invoiceAllocationScope("krogerSampleInvoice810.dat"); //What reading and building the invoice needs, for --memstats.
+
 	try {
 
-		invoiceInputFile = openInvoiceInputFile();
+		openInvoiceInputFile(invoiceInputFile);
 
 	}
 	
@@ -109,7 +235,7 @@ int main() {
 		cout << exceptionMsg;
 		cout << "Try one more time and press any key: ";
 		cin.get();
-		invoiceInputFile = openInvoiceInputFile();
+		openInvoiceInputFile(invoiceInputFile);
 
 	}
 
@@ -121,19 +247,29 @@ int main() {
 	}
 
 
-	invoiceInputFileContentsStr = readInvoiceInputFile(invoiceInputFile, totalElementDelimiterCounter, totalLineDelimiterCounter);
-	closeInvoiceInputFile(invoiceInputFile);
+	invoiceTokenizer.addSegmentObserver(&schemaValidator); //Validates each segment against Schema.h as it's tokenized, so there's no second pass.
+	invoiceTokenizer.addSegmentObserver(&totalReconciler); //Adds up the line items in the same pass and checks them against TDS01.
+	invoiceInputFileContentsStr = readInvoiceInputFile(invoiceInputFile, invoiceTokenizer, totalElementDelimiterCounter, totalLineDelimiterCounter);
 
 
-	//Create a dynamically allocated array to store the invoice document structure info.
-	InvDocument* invDocumentStructureArr = nullptr;
-	invDocumentStructureArr = new InvDocument[totalLineDelimiterCounter];
-	
-	invDocumentStructureArr = populateInvoiceDocumentStructureArr(invDocumentStructureArr, invoiceInputFileContentsStr, totalElementDelimiterCounter, totalLineDelimiterCounter);
+	//The InvDocument and ElementData objects are only built when something asks for one (see LazyInvoiceDocument.h); the machine-readable
+	//view is the only thing that still wants them, and it builds each one just long enough to print it.
+	lazyDocument.attach(invoiceTokenizer);
+
+	try {
+		documentStore.build(invoiceTokenizer); //Compact column storage the renderers read from.
+	}
+
+	catch (string exceptionMsg) {
+
+		cout << exceptionMsg;
+		exit(EXIT_FAILURE);
 
-	vector <ElementData> elementDataVect;
+	}
 
-	elementDataVect = populateElementDataVect(elementDataVect, invDocumentStructureArr, totalElementDelimiterCounter, totalLineDelimiterCounter);
+	elementIndex.build(invoiceTokenizer); //Built once here so the renderers never have to search for elements.
+	loopTree.build(documentStore); //N1, IT1 and SAC loops as ranges of segments, so the renderers can walk every line item.
+	invoiceAllocationScope.close();
 
 
 
@@ -147,23 +283,47 @@ int main() {
 
 	while (again) {
 
-		menuSelection = displayMenu(VIEW_HUMAN_INVOICE_ON_CONSOLE, OUTPUT_HUMAN_INVOICE_TO_FILE, VIEW_MACHINE_INVOICE, QUIT);
+		menuSelection = displayMenu(VIEW_HUMAN_INVOICE_ON_CONSOLE, OUTPUT_HUMAN_INVOICE_TO_FILE, VIEW_MACHINE_INVOICE, VALIDATE_INVOICE, QUIT);
 
 		switch (menuSelection) {
 
 		case VIEW_HUMAN_INVOICE_ON_CONSOLE:
 
 			system("cls"); //Clear the screen to remove clutter.
-			renderInvoiceForHumans(elementDataVect); //This is the console output version.
+			renderInvoiceForHumans(documentStore, elementIndex, loopTree, renderBuffer, consoleSink);
 
 			break;
 
 		case OUTPUT_HUMAN_INVOICE_TO_FILE:
 
 			system("cls"); //Clear the screen to remove clutter.
-			openBinaryOutputFile(invoiceBinaryOutputFile);
-			renderInvoiceForHumans(elementDataVect, invoiceBinaryOutputFile); //The is the file output version.
-			closeBinaryOutputFile(invoiceBinaryOutputFile);
+
+			if (!openBinaryOutputFile(invoiceBinaryOutputFile).is_open()) {
+
+				invoiceBinaryOutputFile.clear();
+				cout << "ERROR. Could not open \"invoiceOutputFile.dat\" for writing. No file was written." << endl;
+
+				break;
+
+			}
+
+			try {
+
+				renderInvoiceForHumans(documentStore, elementIndex, loopTree, renderBuffer, invoiceFileSink); //Same text as the console, just a different sink.
+				closeBinaryOutputFile(invoiceBinaryOutputFile);
+
+			}
+
+			catch (string exceptionMsg) { //A full disk, most likely. Closed here so the next try starts with a fresh file.
+
+				invoiceBinaryOutputFile.clear();
+				invoiceBinaryOutputFile.close();
+				cout << exceptionMsg << "\"invoiceOutputFile.dat\" is incomplete." << endl;
+
+				break;
+
+			}
+
 			cout << "File output complete. If a previous file existed, it has been overwritten. See \"invoiceOutputFile.dat\" in the program's directory." << endl;
 
 			break;
@@ -171,13 +331,25 @@ int main() {
 		case VIEW_MACHINE_INVOICE:
 
 			system("cls"); //Clear the screen to remove clutter.
-			displayElementDataVectContents(elementDataVect);
+			displayElementDataVectContents(lazyDocument);
+
+			break;
+
+		case VALIDATE_INVOICE:
+
+			system("cls"); //Clear the screen to remove clutter.
+			cout << "Schema validation against the Kroger 810 implementation convention:" << endl << endl;
+			schemaValidator.displayErrors(cout);
+			cout << endl << "Total reconciliation (TDS01 against the line items):" << endl << endl;
+			totalReconciler.displayResults(cout);
+			cout << endl << (schemaValidator.isValid() && totalReconciler.isReconciled() ? "The invoice is valid." : "The invoice is NOT valid.") << endl;
 
 			break;
 
 
 		case QUIT:
 
+			closeInvoiceInputFile(invoiceInputFile);
 			cout << "Program terminating..." << endl;
 			return 0;
 
@@ -194,9 +366,7 @@ int main() {
 
 
 
-	delete[] invDocumentStructureArr; //Do some memory management. This array isn't needed after the vector is populated... At least in this implementation.
-	invDocumentStructureArr = nullptr;
-
+	closeInvoiceInputFile(invoiceInputFile);
 
 	cout << endl << endl;
 	system("pause");
@@ -205,69 +375,93 @@ int main() {
 }
 
 //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
- 
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
 //*******************************************************************************************************************************************
 //
-//Function openInvoiceInputFile simply opens a file and passes it back (I did not pass it back by reference, although I could have. These
-//files are pretty lightweight. Process and close activites are left to other functions.
+//Function runHeadlessMode parses the arguments after --headless and runs them. Everything but the invoices themselves goes to stderr, so
+//stdout can be piped straight into the next job.
 //
 //*******************************************************************************************************************************************
 
+int runHeadlessMode(int argc, char* argv[]) {
 
-fstream openInvoiceInputFile() {
+	HeadlessRunner headlessRunner;
 
-	fstream invoiceInputFile;
-	invoiceInputFile.open("krogerSampleInvoice810.dat", ios::in);
-	string cannotLocateFileException = "ERROR. File cannot open. Please check the directory.\n";
+	try {
+
+		headlessRunner.parseArguments(argc, argv, 2);
 
-	if (!invoiceInputFile) {
+	}
+
+	catch (string exceptionMsg) {
 
-		throw cannotLocateFileException;
+		cerr << exceptionMsg << HeadlessRunner::getUsage(argv[0]);
+		return HEADLESS_EXIT_USAGE;
 
 	}
 
-	return invoiceInputFile;
+	return headlessRunner.run(cerr);
 
 }
 
 
 
-
 //*******************************************************************************************************************************************
 //
-//Function readInvoiceInputFile takes in the inputFile by reference, modifies reference variables for a couple key things to set up other 
-//functions (number of lines, number of elements total), and outputs all the inputFile's contents into a string variable.
+//Function runBatchMode hands every path after --batch to a BatchProcessor, renders all of the invoices across every core, and writes them
+//in input order to batchInvoiceOutputFile.dat. Throughput is printed at the end. Returns nonzero if any file failed.
 //
 //*******************************************************************************************************************************************
 
-string readInvoiceInputFile(fstream &invoiceInputFile, int &totalElementDelimiterCounter, int &totalLineDelimiterCounter) {
+int runBatchMode(int argc, char* argv[]) {
+
+	BatchProcessor batchProcessor;
+	FileOutputSink batchOutputSink;
+
+	try {
+
+		for (int i = 2; i < argc; i++) {
+			batchProcessor.addInputPath(argv[i]);
+		}
 
-	string fileContentsStr;
+	}
 
-	char elementDelimiter = '*';
-	char lineDelimiter = '~';
+	catch (string exceptionMsg) {
 
-	totalElementDelimiterCounter = 0; //Just to be safe.
-	totalLineDelimiterCounter = 0;
+		cout << exceptionMsg;
+		return EXIT_FAILURE;
 
-	while (getline(invoiceInputFile, fileContentsStr)) {
+	}
 
-		for (int i = 0; i < fileContentsStr.length(); i++) {
+	if (batchProcessor.getNumInputFiles() == 0) {
 
-			if (fileContentsStr.at(i) == elementDelimiter) {
-				totalElementDelimiterCounter++;
-			}
+		cout << "Usage: " << argv[0] << " --batch <directory | file | @listFile> ..." << endl;
+		return EXIT_FAILURE;
 
-			else if (fileContentsStr.at(i) == lineDelimiter) {
-				totalLineDelimiterCounter++;
-			}
+	}
 
-		}
+	batchProcessor.run();
+
+	try {
+
+		batchOutputSink.open("batchInvoiceOutputFile.dat");
+		batchProcessor.writeResults(batchOutputSink);
+		batchOutputSink.close();
 
 	}
-	
-	return fileContentsStr;
+
+	catch (string exceptionMsg) {
+
+		cout << exceptionMsg;
+		return EXIT_FAILURE;
+
+	}
+
+	batchProcessor.displaySummary(cout);
+	cout << "Rendered invoices written to \"batchInvoiceOutputFile.dat\"." << endl;
+
+	return (batchProcessor.getNumFailures() == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
 
 }
 
@@ -275,85 +469,148 @@ string readInvoiceInputFile(fstream &invoiceInputFile, int &totalElementDelimite
 
 //*******************************************************************************************************************************************
 //
-//Function closeInvoiceInputFile simply closes the inputFile if it is open.
+//Function appendTransactionSet renders one transaction set that has just been tokenized (with schemaValidator and totalReconciler attached
+//as observers) into renderBuffer: any schema or TDS01 report first, then the invoice itself, the way stream and parallel mode both write
+//them. If the set isn't one the renderers can take, a FAILED line goes in instead and it returns false. The store, index, and loop tree
+//are the caller's so they can be reused from one set to the next.
 //
 //*******************************************************************************************************************************************
 
-void closeInvoiceInputFile(fstream &invoiceInputFile) {
+bool appendTransactionSet(const EdiTokenizer& invoiceTokenizer, const SchemaValidator& schemaValidator, const InvoiceTotalReconciler& totalReconciler, InvoiceDocumentStore& documentStore, ElementIndex& elementIndex, InvoiceLoopTree& loopTree, RenderBuffer& renderBuffer, size_t& numSchemaInvalid, size_t& numTotalMismatched) {
+
+	string errorMessage;
+
+	if (!validateInvoiceEnvelope(invoiceTokenizer, errorMessage)) {
+
+		renderBuffer << "FAILED: " << errorMessage << "\n\n";
+		return false;
+
+	}
+
+	if (!schemaValidator.getErrors().empty()) {
+
+		ostringstream schemaReport;
+		schemaValidator.displayErrors(schemaReport);
+		renderBuffer << "Schema validation:\n" << schemaReport.str() << "\n";
+		numSchemaInvalid += !schemaValidator.isValid();
 
-	if (invoiceInputFile.is_open()) {
-		invoiceInputFile.close();
 	}
 
+	if (!totalReconciler.isReconciled()) {
+
+		ostringstream totalReport;
+		totalReconciler.displayResults(totalReport);
+		renderBuffer << "Total reconciliation:\n" << totalReport.str() << "\n";
+		numTotalMismatched++;
+
+	}
+
+	try {
+		documentStore.build(invoiceTokenizer); //Resets the arena from the previous transaction set first.
+	}
+
+	catch (const string& buildError) { //Too big for the store's columns.
+
+		renderBuffer << "FAILED: " << buildError << "\n";
+		return false;
+
+	}
+
+	elementIndex.build(invoiceTokenizer);
+	loopTree.build(documentStore);
+	appendInvoiceForHumans(documentStore, elementIndex, loopTree, renderBuffer);
+	renderBuffer << "\n";
+
+	return true;
+
 }
 
 
 
 //*******************************************************************************************************************************************
 //
-//Function populateInvoiceDocumentStructureArr populates the invoiceDocumentStructureArr array of type InvDocument to have key items
-//about the document's structure in one place within InvDocument instances' member variables. InvDocument is the base class for the ElementData
-//derived class.
+//Function runStreamMode pulls one transaction set at a time out of an ISA/GS/ST interchange and renders each to
+//streamInvoiceOutputFile.dat as soon as it's complete. The tokenizer, document store, and index are reused for every transaction set (the
+//store's arena is just reset each time), so memory stays flat no matter how big the interchange is.
 //
 //*******************************************************************************************************************************************
 
-InvDocument* populateInvoiceDocumentStructureArr(InvDocument* invoiceDocumentStructureArr, string fileContentsStr, const int totalElementDelimiterCounter, const int totalLineDelimiterCounter) {
+int runStreamMode(int argc, char* argv[]) {
 
-	int index = 0;
-	int lineElementCounter = 0;
-	int lineLength = 0;
-	char elementDelimiter = '*';
-	char lineDelimiter = '~';
-	char charBuffer = '@';
-	stringstream fileContentsStream; //Setting up a stringstream to make parsing much friendlier.
-	stringstream lineContentsStream;
-	string lineBuffer;
-	string elementBuffer;
+	EnvelopeStreamParser streamParser;
+	TransactionSet transactionSet;
+	EdiTokenizer invoiceTokenizer;
+	ElementIndex elementIndex;
+	InvoiceDocumentStore documentStore;
+	InvoiceLoopTree loopTree;
+	SchemaValidator schemaValidator;
+	InvoiceTotalReconciler totalReconciler;
+	FileOutputSink streamOutputSink;
+	RenderBuffer renderBuffer; //One transaction set at a time, so one buffer does for the whole interchange.
+	size_t numFailures = 0;
+	size_t numSchemaInvalid = 0;
+	size_t numTotalMismatched = 0;
 
-	fileContentsStream << fileContentsStr;
-	
-	//This first loop gets all things EXCEPT the number of elements in an array. While this could probably be written a bit more efficiently with a single loop, I figured I was tempting fate.
+	if (argc < 3) {
 
-	while (getline(fileContentsStream, lineBuffer, lineDelimiter)){ //Go through the entire document, which is now represented as FileContentsStream.
-		
-		invoiceDocumentStructureArr[index].setLineContents(lineBuffer);
-		invoiceDocumentStructureArr[index].setLineLength(lineBuffer.length());
-		invoiceDocumentStructureArr[index].setSequence(index + 1);
+		cout << "Usage: " << argv[0] << " --stream <interchangeFile>" << endl;
+		return EXIT_FAILURE;
+
+	}
+
+	try {
 
-		lineContentsStream << lineBuffer;
+		streamParser.open(argv[2]);
+		streamOutputSink.open("streamInvoiceOutputFile.dat");
 
-		getline(lineContentsStream, elementBuffer, elementDelimiter); //Go through each line to just extract the first segment (beginning of line until * delimiter).
-		invoiceDocumentStructureArr[index].setSegmentID(elementBuffer);
-		invoiceDocumentStructureArr[index].setSegmentIDLen(elementBuffer.length());
+	}
 
-		index++;
+	catch (string exceptionMsg) {
 
-		lineContentsStream.str("");  //This isn't covered in the Gaddis book (I don't think it is, at least), so I had to research why my segmentLinesArray wasn't advancing with each iteration. Turns out the entireLine needs to be reset/cleared each time using these member functions. Can't just overwrite with each pass through the for loop. https://cplusplus.com/reference/sstream/stringstream/?kw=stringstream
-		lineContentsStream.clear();
+		cout << exceptionMsg;
+		return EXIT_FAILURE;
 
 	}
 
-	//Second loop gets the number of delimiters per line and populates the arribute for each item in the InvDocument array accordingly. Clear the buffer first just to be safe.
-	lineBuffer = "";
+	invoiceTokenizer.addSegmentObserver(&schemaValidator); //Starts over for each transaction set in beginDocument.
+	invoiceTokenizer.addSegmentObserver(&totalReconciler); //So does this one.
 
-	for (int i = 0; i < totalLineDelimiterCounter; i++) {
+	try {
 
-		lineBuffer = invoiceDocumentStructureArr[i].getLineContents();
-		lineElementCounter = 0;
+		while (streamParser.nextTransactionSet(transactionSet)) {
 
-		for (int j = 0; j < lineBuffer.length(); j++) {
+			InvoiceAllocationScope allocationScope("transaction set", transactionSet.sequence);
 
-			if (lineBuffer.at(j) == elementDelimiter) {
-				lineElementCounter++;
-			}
+			invoiceTokenizer.setDelimiters(transactionSet.delimiters); //Whatever the enclosing ISA declared.
+			invoiceTokenizer.tokenize(transactionSet.contents);
+
+			renderBuffer.clear();
+			renderBuffer << "===== Transaction set " << transactionSet.sequence << " (ISA13 " << transactionSet.interchangeControlNumber << ", GS06 " << transactionSet.groupControlNumber << ") =====\n";
+
+			numFailures += !appendTransactionSet(invoiceTokenizer, schemaValidator, totalReconciler, documentStore, elementIndex, loopTree, renderBuffer, numSchemaInvalid, numTotalMismatched);
+			streamOutputSink.write(renderBuffer); //Header, schema report, and invoice in one write.
 
 		}
 
-		invoiceDocumentStructureArr[i].setNumElements(lineElementCounter + 1); //Add 1 to the counter since we just counted delimiters and there's content ahead of the first delimiter.
+	}
+
+	catch (string exceptionMsg) { //The output file stopped taking writes (a full disk, most likely).
 
+		cout << exceptionMsg;
+		return EXIT_FAILURE;
+
+	}
+
+	streamOutputSink.close();
+
+	for (const string& envelopeError : streamParser.getEnvelopeErrors()) {
+		cout << "Envelope error: " << envelopeError << endl;
 	}
 
-	return invoiceDocumentStructureArr;
+	cout << "Streamed " << streamParser.getTransactionSetsReturned() << " transaction set(s) from " << streamParser.getBytesConsumed() << " bytes, " << numFailures << " failed, " << numSchemaInvalid << " with schema errors, " << numTotalMismatched << " with a TDS01 total that doesn't add up." << endl;
+	cout << "Rendered invoices written to \"streamInvoiceOutputFile.dat\"." << endl;
+
+	return (numFailures == 0 && streamParser.getEnvelopeErrors().empty()) ? EXIT_SUCCESS : EXIT_FAILURE;
 
 }
 
@@ -361,57 +618,102 @@ InvDocument* populateInvoiceDocumentStructureArr(InvDocument* invoiceDocumentStr
 
 //*******************************************************************************************************************************************
 //
-//Function populateElementDataVect extracts tokens from the EDI file, with the help of data stored within invDocumentStructureArr and general
-//row/column-like size information previously sought, and populates a vector containing ElementData objects. The output of this function
-//is the elementDataVect vector passed back by reference with every element in the EDI document mapped to a particular segment address.
+//Function runParallelMode maps one whole interchange and tokenizes it across every core (or the number of threads given) with a
+//ParallelTokenizer. Unlike stream mode the whole file is held at once, so this is for files that fit in memory but take too long to parse
+//on one core. The merged tables are then cut at ST..SE by segment number (see splitTransactionSets), and each transaction set is taken
+//straight out of them, without scanning its text again, for validation and rendering to parallelInvoiceOutputFile.dat exactly as stream
+//mode writes it. The parse and the whole run are both timed, and throughput is printed for each. The interchange is read with the
+//separators from its first ISA.
 //
 //*******************************************************************************************************************************************
 
-vector <ElementData>& populateElementDataVect(vector <ElementData>& elementDataVect, InvDocument* invDocumentStructureArr, const int totalElementDelimiterCounter, const int totalLineDelimiterCounter) {
+int runParallelMode(int argc, char* argv[]) {
 
-	string token;
-	string tempSegmentID;
-	char elementDelimiter = '*';
-	stringstream contents;
-	ElementData tempObject;
+	EdiInputFile invoiceInputFile;
+	EdiTokenizer invoiceTokenizer;
+	EdiTokenizer transactionSetTokenizer; //Carries the observers, one transaction set at a time.
+	vector <TransactionSetRange> transactionSetRanges;
+	ElementIndex elementIndex;
+	InvoiceDocumentStore documentStore;
+	InvoiceLoopTree loopTree;
+	SchemaValidator schemaValidator;
+	InvoiceTotalReconciler totalReconciler;
+	FileOutputSink parallelOutputSink;
+	RenderBuffer renderBuffer;
+	size_t numFailures = 0;
+	size_t numSchemaInvalid = 0;
+	size_t numTotalMismatched = 0;
 
+	if (argc < 3) {
 
-	//Iterate through each element using the element length and handling for the delimiter *.
+		cout << "Usage: " << argv[0] << " --parallel <interchangeFile> [threads]" << endl;
+		return EXIT_FAILURE;
 
+	}
 
-	for (int i = 0; i < totalLineDelimiterCounter; i++) { //Iterate through each document line.
+	ParallelTokenizer parallelTokenizer((argc > 3) ? static_cast<unsigned>(atoi(argv[3])) : thread::hardware_concurrency());
 
-		contents << invDocumentStructureArr[i].getLineContents(); //Assign the contents of the line from the document structure array to a stringstream that can then be parsed into tokens with getline.
+	try {
 
-		tempSegmentID = invDocumentStructureArr[i].getSegmentID(); //Use this to make a linkage with each element and line using the segmentID from InvDocument. This is where all that work to get to inheritance pays off.
-		
-		for (int j = 0; j < invDocumentStructureArr[i].getNumElements(); j++) {
-			
-			getline(contents, token, elementDelimiter);
-			
-			if (token == "") { //Explicitly write that a token is null if there's nothing between delimiters.
-				token = "NULL";
-			}
+		openInvoiceInputFile(invoiceInputFile, argv[2]);
+		parallelOutputSink.open("parallelInvoiceOutputFile.dat");
+
+	}
+
+	catch (string exceptionMsg) {
+
+		cout << exceptionMsg;
+		return EXIT_FAILURE;
+
+	}
+
+	chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+
+	parallelTokenizer.tokenize(invoiceInputFile.getContents(), invoiceTokenizer);
 
-			//Populate elements.
+	double parseSeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
 
-			tempObject.setStrValue(token);
-			tempObject.setElementLength(token.length());
-			tempObject.setSegmentID(tempSegmentID);
-			tempObject.setElementNum(generateElementID(tempSegmentID, j)); //Function generateElementID does some work that I offloaded to simplify the instant function.
+	splitTransactionSets(invoiceTokenizer, transactionSetRanges);
+	transactionSetTokenizer.addSegmentObserver(&schemaValidator); //Both start over for each transaction set in beginDocument.
+	transactionSetTokenizer.addSegmentObserver(&totalReconciler);
 
-			elementDataVect.push_back(tempObject);
+	try {
+
+		for (const TransactionSetRange& transactionSetRange : transactionSetRanges) {
+
+			transactionSetTokenizer.tokenize(invoiceTokenizer, transactionSetRange.firstSegment, transactionSetRange.numSegments);
 
-			
+			renderBuffer.clear();
+			renderBuffer << "===== Transaction set " << transactionSetRange.sequence << " (ISA13 " << transactionSetRange.interchangeControlNumber << ", GS06 " << transactionSetRange.groupControlNumber << ") =====\n";
+
+			numFailures += !appendTransactionSet(transactionSetTokenizer, schemaValidator, totalReconciler, documentStore, elementIndex, loopTree, renderBuffer, numSchemaInvalid, numTotalMismatched);
+			parallelOutputSink.write(renderBuffer);
 
 		}
 
-		contents.str("");
-		contents.clear();
+		parallelOutputSink.close();
+
+	}
+
+	catch (string exceptionMsg) {
+
+		cout << exceptionMsg;
+		return EXIT_FAILURE;
 
 	}
 
-	return elementDataVect;
+	double totalSeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+	double megabytes = invoiceInputFile.getSize() / (1024.0 * 1024.0);
+
+	cout << "Tokenized " << invoiceTokenizer.getNumSegments() << " segments and " << invoiceTokenizer.getNumElements() << " elements in " << parallelTokenizer.getNumChunksUsed() << " chunk(s) on " << parallelTokenizer.getNumThreads() << " thread(s)." << endl;
+	cout << "Rendered " << transactionSetRanges.size() << " transaction set(s), " << numFailures << " failed, " << numSchemaInvalid << " with schema errors, " << numTotalMismatched << " with a TDS01 total that doesn't add up." << endl;
+	cout << fixed << setprecision(3) << "Parse: " << parseSeconds << " s, " << setprecision(1) << megabytes / ((parseSeconds > 0.0) ? parseSeconds : 1e-9) << " MB/s" << endl;
+	cout << setprecision(3) << "Total (parse, validate, render, write): " << totalSeconds << " s, " << setprecision(1) << megabytes / ((totalSeconds > 0.0) ? totalSeconds : 1e-9) << " MB/s" << endl;
+	cout << "Rendered invoices written to \"parallelInvoiceOutputFile.dat\"." << endl;
+
+	closeInvoiceInputFile(invoiceInputFile);
+
+	return (numFailures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
 
 }
 
@@ -419,35 +721,51 @@ vector <ElementData>& populateElementDataVect(vector <ElementData>& elementDataV
 
 //*******************************************************************************************************************************************
 //
-//Function generateElementID does some string manipulation to make an element ID for each element in a given segment. The function
-//concatenates the alphanumeric segment ID + 0 (if the position is 0-9) + a numeric position, returning as a string.
+//Function runAnalyzeMode loads the line items of every file given into an InvoiceAnalytics column store and prints the total extended
+//amount plus the top vendors, products, and purchase orders by spend (10 of each unless --top says otherwise; --top 0 lists them all).
 //
 //*******************************************************************************************************************************************
 
-string generateElementID(string segmentID, int elementSequenceNumber) {
+int runAnalyzeMode(int argc, char* argv[]) {
+
+	InvoiceAnalytics invoiceAnalytics;
+	vector <string> inputFiles;
+	size_t topN = 10;
 
-	string generatedElementID;
+	try {
+
+		for (int i = 2; i < argc; i++) {
+
+			if (string(argv[i]) == "--top" && i + 1 < argc) {
+				topN = strtoull(argv[++i], nullptr, 10);
+			}
 
-	//First, make the sequence number itself a string
+			else {
+				BatchProcessor::collectInputFiles(argv[i], inputFiles);
+			}
 
-	if (elementSequenceNumber >= 0 && elementSequenceNumber < 10) {
+		}
 
-		generatedElementID = "0";
-		generatedElementID = generatedElementID.append(to_string(elementSequenceNumber));
-		
 	}
 
-	else {
+	catch (string exceptionMsg) {
 
-		generatedElementID = to_string(elementSequenceNumber);
+		cout << exceptionMsg;
+		return EXIT_FAILURE;
 
 	}
 
-	//Second, prepend the segmentID
+	if (inputFiles.empty()) {
 
-	generatedElementID = segmentID.append(generatedElementID);
+		cout << "Usage: " << argv[0] << " --analyze [--top <n>] <directory | file | @listFile> ..." << endl;
+		return EXIT_FAILURE;
 
-	return generatedElementID;
+	}
+
+	invoiceAnalytics.addFiles(inputFiles);
+	invoiceAnalytics.displayReport(cout, topN);
+
+	return (invoiceAnalytics.getNumFailedFiles() == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
 
 }
 
@@ -455,57 +773,82 @@ string generateElementID(string segmentID, int elementSequenceNumber) {
 
 //*******************************************************************************************************************************************
 //
-//Function displayElementVectContents prints a few pieces of data from an EDI 810 file to the console in a tabular format.
+//Function runGenerateMode writes a synthetic interchange of Kroger 810s (see SyntheticInvoiceGenerator.h) to the file given. The size is in
+//megabytes and defaults to 1; the same seed always gives the same file.
 //
 //*******************************************************************************************************************************************
 
-void displayElementDataVectContents(vector <ElementData>& elementDataVect) {
+int runGenerateMode(int argc, char* argv[]) {
 
-	cout << "#" << setw(20) << "Element ID" << setw(30) << "Value" << endl;
-	cout << "----------------------------------------------------------------------------" << endl;
+	SyntheticInvoiceGenerator invoiceGenerator;
+	ofstream generatedFile;
 
-	for (int i = 0; i < elementDataVect.size(); i++) {
+	if (argc < 3) {
 
-		cout << i << setw(20); //0-9 being single digit makes the formatting quite not aligned, but that's not worth picking at.
-		elementDataVect[i].displayElemNum();
-		cout << setw(30);
-		elementDataVect[i].displayStrValue();
-		cout << endl;
+		cout << "Usage: " << argv[0] << " --generate <outputFile> [megabytes] [seed]" << endl;
+		return EXIT_FAILURE;
 
 	}
 
+	invoiceGenerator.setTargetBytes((argc > 3) ? static_cast<uint64_t>(atof(argv[3]) * 1024 * 1024) : 1024 * 1024);
+	invoiceGenerator.setSeed((argc > 4) ? strtoull(argv[4], nullptr, 10) : 1202);
+
+	generatedFile.open(argv[2], ios::out | ios::binary | ios::trunc);
+
+	if (!generatedFile) {
+
+		cout << "ERROR. Cannot create " << argv[2] << "." << endl;
+		return EXIT_FAILURE;
+
+	}
+
+	uint64_t bytesWritten = invoiceGenerator.generate(generatedFile);
+	generatedFile.close();
+
+	cout << "Wrote " << bytesWritten << " bytes to \"" << argv[2] << "\"." << endl;
+
+	return EXIT_SUCCESS;
+
 }
 
-int lookupSequenceNumberForElement(vector <ElementData>& elementDataVect, string segmentID) {
 
-	int sequenceNumberForElement = -1;
 
-	try {
+//*******************************************************************************************************************************************
+//
+//Function runBenchMode generates benchmarkInvoice810.dat (default 16 MB, seed 1202) and times every pipeline stage against it.
+//
+//*******************************************************************************************************************************************
 
-		for (int i = 0; i < elementDataVect.size(); i++) {
+int runBenchMode(int argc, char* argv[]) {
 
-			if (segmentID == elementDataVect[i].getElementNum()) {
-				sequenceNumberForElement = i;
-			}
+	SyntheticInvoiceGenerator invoiceGenerator;
+	InvoiceBenchmark invoiceBenchmark;
+	ofstream generatedFile;
+	const string BENCHMARK_FILE_NAME = "benchmarkInvoice810.dat";
 
-		}
+	invoiceGenerator.setTargetBytes((argc > 2) ? static_cast<uint64_t>(atof(argv[2]) * 1024 * 1024) : 16 * 1024 * 1024);
+	invoiceGenerator.setSeed((argc > 3) ? strtoull(argv[3], nullptr, 10) : 1202);
 
-	}
+	generatedFile.open(BENCHMARK_FILE_NAME, ios::out | ios::binary | ios::trunc);
+	invoiceGenerator.generate(generatedFile);
+	generatedFile.close();
 
-	catch (string exceptionValueNotFound) {
+	try {
 
-		cout << exceptionValueNotFound << endl;
-		exit(EXIT_SUCCESS);
+		invoiceBenchmark.run(BENCHMARK_FILE_NAME);
 
 	}
 
-	if (sequenceNumberForElement == -1){
+	catch (string exceptionMsg) {
 
-		string exceptionValueNotFound = "Error! Element not found in elementDataVect.";
+		cout << exceptionMsg;
+		return EXIT_FAILURE;
 
 	}
 
-	return sequenceNumberForElement;
+	invoiceBenchmark.displayResults(cout);
+
+	return EXIT_SUCCESS;
 
 }
 
@@ -513,27 +856,44 @@ int lookupSequenceNumberForElement(vector <ElementData>& elementDataVect, string
 
 //*******************************************************************************************************************************************
 //
-//Function convertStringtoDoubleCustom is a exactly as described: it is a custom function I wrote to take in a string and convert it to a
-//double. This demonstrates some low-level stuff with C-strings and pointers.
+//Function runWriteCacheMode parses an invoice file once and saves the result as a binary cache file (see InvoiceCacheFile.h).
 //
 //*******************************************************************************************************************************************
 
-double convertStringtoDoubleCustom(string strToConvert) {
+int runWriteCacheMode(int argc, char* argv[]) {
 
-	double dblConverted = 0.0;
-	int strLength;
-	const char* stringStartPtr; //Have to use const char* with the c_str function because that function returns a pointer to a const char*.
-	
+	EdiInputFile invoiceInputFile;
+	EdiTokenizer invoiceTokenizer;
+	InvoiceDocumentStore documentStore;
+	int totalElementDelimiterCounter = 0;
+	int totalLineDelimiterCounter = 0;
 
-	stringStartPtr = nullptr;
-	
-	strLength = strToConvert.length();
+	if (argc < 4) {
 
-	stringStartPtr = strToConvert.c_str();
+		cout << "Usage: " << argv[0] << " --write-cache <invoiceFile> <cacheFile>" << endl;
+		return EXIT_FAILURE;
 
-	dblConverted = atof(stringStartPtr); //The book says atof converts to a double (I would have thought it'd be float). This appears to work.
+	}
+
+	try {
 
-	return dblConverted;
+		openInvoiceInputFile(invoiceInputFile, argv[2]);
+		readInvoiceInputFile(invoiceInputFile, invoiceTokenizer, totalElementDelimiterCounter, totalLineDelimiterCounter);
+		documentStore.build(invoiceTokenizer);
+		InvoiceCacheFile::write(documentStore, argv[3]);
+
+	}
+
+	catch (string exceptionMsg) {
+
+		cout << exceptionMsg;
+		return EXIT_FAILURE;
+
+	}
+
+	cout << "Cached " << documentStore.getNumSegments() << " segments and " << documentStore.getNumElements() << " elements to \"" << argv[3] << "\"." << endl;
+
+	return EXIT_SUCCESS;
 
 }
 
@@ -541,53 +901,138 @@ double convertStringtoDoubleCustom(string strToConvert) {
 
 //*******************************************************************************************************************************************
 //
-//Function openBinaryOutputFile opens a file expected to receive output from another function.
+//Function runReadCacheMode maps a cache file and renders the invoice in it. Nothing is tokenized; only the element index and loop tree are
+//rebuilt from the cached columns.
 //
 //*******************************************************************************************************************************************
 
-fstream& openBinaryOutputFile(fstream& binaryOutputFile) {
+int runReadCacheMode(int argc, char* argv[]) {
+
+	InvoiceCacheFile invoiceCacheFile;
+	InvoiceDocumentStore documentStore;
+	ElementIndex elementIndex;
+	InvoiceLoopTree loopTree;
+	RenderBuffer renderBuffer;
+	ConsoleOutputSink consoleSink;
 
-	binaryOutputFile.open("invoiceOutputFile.dat", ios::in | ios::binary); //Check to see whether the file is already open.
+	if (argc < 3) {
 
-	if (binaryOutputFile.fail()) {
-		//The file does not exist, so create it.
-		binaryOutputFile.open("invoiceOutputFile.dat", ios::out | ios::binary);
+		cout << "Usage: " << argv[0] << " --read-cache <cacheFile>" << endl;
+		return EXIT_FAILURE;
 
 	}
 
-	else {
+	try {
 
-		binaryOutputFile.close(); //This is just here temporarily. The error handler should do something.
+		invoiceCacheFile.open(argv[2], documentStore);
 
 	}
 
-	return binaryOutputFile;
+	catch (string exceptionMsg) {
 
-}
+		cout << exceptionMsg;
+		return EXIT_FAILURE;
+
+	}
+
+	elementIndex.build(documentStore);
+	loopTree.build(documentStore);
+	renderInvoiceForHumans(documentStore, elementIndex, loopTree, renderBuffer, consoleSink);
+
+	invoiceCacheFile.close();
 
+	return EXIT_SUCCESS;
+
+}
 
 
 
 //*******************************************************************************************************************************************
 //
-//Function closeBinaryOutputFile closes a file passed in by reference from another function.
+//Function runWriteX12Mode reads an invoice file and writes it back out as X12 through EdiWriter, keeping the file's own line breaks. The
+//delimiters default to the ones the file was read with; --delimiters takes the element, segment and sub-element separators (and optionally
+//a repetition separator) as one string, like "*~>" or "|\n^". --renumber hands out fresh control numbers starting from the ISA13 given
+//(1 if none is). It reports whether the output came out byte for byte the same as the input, and how many control fields had to change.
 //
 //*******************************************************************************************************************************************
 
-void closeBinaryOutputFile(fstream& binaryOutputFile) {
+int runWriteX12Mode(int argc, char* argv[]) {
+
+	EdiInputFile invoiceInputFile;
+	EdiTokenizer invoiceTokenizer;
+	InvoiceDocumentStore documentStore;
+	EdiWriter ediWriter;
+	FileOutputSink outputSink;
+	string_view invoiceContents;
+	EdiDelimiters outputDelimiters;
+	bool delimitersGiven = false;
+	int totalElementDelimiterCounter = 0;
+	int totalLineDelimiterCounter = 0;
 
-	if (binaryOutputFile.fail()) {
+	if (argc < 4) {
 
-		//Do nothing.
+		cout << "Usage: " << argv[0] << " --write-x12 <invoiceFile> <outputFile> [--delimiters <chars>] [--renumber [firstISA13]]" << endl;
+		return EXIT_FAILURE;
 
 	}
 
-	else {
+	for (int i = 4; i < argc; i++) {
+
+		string argument = argv[i];
+
+		if (argument == "--delimiters" && i + 1 < argc && (string(argv[i + 1]).length() == 3 || string(argv[i + 1]).length() == 4)) {
 
-		binaryOutputFile.close();
+			string delimiterChars = argv[++i];
+
+			outputDelimiters = { delimiterChars[0], delimiterChars[1], delimiterChars[2], (delimiterChars.length() == 4) ? delimiterChars[3] : '\0', DELIMITERS_DEFAULT };
+			delimitersGiven = true;
+
+		}
+
+		else if (argument == "--renumber") {
+
+			bool firstGiven = i + 1 < argc && isdigit(static_cast<unsigned char>(argv[i + 1][0]));
+
+			ediWriter.setRenumberControlNumbers(true, firstGiven ? strtoull(argv[++i], nullptr, 10) : 1);
+
+		}
+
+		else {
+
+			cout << "Unknown option " << argument << ". --delimiters needs 3 or 4 characters." << endl;
+			return EXIT_FAILURE;
+
+		}
+
+	}
+
+	try {
+
+		openInvoiceInputFile(invoiceInputFile, argv[2]);
+		invoiceContents = readInvoiceInputFile(invoiceInputFile, invoiceTokenizer, totalElementDelimiterCounter, totalLineDelimiterCounter);
+		documentStore.build(invoiceTokenizer);
+
+		ediWriter.setDelimiters(delimitersGiven ? outputDelimiters : invoiceTokenizer.getDelimiters());
+		ediWriter.matchSourceLayout(documentStore);
+
+		outputSink.open(argv[3]);
+		ediWriter.write(documentStore, invoiceTokenizer.getDelimiters(), outputSink);
+		outputSink.close();
 
 	}
 
+	catch (string exceptionMsg) {
+
+		cout << exceptionMsg;
+		return EXIT_FAILURE;
+
+	}
+
+	cout << "Wrote " << ediWriter.getNumSegmentsWritten() << " segments (" << ediWriter.getOutput().size() << " bytes) to \"" << argv[3] << "\"." << endl;
+	cout << "Control fields changed: " << ediWriter.getNumControlFieldsChanged() << endl;
+	cout << "Output is " << ((ediWriter.getOutput() == invoiceContents.substr(skipLeadingFiller(invoiceContents))) ? "byte-identical to" : "different from") << " the input." << endl;
+
+	return EXIT_SUCCESS;
 
 }
 
@@ -595,111 +1040,84 @@ void closeBinaryOutputFile(fstream& binaryOutputFile) {
 
 //*******************************************************************************************************************************************
 //
-//Function renderInvoiceForHumans takes key elements from the populated array with ElementData objects and marries with the 810 IC schema
-// to provide a human-readable view. This is an overloaded function that takes in one of two values: 0 for console or 1 for file.
+//Function runWatchMode keeps rendering invoices as they land in a folder (see WatchFolderIngestor.h) until Ctrl+C. The output directory
+//defaults to watchOutput; --poll skips inotify and rescans the folder instead (that's also what happens on Windows).
 //
 //*******************************************************************************************************************************************
 
-void renderInvoiceForHumans(vector <ElementData>& elementDataVect) {
-	
-	cout << "Human-Readable Invoice" << endl;
-	cout << "~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~" << endl << endl;
-	
-	cout << "TOP-LEVEL" << endl;
-	cout << "_________________________________" << endl << endl;
-	cout << BIG02.elementName << ": " << elementDataVect[lookupSequenceNumberForElement(elementDataVect, "BIG02")].getStrValue() << endl; //BIG02 = Vendor Name
-	cout << BIG01.elementName << ": " << elementDataVect[lookupSequenceNumberForElement(elementDataVect, "BIG01")].getStrValue() << endl; //BIG01 = Invoice Date
-	cout << BIG04.elementName << " (" << BIG04.description << "): " << elementDataVect[lookupSequenceNumberForElement(elementDataVect, "BIG04")].getStrValue() << endl; //BIG04 = PO Ref Number
+int runWatchMode(int argc, char* argv[]) {
 
-	//I'm taking a short-cut here... If I weren't trying to demonstrate use of structs as Schema for the class, I'd change that to be a class and make a bunch of member functions that would do something like take in N101, which is the party name qualifier and return a different value to render for each (VN = Vendor, ST = Ship To). All qualifiers/enumerations could be spelled out. Instead, I'm just going to hard-wire VN here for this exercise since this is the only N101 in the sample file.
+	WatchFolderIngestor watchFolderIngestor;
+	vector <string> directories;
+	bool forcePolling = false;
 
-	cout << "Vendor ";
-	cout << N102.elementName << ": " << elementDataVect[lookupSequenceNumberForElement(elementDataVect, "N102")].getStrValue() << endl << endl; //N102 = Party Name
+	for (int i = 2; i < argc; i++) {
 
-	cout << "\nLINE ITEM DETAIL:*" << endl;
-	cout << "_________________________________" << endl << endl;
-
-	cout << IT107.elementName << ": " << elementDataVect[lookupSequenceNumberForElement(elementDataVect, "IT107")].getStrValue() << endl; //IT107 = Product/Svc ID
-	cout << IT102.elementName << ": " << elementDataVect[lookupSequenceNumberForElement(elementDataVect, "IT102")].getStrValue() << endl; //IT102 = Qty
-	cout << IT103.elementName << ": " << elementDataVect[lookupSequenceNumberForElement(elementDataVect, "IT103")].getStrValue() << endl; //IT103 = Unit of Measure
+		if (string(argv[i]) == "--poll") {
+			forcePolling = true;
+		}
 
-	//Convert string to double with my custom function to then be able to set precision to display dollar amount at 2 characters even though the same file used has four passed in. Yes, there's a lot going on here.
-		
-	cout << IT104.elementName << "**: $" << setprecision(2) << fixed << convertStringtoDoubleCustom(elementDataVect[lookupSequenceNumberForElement(elementDataVect, "IT104")].getStrValue()) << endl; //IT104 = Unit Price
+		else {
+			directories.push_back(argv[i]);
+		}
 
-	cout << "\nSUMMARY:" << endl;
-	cout << "_________________________________" << endl << endl;
-	//Same idea here as above, but adding the round function to demonstrate CMATH since it's a requirement for the assignment. This is a pretty monstrous line that I pieced together
-	//one step at a time. All the years using Excel come in handy. When reading this, start getting the sequence number lookup for TDS01. This allows you to get the string value from 
-	//the vector. Then the string value can be converted into a double, which can then be rounded, which could then be formatted to display with two digits.
+	}
 
-	cout << TDS01.elementName << "***^: $" << setprecision(2) << fixed << round(convertStringtoDoubleCustom(elementDataVect[lookupSequenceNumberForElement(elementDataVect, "TDS01")].getStrValue())) << endl; //IT104 = Unit Price
-	
+	if (directories.empty() || directories.size() > 2) {
 
-	cout << "\n\nNOTES:" << endl;
-	cout << "_________________________________" << endl;
-	cout << "\n*I cut some corners here. This project assumes only one line item is submitted on the invoice. Perhaps I'll extend it to handle segment loops one day.";
-	cout << "\n\n**When more than two decimal places are used, they are not formatted for display here even though they are still carried behind the scenes.";
-	cout << "\n\n***" << TDS01.description << endl;
-	cout << "\n\n^Amount listed here is rounded up to nearest dollar (to demonstrate CMATH)." << endl;
+		cout << "Usage: " << argv[0] << " --watch <directory> [outputDirectory] [--poll]" << endl;
+		return EXIT_FAILURE;
 
-}
+	}
 
+	try {
 
+		watchFolderIngestor.open(directories[0], (directories.size() > 1) ? directories[1] : "watchOutput", forcePolling);
 
-fstream& renderInvoiceForHumans(vector <ElementData>& elementDataVect, fstream& fout) { //I used fout here to make it easier to compare between this function and the one using cout. Just pass in the binaryOutputFile and fout serves as an alias within this scope.
+	}
 
-	fout << "Human-Readable Invoice" << endl;
-	fout << "~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~" << endl << endl;
-	//If a value isn't returned as expected, lookupSequenceNumberForElement terminates the program when the exception is thrown. This may be a bit severe, but I do not ever expect an issue -- at least with the EDI file used as a sample.
+	catch (string exceptionMsg) {
 
-	fout << "TOP-LEVEL" << endl;
-	fout << "_________________________________" << endl << endl;
-	fout << BIG02.elementName << ": " << elementDataVect[lookupSequenceNumberForElement(elementDataVect, "BIG02")].getStrValue() << endl; //BIG02 = Vendor Name
-	fout << BIG01.elementName << ": " << elementDataVect[lookupSequenceNumberForElement(elementDataVect, "BIG01")].getStrValue() << endl; //BIG01 = Invoice Date
-	fout << BIG04.elementName << " (" << BIG04.description << "): " << elementDataVect[lookupSequenceNumberForElement(elementDataVect, "BIG04")].getStrValue() << endl; //BIG04 = PO Ref Number
+		cout << exceptionMsg;
+		return EXIT_FAILURE;
 
-	//I'm taking a short-cut here... If I weren't trying to demonstrate use of structs as Schema for the class, I'd change that to be a class and make a bunch of member functions that would do something like take in N101, which is the party name qualifier and return a different value to render for each (VN = Vendor, ST = Ship To). All qualifiers/enumerations could be spelled out. Instead, I'm just going to hard-wire VN here for this exercise since this is the only N101 in the sample file.
+	}
 
-	fout << "Vendor ";
-	fout << N102.elementName << ": " << elementDataVect[lookupSequenceNumberForElement(elementDataVect, "N102")].getStrValue() << endl << endl; //N102 = Party Name
+	signal(SIGINT, requestWatchStop);
+	signal(SIGTERM, requestWatchStop);
 
-	fout << "\nLINE ITEM DETAIL:*" << endl;
-	fout << "_________________________________" << endl << endl;
+	watchFolderIngestor.run(watchStopRequested, cout);
 
-	fout << IT107.elementName << ": " << elementDataVect[lookupSequenceNumberForElement(elementDataVect, "IT107")].getStrValue() << endl; //IT107 = Product/Svc ID
-	fout << IT102.elementName << ": " << elementDataVect[lookupSequenceNumberForElement(elementDataVect, "IT102")].getStrValue() << endl; //IT102 = Qty
-	fout << IT103.elementName << ": " << elementDataVect[lookupSequenceNumberForElement(elementDataVect, "IT103")].getStrValue() << endl; //IT103 = Unit of Measure
+	return (watchFolderIngestor.getNumFailures() == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
 
-	//Convert string to double with my custom function to then be able to set precision to display dollar amount at 2 characters even though the same file used has four passed in. Yes, there's a lot going on here.
+}
 
-	fout << IT104.elementName << "**: $" << setprecision(2) << fixed << convertStringtoDoubleCustom(elementDataVect[lookupSequenceNumberForElement(elementDataVect, "IT104")].getStrValue()) << endl; //IT104 = Unit Price
+void requestWatchStop(int) {
 
-	fout << "\nSUMMARY:" << endl;
-	fout << "_________________________________" << endl << endl;
-	//Same idea here as above, but adding the round function to demonstrate CMATH since it's a requirement for the assignment. This is a pretty monstrous line that I pieced together
-	//one step at a time. All the years using Excel come in handy. When reading this, start getting the sequence number lookup for TDS01. This allows you to get the string value from 
-	//the vector. Then the string value can be converted into a double, which can then be rounded, which could then be formatted to display with two digits.
+	watchStopRequested = 1;
 
-	fout << TDS01.elementName << "***^: $" << setprecision(2) << fixed << round(convertStringtoDoubleCustom(elementDataVect[lookupSequenceNumberForElement(elementDataVect, "TDS01")].getStrValue())) << endl; //IT104 = Unit Price
+}
 
 
-	fout << "\n\nNOTES:" << endl;
-	fout << "_________________________________" << endl;
-	fout << "\n*I cut some corners here. This project assumes only one line item is submitted on the invoice. Perhaps I'll extend it to handle segment loops one day.";
-	fout << "\n\n**When more than two decimal places are used, they are not formatted for display here even though they are still carried behind the scenes.";
-	fout << "\n\n***" << TDS01.description << endl;
-	fout << "\n\n^Amount listed here is rounded up to nearest dollar (to demonstrate CMATH)." << endl;
 
+void displayMemorySummaryAtExit() {
 
-	return fout; //Return fout so it can be closed from a different calling function.
+	cerr << endl;
+	displayMemorySummary(cerr); //stderr, since headless mode may be writing invoices to stdout.
 
 }
 
 
 
+void writePipelineStatsAtExit() {
+
+	if (!writePipelineStatsReport(pipelineStatsPath)) {
+		cerr << "ERROR. The stats report could not be written to \"" << pipelineStatsPath << "\"." << endl;
+	}
+
+}
+
 
-//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
 //*******************************************************************************************************************************************
 //
@@ -707,15 +1125,16 @@ fstream& renderInvoiceForHumans(vector <ElementData>& elementDataVect, fstream&
 //
 //*******************************************************************************************************************************************
 
-int displayMenu(int VIEW_HUMAN_INVOICE_ON_CONSOLE, int OUTPUT_HUMAN_INVOICE_TO_FILE, int VIEW_MACHINE_INVOICE, int QUIT) {
+int displayMenu(int VIEW_HUMAN_INVOICE_ON_CONSOLE, int OUTPUT_HUMAN_INVOICE_TO_FILE, int VIEW_MACHINE_INVOICE, int VALIDATE_INVOICE, int QUIT) {
 
 	int userChoice = -1;
 
 	cout << "Please enter a selection from the menu below." << endl << endl;
-	cout << "1. View human-readable invoice from EDI 810 file on the CONSOLE." << endl;
-	cout << "2. View human-readable invoice from EDI 810 file in a BINARY FILE." << endl;
-	cout << "3. View machine-readable invoice from EDI 810 file on the CONSOLE." << endl;
-	cout << "4. Quit." << endl << endl;
+	cout << VIEW_HUMAN_INVOICE_ON_CONSOLE << ". View human-readable invoice from EDI 810 file on the CONSOLE." << endl;
+	cout << OUTPUT_HUMAN_INVOICE_TO_FILE << ". View human-readable invoice from EDI 810 file in a BINARY FILE." << endl;
+	cout << VIEW_MACHINE_INVOICE << ". View machine-readable invoice from EDI 810 file on the CONSOLE." << endl;
+	cout << VALIDATE_INVOICE << ". Validate EDI 810 file against the implementation convention." << endl;
+	cout << QUIT << ". Quit." << endl << endl;
 	cout << "Selection: ";
 
 	cin >> userChoice;